@@ -0,0 +1,178 @@
+// addcommand.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "addcommand.h"
+
+#define MAX_FIELDS 6
+#define MAX_INT_DIGITS 9
+#define MAX_DECIMAL_DIGITS 15
+#define FIELD_WIDTH 1023
+#define STRINGIFY(x) #x
+#define FIELD_FORMAT(width) "%" STRINGIFY(width) "s"
+
+_Static_assert(FIELD_WIDTH + 1 == ADD_FIELD_SIZE,
+    "FIELD_WIDTH must leave room for the '\\0' in each buffer");
+
+// Where a field starts in the line, and how long it is.
+struct field {
+    char *start;
+    int  length;
+};
+
+// Powers of ten that are exact doubles.
+static const double powers_of_ten[MAX_DECIMAL_DIGITS + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+    1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+};
+
+// Determine if c is white space, as isspace does in the C locale.
+static int is_space(char c);
+
+// Split line into at most MAX_FIELDS fields, and return how many.
+static int split_fields(char *line, struct field *fields);
+
+// Read the command with sscanf, into the buffers of add.
+static int scan_add_command(char *line, struct add_command *add);
+
+// Read the arguments of an add command from line.
+int parse_add_command(char *line, struct add_command *add) {
+    struct field fields[MAX_FIELDS];
+    int num_fields = split_fields(line, fields);
+
+    if ((num_fields > 0 && !read_plain_int(fields[0].start,
+                fields[0].length, &add->pokemon_id))
+            || (num_fields > 2 && !read_plain_decimal(fields[2].start,
+                fields[2].length, &add->height))
+            || (num_fields > 3 && !read_plain_decimal(fields[3].start,
+                fields[3].length, &add->weight))) {
+        return scan_add_command(line, add);
+    }
+
+    // Every field has been checked, so the line can now be split.
+    char **names[MAX_FIELDS] = {
+        NULL, &add->name, NULL, NULL, &add->type_name1, &add->type_name2
+    };
+    add->type_name2 = "None";
+    int i = 0;
+    while (i < num_fields) {
+        fields[i].start[fields[i].length] = '\0';
+        if (names[i] != NULL) {
+            *names[i] = fields[i].start;
+        }
+        i++;
+    }
+
+    return num_fields == 0 ? EOF : num_fields;
+}
+
+// Determine if c is white space, as isspace does in the C locale.
+static int is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Split line into at most MAX_FIELDS fields, and return how many.
+// The line itself is not changed.
+static int split_fields(char *line, struct field *fields) {
+    int num_fields = 0;
+    char *p = line;
+    while (num_fields < MAX_FIELDS) {
+        while (is_space(*p)) {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        fields[num_fields].start = p;
+        while (*p != '\0' && !is_space(*p)) {
+            p++;
+        }
+        fields[num_fields].length = p - fields[num_fields].start;
+        num_fields++;
+    }
+    return num_fields;
+}
+
+// Read a field of only an optional sign and up to MAX_INT_DIGITS
+// digits into value. Returns 0 for any other field.
+int read_plain_int(const char *start, int length, int *value) {
+    const char *p = start;
+    const char *end = start + length;
+    int negative = *p == '-';
+    if (*p == '-' || *p == '+') {
+        p++;
+    }
+    if (p == end || end - p > MAX_INT_DIGITS) {
+        return 0;
+    }
+
+    int result = 0;
+    while (p < end) {
+        if (*p < '0' || *p > '9') {
+            return 0;
+        }
+        result = result * 10 + (*p - '0');
+        p++;
+    }
+
+    *value = negative ? -result : result;
+    return 1;
+}
+
+// Read a field of an optional sign, digits and an optional point
+// into value, if it has at most MAX_DECIMAL_DIGITS digits.
+// Returns 0 for any other field.
+// With that few digits the digits and the power of ten are both
+// exact doubles, so one division rounds exactly as strtod does.
+int read_plain_decimal(const char *start, int length, double *value) {
+    const char *p = start;
+    const char *end = start + length;
+    int negative = *p == '-';
+    if (*p == '-' || *p == '+') {
+        p++;
+    }
+
+    uint64_t digits = 0;
+    int num_digits = 0;
+    int fraction_digits = 0;
+    int seen_point = 0;
+    while (p < end) {
+        if (*p >= '0' && *p <= '9') {
+            digits = digits * 10 + (*p - '0');
+            num_digits++;
+            fraction_digits += seen_point;
+        } else if (*p == '.' && !seen_point) {
+            seen_point = 1;
+        } else {
+            return 0;
+        }
+        p++;
+    }
+    if (num_digits == 0 || num_digits > MAX_DECIMAL_DIGITS) {
+        return 0;
+    }
+
+    double result = (double) digits / powers_of_ten[fraction_digits];
+    *value = negative ? -result : result;
+    return 1;
+}
+
+// Read the command with sscanf, into the buffers of add.
+static int scan_add_command(char *line, struct add_command *add) {
+    add->name = add->buffers[0];
+    add->type_name1 = add->buffers[1];
+    add->type_name2 = add->buffers[2];
+    snprintf(add->type_name2, ADD_FIELD_SIZE, "None");
+
+    return sscanf(line,
+        "%d" FIELD_FORMAT(FIELD_WIDTH) "%lf%lf"
+        FIELD_FORMAT(FIELD_WIDTH) FIELD_FORMAT(FIELD_WIDTH),
+        &add->pokemon_id, add->name, &add->height, &add->weight,
+        add->type_name1, add->type_name2);
+}
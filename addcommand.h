@@ -0,0 +1,53 @@
+// addcommand.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _ADDCOMMAND_H_
+#define _ADDCOMMAND_H_
+
+// The longest field parse_add_command can read from a line
+// that it has to hand to sscanf.
+#define ADD_FIELD_SIZE 1024
+
+// The arguments of an add command:
+//   [pokemon_id] [name] [height] [weight] [type1] [type2]
+// name, type_name1 and type_name2 point into the parsed line,
+// or into the buffers of the struct, so the struct and the line
+// must both outlive them.
+// type_name2 is "None" if the line does not give one.
+struct add_command {
+    int    pokemon_id;
+    char   *name;
+    double height;
+    double weight;
+    char   *type_name1;
+    char   *type_name2;
+    char   buffers[3][ADD_FIELD_SIZE];
+};
+
+// Read the arguments of an add command from line, without allocating.
+// Returns the number of arguments read, exactly as
+//   sscanf(line, "%d%s%lf%lf%s%s", ...)
+// would, so the command is complete if it returns 5 or more.
+//
+// Lines of plain whitespace-separated fields with plain decimals
+// are split in place, so line may be changed. Anything else
+// (exponents, "inf", fields running into each other) is handed to
+// sscanf, so the result is always the same as it would give.
+int parse_add_command(char *line, struct add_command *add);
+
+// Read the `length` bytes at start as a plain integer: an optional
+// sign and at most 9 digits. Returns 1 and sets *value if they are
+// one, or returns 0.
+int read_plain_int(const char *start, int length, int *value);
+
+// Read the `length` bytes at start as a plain decimal: an optional
+// sign, then at most 15 digits with at most one point among them.
+// Returns 1 and sets *value (rounded as strtod would) if they are
+// one, or returns 0.
+int read_plain_decimal(const char *start, int length, double *value);
+
+#endif // _ADDCOMMAND_H_
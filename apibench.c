@@ -0,0 +1,596 @@
+// apibench.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+//
+// Microbenchmarks for every operation in pokedex.h, on synthetic
+// Pokedexes of 1k to 1M Pokemon, reported as JSON.
+// Usage: ./apibench [-n sizes] [-t uniform|skewed|single]
+//                   [-f found_ratio] [-c chain_length] [-s seed]
+//
+// Allocations are counted by wrapping malloc, calloc, realloc and
+// strdup, so apibench must be linked with
+//   -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=strdup
+// (the Makefile does this).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "pokedex.h"
+#include "output.h"
+
+#define TURE 1
+#define FALSE 0
+#define MAX_SIZES 8
+#define MAX_NAME 16
+#define RANDOM_OPS 100000
+#define EXPLORE_OPS 100
+#define VIEW_REPEATS 5
+#define SNAPSHOT_PATH "apibench.snap"
+
+// How the types of the Pokemon are chosen.
+enum type_distribution {
+    UNIFORM_TYPES,
+    SKEWED_TYPES,
+    SINGLE_TYPE
+};
+
+struct config {
+    int                    num_sizes;
+    int                    sizes[MAX_SIZES];
+    enum type_distribution types;
+    double                 found_ratio;
+    int                    chain_length;
+    unsigned int           seed;
+};
+
+// The time and allocations of a number of calls to one operation.
+struct measure {
+    int       ops;
+    double    seconds;
+    long long allocs;
+    long long bytes;
+    double    start;
+    long long start_allocs;
+    long long start_bytes;
+};
+
+// Counted by the malloc wrappers. The calls to them only appear at
+// link time, so with -flto the compiler must not keep these in
+// registers across calls to malloc.
+static volatile long long num_allocs = 0;
+static volatile long long num_bytes = 0;
+// The time start_measure and stop_measure take themselves,
+// which is taken off every call.
+static double timer_overhead = 0;
+// Whether a result has been printed yet (for the commas).
+static int printed_result = FALSE;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+char *__real_strdup(const char *string);
+
+static void parse_arguments(int argc, char *argv[], struct config *config);
+static void usage(char *program);
+static double now_seconds(void);
+static unsigned int next_random(unsigned int *seed);
+static void random_name(unsigned int *seed, char *name);
+static pokemon_type random_type(struct config *config, unsigned int *seed);
+static void measure_timer_overhead(void);
+static void start_measure(struct measure *measure);
+static void stop_measure(struct measure *measure);
+static void print_result(int entries, char *operation,
+    struct measure *measure);
+static void bench_size(struct config *config, int entries);
+static int *shuffled_ids(int *ids, int entries, int count,
+    unsigned int *seed);
+
+int main(int argc, char *argv[]) {
+    struct config config;
+    parse_arguments(argc, argv, &config);
+
+    // Pokedex output is not part of the results.
+    int null_fd = open("/dev/null", O_WRONLY);
+    out_set_fd(null_fd);
+
+    measure_timer_overhead();
+    char *type_names[] = {"uniform", "skewed", "single"};
+    printf("{\n  \"config\": {\"types\": \"%s\", \"found_ratio\": %.2f, "
+        "\"chain_length\": %d, \"seed\": %u, "
+        "\"timer_overhead_ns\": %.1f},\n  \"results\": [",
+        type_names[config.types], config.found_ratio, config.chain_length,
+        config.seed, timer_overhead * 1e9);
+
+    int i = 0;
+    while (i < config.num_sizes) {
+        bench_size(&config, config.sizes[i]);
+        i++;
+    }
+
+    printf("\n  ]\n}\n");
+    out_flush();
+    close(null_fd);
+    return 0;
+}
+
+void *__wrap_malloc(size_t size) {
+    num_allocs++;
+    num_bytes += size;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    num_allocs++;
+    num_bytes += count * size;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    num_allocs++;
+    num_bytes += size;
+    return __real_realloc(pointer, size);
+}
+
+char *__wrap_strdup(const char *string) {
+    num_allocs++;
+    num_bytes += strlen(string) + 1;
+    return __real_strdup(string);
+}
+
+// Fill in config from the command line, exiting on a bad argument.
+static void parse_arguments(int argc, char *argv[], struct config *config) {
+    config->num_sizes = 4;
+    config->sizes[0] = 1000;
+    config->sizes[1] = 10000;
+    config->sizes[2] = 100000;
+    config->sizes[3] = 1000000;
+    config->types = UNIFORM_TYPES;
+    config->found_ratio = 0.5;
+    config->chain_length = 3;
+    config->seed = 1;
+
+    int i = 1;
+    while (i < argc) {
+        if (i + 1 >= argc || argv[i][0] != '-' || strlen(argv[i]) != 2) {
+            usage(argv[0]);
+        }
+        char *value = argv[i + 1];
+        char option = argv[i][1];
+        if (option == 'n') {
+            // A comma-separated list of sizes.
+            config->num_sizes = 0;
+            char *end = value;
+            while (*end != '\0' && config->num_sizes < MAX_SIZES) {
+                int size = (int) strtol(end, &end, 10);
+                if (size <= 0 || (*end != ',' && *end != '\0')) {
+                    usage(argv[0]);
+                }
+                config->sizes[config->num_sizes] = size;
+                config->num_sizes++;
+                if (*end == ',') {
+                    end++;
+                }
+            }
+        } else if (option == 't') {
+            if (strcmp(value, "uniform") == 0) {
+                config->types = UNIFORM_TYPES;
+            } else if (strcmp(value, "skewed") == 0) {
+                config->types = SKEWED_TYPES;
+            } else if (strcmp(value, "single") == 0) {
+                config->types = SINGLE_TYPE;
+            } else {
+                usage(argv[0]);
+            }
+        } else if (option == 'f') {
+            config->found_ratio = atof(value);
+            if (config->found_ratio < 0 || config->found_ratio > 1) {
+                usage(argv[0]);
+            }
+        } else if (option == 'c') {
+            config->chain_length = atoi(value);
+            if (config->chain_length < 1) {
+                usage(argv[0]);
+            }
+        } else if (option == 's') {
+            config->seed = (unsigned int) strtoul(value, NULL, 10);
+        } else {
+            usage(argv[0]);
+        }
+        i += 2;
+    }
+}
+
+// Print how to run apibench, and exit.
+static void usage(char *program) {
+    fprintf(stderr, "Usage: %s [-n sizes] [-t uniform|skewed|single] "
+        "[-f found_ratio] [-c chain_length] [-s seed]\n", program);
+    fprintf(stderr, "  -n  comma-separated Pokedex sizes "
+        "(default 1000,10000,100000,1000000)\n");
+    fprintf(stderr, "  -t  how types are chosen: uniform over every type, "
+        "skewed towards the first types, or a single type "
+        "(default uniform)\n");
+    fprintf(stderr, "  -f  fraction of Pokemon found, 0 to 1 "
+        "(default 0.5)\n");
+    fprintf(stderr, "  -c  Pokemon in each evolution chain, "
+        "1 for none (default 3)\n");
+    exit(1);
+}
+
+// Return a monotonic timestamp in seconds.
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Return the next number from the generator in seed.
+static unsigned int next_random(unsigned int *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+// Write a random capitalised name of 6 to 12 letters into name.
+static void random_name(unsigned int *seed, char *name) {
+    int length = 6 + next_random(seed) % 7;
+    int i = 0;
+    while (i < length) {
+        char letter = 'a' + next_random(seed) % 26;
+        if (i == 0) {
+            letter = letter - 'a' + 'A';
+        }
+        name[i] = letter;
+        i++;
+    }
+    name[length] = '\0';
+}
+
+// Choose a type (never NONE_TYPE) as config->types says.
+// Skewed types make type k about twice as likely as type k + 1.
+static pokemon_type random_type(struct config *config, unsigned int *seed) {
+    int num_types = MAX_TYPE - NONE_TYPE - 1;
+    if (config->types == SINGLE_TYPE) {
+        return FIRE_TYPE;
+    } else if (config->types == UNIFORM_TYPES) {
+        return NONE_TYPE + 1 + next_random(seed) % num_types;
+    }
+
+    unsigned int bits = next_random(seed) | (1u << (num_types - 1));
+    int type = NONE_TYPE + 1;
+    while ((bits & 1) == 0) {
+        bits >>= 1;
+        type++;
+    }
+    return type;
+}
+
+// Find the time an empty measurement takes.
+static void measure_timer_overhead(void) {
+    struct measure measure = {0};
+    int i = 0;
+    while (i < RANDOM_OPS) {
+        start_measure(&measure);
+        stop_measure(&measure);
+        i++;
+    }
+    timer_overhead = measure.seconds / measure.ops;
+}
+
+static void start_measure(struct measure *measure) {
+    measure->start_allocs = num_allocs;
+    measure->start_bytes = num_bytes;
+    measure->start = now_seconds();
+}
+
+// Add the time and allocations since start_measure to measure,
+// as one more call.
+static void stop_measure(struct measure *measure) {
+    double seconds = now_seconds() - measure->start - timer_overhead;
+    if (seconds > 0) {
+        measure->seconds += seconds;
+    }
+    measure->allocs += num_allocs - measure->start_allocs;
+    measure->bytes += num_bytes - measure->start_bytes;
+    measure->ops++;
+}
+
+// Print the result of an operation as a JSON object.
+// The peak RSS is of the whole run so far.
+static void print_result(int entries, char *operation,
+    struct measure *measure) {
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    int ops = measure->ops > 0 ? measure->ops : 1;
+
+    printf("%s\n    {\"entries\": %d, \"operation\": \"%s\", \"ops\": %d, "
+        "\"ns_per_op\": %.1f, \"allocs_per_op\": %.2f, "
+        "\"bytes_per_op\": %.1f, \"peak_rss_kb\": %ld}",
+        printed_result ? "," : "", entries, operation, measure->ops,
+        measure->seconds * 1e9 / ops, (double) measure->allocs / ops,
+        (double) measure->bytes / ops, usage.ru_maxrss);
+    fflush(stdout);
+    printed_result = TURE;
+}
+
+// Build a Pokedex of `entries` Pokemon as config says, timing each
+// operation of pokedex.h on it, and print the results.
+// Operations that only change the current Pokemon, print, or make a
+// view come first; remove_pokemon and destroy_pokedex come last.
+static void bench_size(struct config *config, int entries) {
+    unsigned int seed = config->seed;
+    int *ids = malloc(entries * sizeof(int));
+    Pokemon *pokemon = malloc(entries * sizeof(Pokemon));
+    char name[MAX_NAME];
+
+    // new_pokemon and add_pokemon, separately.
+    struct measure measure = {0};
+    int i = 0;
+    while (i < entries) {
+        // Spread the ids out so they are not simply 0..n-1.
+        ids[i] = (int) (((long long) i * 7919) % (2 * entries + 1));
+        random_name(&seed, name);
+        pokemon_type type1 = random_type(config, &seed);
+        pokemon_type type2 = NONE_TYPE;
+        if (next_random(&seed) % 2 == 0) {
+            type2 = random_type(config, &seed);
+            if (type2 == type1) {
+                type2 = NONE_TYPE;
+            }
+        }
+        double height = (next_random(&seed) % 100) / 10.0;
+        double weight = (next_random(&seed) % 1000) / 10.0;
+
+        start_measure(&measure);
+        pokemon[i] = new_pokemon(ids[i], name, height, weight,
+            type1, type2);
+        stop_measure(&measure);
+        i++;
+    }
+    print_result(entries, "new_pokemon", &measure);
+
+    Pokedex pokedex = new_pokedex();
+    measure = (struct measure) {0};
+    i = 0;
+    while (i < entries) {
+        start_measure(&measure);
+        add_pokemon(pokedex, pokemon[i]);
+        stop_measure(&measure);
+        i++;
+    }
+    print_result(entries, "add_pokemon", &measure);
+    free(pokemon);
+
+    // Chains of config->chain_length Pokemon, in the order added.
+    measure = (struct measure) {0};
+    i = 0;
+    while (i + 1 < entries) {
+        if ((i + 1) % config->chain_length != 0) {
+            start_measure(&measure);
+            add_pokemon_evolution(pokedex, ids[i], ids[i + 1]);
+            stop_measure(&measure);
+        }
+        i++;
+    }
+    print_result(entries, "add_pokemon_evolution", &measure);
+
+    // Find config->found_ratio of the Pokemon, chosen at random.
+    struct measure change = {0};
+    measure = (struct measure) {0};
+    unsigned int threshold = (unsigned int) (config->found_ratio * 32768);
+    i = 0;
+    while (i < entries) {
+        if (next_random(&seed) % 32768 < threshold) {
+            start_measure(&change);
+            change_current_pokemon(pokedex, ids[i]);
+            stop_measure(&change);
+            start_measure(&measure);
+            find_current_pokemon(pokedex);
+            stop_measure(&measure);
+        }
+        i++;
+    }
+    print_result(entries, "find_current_pokemon", &measure);
+
+    int num_random = entries < RANDOM_OPS ? entries : RANDOM_OPS;
+    int *random_ids = shuffled_ids(ids, entries, num_random, &seed);
+    i = 0;
+    while (i < num_random) {
+        start_measure(&change);
+        change_current_pokemon(pokedex, random_ids[i]);
+        stop_measure(&change);
+        i++;
+    }
+    print_result(entries, "change_current_pokemon", &change);
+
+    measure = (struct measure) {0};
+    struct measure previous = {0};
+    i = 0;
+    while (i < num_random) {
+        start_measure(&measure);
+        next_pokemon(pokedex);
+        stop_measure(&measure);
+        start_measure(&previous);
+        prev_pokemon(pokedex);
+        stop_measure(&previous);
+        i++;
+    }
+    print_result(entries, "next_pokemon", &measure);
+    print_result(entries, "prev_pokemon", &previous);
+
+    measure = (struct measure) {0};
+    i = 0;
+    while (i < num_random) {
+        start_measure(&measure);
+        get_current_pokemon(pokedex);
+        stop_measure(&measure);
+        i++;
+    }
+    print_result(entries, "get_current_pokemon", &measure);
+
+    struct measure total = {0};
+    struct measure found = {0};
+    i = 0;
+    while (i < num_random) {
+        start_measure(&total);
+        count_total_pokemon(pokedex);
+        stop_measure(&total);
+        start_measure(&found);
+        count_found_pokemon(pokedex);
+        stop_measure(&found);
+        i++;
+    }
+    print_result(entries, "count_total_pokemon", &total);
+    print_result(entries, "count_found_pokemon", &found);
+
+    // Each at a random current Pokemon.
+    struct measure detail = {0};
+    struct measure evolutions = {0};
+    struct measure next_evolution = {0};
+    i = 0;
+    while (i < num_random) {
+        change_current_pokemon(pokedex, random_ids[i]);
+        start_measure(&detail);
+        detail_pokemon(pokedex);
+        stop_measure(&detail);
+        start_measure(&evolutions);
+        show_evolutions(pokedex);
+        stop_measure(&evolutions);
+        start_measure(&next_evolution);
+        get_next_evolution(pokedex);
+        stop_measure(&next_evolution);
+        i++;
+    }
+    print_result(entries, "detail_pokemon", &detail);
+    print_result(entries, "show_evolutions", &evolutions);
+    print_result(entries, "get_next_evolution", &next_evolution);
+
+    // Operations over the whole Pokedex.
+    struct measure print = {0};
+    struct measure type_views = {0};
+    struct measure found_views = {0};
+    struct measure search_views = {0};
+    struct measure copies = {0};
+    char *texts[] = {"ab", "Pika", "xyzzy", "mon", "e"};
+    int num_texts = sizeof(texts) / sizeof(texts[0]);
+    int repeat = 0;
+    while (repeat < VIEW_REPEATS) {
+        start_measure(&print);
+        print_pokemon(pokedex);
+        stop_measure(&print);
+
+        start_measure(&type_views);
+        Pokedex view = get_pokemon_of_type(pokedex,
+            random_type(config, &seed));
+        stop_measure(&type_views);
+        destroy_pokedex(view);
+
+        start_measure(&found_views);
+        view = get_found_pokemon(pokedex);
+        stop_measure(&found_views);
+        destroy_pokedex(view);
+
+        start_measure(&search_views);
+        view = search_pokemon(pokedex, texts[repeat % num_texts]);
+        stop_measure(&search_views);
+        destroy_pokedex(view);
+
+        start_measure(&copies);
+        Pokedex copy = copy_pokedex(pokedex);
+        stop_measure(&copies);
+        destroy_pokedex(copy);
+        repeat++;
+    }
+    print_result(entries, "print_pokemon", &print);
+    print_result(entries, "get_pokemon_of_type", &type_views);
+    print_result(entries, "get_found_pokemon", &found_views);
+    print_result(entries, "search_pokemon", &search_views);
+    print_result(entries, "copy_pokedex", &copies);
+
+    struct measure saves = {0};
+    struct measure loads = {0};
+    repeat = 0;
+    while (repeat < VIEW_REPEATS) {
+        start_measure(&saves);
+        save_pokedex(pokedex, SNAPSHOT_PATH);
+        stop_measure(&saves);
+
+        Pokedex loaded = new_pokedex();
+        start_measure(&loads);
+        load_pokedex(loaded, SNAPSHOT_PATH);
+        stop_measure(&loads);
+        destroy_pokedex(loaded);
+        repeat++;
+    }
+    unlink(SNAPSHOT_PATH);
+    print_result(entries, "save_pokedex", &saves);
+    print_result(entries, "load_pokedex", &loads);
+
+    measure = (struct measure) {0};
+    i = 0;
+    while (i < EXPLORE_OPS) {
+        start_measure(&measure);
+        show_types(pokedex);
+        out_flush();
+        stop_measure(&measure);
+        i++;
+    }
+    print_result(entries, "show_types", &measure);
+
+    measure = (struct measure) {0};
+    i = 0;
+    while (i < EXPLORE_OPS) {
+        start_measure(&measure);
+        go_exploring(pokedex);
+        stop_measure(&measure);
+        i++;
+    }
+    print_result(entries, "go_exploring", &measure);
+
+    // Remove random Pokemon, until half are gone.
+    int num_removes = num_random < entries / 2 ? num_random : entries / 2;
+    measure = (struct measure) {0};
+    i = 0;
+    while (i < num_removes) {
+        change_current_pokemon(pokedex, random_ids[i]);
+        start_measure(&measure);
+        remove_pokemon(pokedex);
+        stop_measure(&measure);
+        i++;
+    }
+    print_result(entries, "remove_pokemon", &measure);
+
+    measure = (struct measure) {0};
+    start_measure(&measure);
+    destroy_pokedex(pokedex);
+    stop_measure(&measure);
+    print_result(entries, "destroy_pokedex", &measure);
+
+    free(random_ids);
+    free(ids);
+}
+
+// Return `count` different ids from ids, in a random order.
+static int *shuffled_ids(int *ids, int entries, int count,
+    unsigned int *seed) {
+
+    int *shuffled = malloc(entries * sizeof(int));
+    memcpy(shuffled, ids, entries * sizeof(int));
+    int i = 0;
+    while (i < count) {
+        int j = i + ((long long) next_random(seed) << 16
+            | next_random(seed)) % (entries - i);
+        int id = shuffled[i];
+        shuffled[i] = shuffled[j];
+        shuffled[j] = id;
+        i++;
+    }
+    return shuffled;
+}
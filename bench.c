@@ -0,0 +1,1130 @@
+// bench.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+//
+// Benchmarks for the Pokedex.
+// Usage: ./bench [benchmark]
+//        ./bench workload [entries] > commands.txt
+//        ./bench scan [entries]
+//        ./bench print
+//        ./bench page
+//        ./bench journal
+//        ./bench shared [entries]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "pokedex.h"
+#include "namematch.h"
+#include "addcommand.h"
+#include "output.h"
+#include "scan.h"
+#include "journal.h"
+#include "sharedpokedex.h"
+
+#define MIN_ENTRIES 1000
+#define MAX_ENTRIES 1000000
+#define MAX_NAME 16
+#define SEARCH_REPEATS 5
+#define SNAPSHOT_PATH "bench.snap"
+#define PARSE_LINES 10000000
+#define PARSE_LINE_SIZE 64
+#define IMPORT_PATH "bench.csv"
+#define IMPORT_ROWS 1000000
+#define MAX_THREADS 32
+#define COMMAND_REPEATS 5
+#define WORKLOAD_ENTRIES 100000
+#define SCAN_ENTRIES 10000000
+#define SCAN_REPEATS 5
+#define PRINT_REPEATS 10
+#define PAGE_SIZE 20
+#define PAGE_SEEKS 100000
+#define JOURNAL_PATH "bench.journal"
+#define JOURNAL_OPS 1000000
+#define SYNC_OPS 2000
+#define TAIL_OPS 100000
+#define SHARED_ENTRIES 100000
+#define SHARED_MS 500
+#define SHARED_COUNT_EVERY 16
+#define SHARED_SEARCH_EVERY 8192
+#define SHARED_TYPE_EVERY 32768
+
+// What the threads of bench_shared share. Only the writer changes
+// next_id and writes.
+struct shared_bench {
+    SharedPokedex shared;
+    int           next_id;
+    int           entries;
+    int           stop;
+    long          writes;
+};
+
+struct shared_reader {
+    struct shared_bench *bench;
+    unsigned int        seed;
+    long                reads;
+};
+
+static double now_seconds(void);
+static void bench_load(void);
+static void bench_found(void);
+static void bench_search(void);
+static void bench_match(void);
+static void bench_snapshot(void);
+static void bench_parse(void);
+static pokemon_type scan_type(char *type_name);
+static void bench_import(void);
+static void bench_commands(void);
+static void write_workload(int entries);
+static void bench_scan(int entries);
+static int scan_view_size(Pokedex view);
+static void bench_print(void);
+static void bench_page(void);
+static void bench_journal(void);
+static void run_mutations(Pokedex pokedex, int first_op, int end_op);
+static void time_recovery(char *what);
+static void remove_journal(void);
+static void bench_shared(int entries);
+static void *run_shared_writer(void *argument);
+static void *run_shared_reader(void *argument);
+static void random_name(unsigned int *seed, char *name);
+static Pokedex new_found_pokedex(int entries);
+
+int main(int argc, char *argv[]) {
+    char *name = "load";
+    if (argc > 1) {
+        name = argv[1];
+    }
+
+    if (strcmp(name, "load") == 0) {
+        bench_load();
+    } else if (strcmp(name, "found") == 0) {
+        bench_found();
+    } else if (strcmp(name, "search") == 0) {
+        bench_search();
+    } else if (strcmp(name, "match") == 0) {
+        bench_match();
+    } else if (strcmp(name, "snapshot") == 0) {
+        bench_snapshot();
+    } else if (strcmp(name, "parse") == 0) {
+        bench_parse();
+    } else if (strcmp(name, "import") == 0) {
+        bench_import();
+    } else if (strcmp(name, "commands") == 0) {
+        bench_commands();
+    } else if (strcmp(name, "workload") == 0) {
+        write_workload(argc > 2 ? atoi(argv[2]) : WORKLOAD_ENTRIES);
+    } else if (strcmp(name, "journal") == 0) {
+        bench_journal();
+    } else if (strcmp(name, "shared") == 0) {
+        bench_shared(argc > 2 ? atoi(argv[2]) : SHARED_ENTRIES);
+    } else if (strcmp(name, "page") == 0) {
+        bench_page();
+    } else if (strcmp(name, "print") == 0) {
+        bench_print();
+    } else if (strcmp(name, "scan") == 0) {
+        bench_scan(argc > 2 ? atoi(argv[2]) : SCAN_ENTRIES);
+    } else {
+        fprintf(stderr, "%s: unknown benchmark '%s'\n", argv[0], name);
+        return 1;
+    }
+
+    return 0;
+}
+
+// Return a monotonic timestamp in seconds.
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Time add_pokemon loading 1k to 1M entries into an empty Pokedex.
+// With the id index the time per entry should stay roughly flat.
+static void bench_load(void) {
+    printf("%10s %12s %12s\n", "entries", "seconds", "ns/entry");
+
+    int entries = MIN_ENTRIES;
+    while (entries <= MAX_ENTRIES) {
+        Pokedex pokedex = new_pokedex();
+
+        double start = now_seconds();
+        int i = 0;
+        while (i < entries) {
+            // Spread the ids out so they are not simply 0..n-1.
+            int id = (int) (((long long) i * 7919) % (2 * MAX_ENTRIES + 1));
+            add_new_pokemon(pokedex, id, "Bench", 1.0, 1.0,
+                FIRE_TYPE, WATER_TYPE);
+            i++;
+        }
+        double seconds = now_seconds() - start;
+
+        printf("%10d %12.4f %12.1f\n", entries, seconds,
+            seconds * 1e9 / entries);
+        destroy_pokedex(pokedex);
+
+        entries = entries * 10;
+    }
+}
+
+// Time get_found_pokemon on 10k, 100k and 1M found entries,
+// added in a shuffled id order so they have to be sorted.
+static void bench_found(void) {
+    printf("%10s %12s %12s\n", "found", "seconds", "ns/entry");
+
+    int entries = 10000;
+    while (entries <= MAX_ENTRIES) {
+        Pokedex pokedex = new_pokedex();
+
+        int i = 0;
+        while (i < entries) {
+            int id = (int) (((long long) i * 7919) % entries);
+            add_new_pokemon(pokedex, id, "Bench", 1.0, 1.0,
+                FIRE_TYPE, WATER_TYPE);
+            change_current_pokemon(pokedex, id);
+            find_current_pokemon(pokedex);
+            i++;
+        }
+
+        double start = now_seconds();
+        Pokedex found = get_found_pokemon(pokedex);
+        double seconds = now_seconds() - start;
+
+        printf("%10d %12.4f %12.1f\n", count_total_pokemon(found), seconds,
+            seconds * 1e9 / entries);
+        destroy_pokedex(found);
+        destroy_pokedex(pokedex);
+
+        entries = entries * 10;
+    }
+}
+
+// Time search_pokemon over 1M found Pokemon with random names,
+// for texts of 2 to 6 characters.
+// The first search of three or more characters builds the
+// trigram index, so it is timed on its own.
+static void bench_search(void) {
+    char *texts[] = {"ab", "abc", "Pika", "qux", "zzyzx", "mon-ke"};
+    int num_texts = sizeof(texts) / sizeof(texts[0]);
+
+    Pokedex pokedex = new_found_pokedex(MAX_ENTRIES);
+
+    double start = now_seconds();
+    destroy_pokedex(search_pokemon(pokedex, "xyz"));
+    printf("first search (builds index): %.2f ms\n",
+        (now_seconds() - start) * 1e3);
+
+    printf("%10s %10s %12s\n", "text", "matches", "ms/search");
+    int i = 0;
+    while (i < num_texts) {
+        int matches = 0;
+        start = now_seconds();
+        int repeat = 0;
+        while (repeat < SEARCH_REPEATS) {
+            Pokedex found = search_pokemon(pokedex, texts[i]);
+            matches = count_total_pokemon(found);
+            destroy_pokedex(found);
+            repeat++;
+        }
+        double seconds = (now_seconds() - start) / SEARCH_REPEATS;
+        printf("%10s %10d %12.3f\n", texts[i], matches, seconds * 1e3);
+        i++;
+    }
+
+    destroy_pokedex(pokedex);
+}
+
+// Write a random name of 6 to 12 letters into name.
+static void random_name(unsigned int *seed, char *name) {
+    *seed = *seed * 1103515245 + 12345;
+    int length = 6 + (*seed >> 16) % 7;
+    int i = 0;
+    while (i < length) {
+        *seed = *seed * 1103515245 + 12345;
+        char letter = 'a' + (*seed >> 16) % 26;
+        if (i == 0) {
+            letter = letter - 'a' + 'A';
+        }
+        name[i] = letter;
+        i++;
+    }
+    name[length] = '\0';
+}
+
+// Return a Pokedex of `entries` found Pokemon with random names.
+static Pokedex new_found_pokedex(int entries) {
+    Pokedex pokedex = new_pokedex();
+    unsigned int seed = 1;
+    char name[MAX_NAME];
+
+    int id = 0;
+    while (id < entries) {
+        random_name(&seed, name);
+        add_new_pokemon(pokedex, id, name, 1.0, 1.0,
+            1 + id % (MAX_TYPE - 1), NONE_TYPE);
+        change_current_pokemon(pokedex, id);
+        find_current_pokemon(pokedex);
+        id++;
+    }
+
+    return pokedex;
+}
+
+// Time each name matcher over 1M random names,
+// stored one after another like the names of the Pokedex columns.
+static void bench_match(void) {
+    char *texts[] = {"e", "ab", "Pika", "zzyzx", "mon-key"};
+    int num_texts = sizeof(texts) / sizeof(texts[0]);
+    char *matcher_names[] = {"scalar", "sse2", "avx2"};
+
+    char *names = malloc(MAX_ENTRIES * MAX_NAME + NAME_MATCH_PADDING);
+    int *offsets = malloc(MAX_ENTRIES * sizeof(int));
+    int *lengths = malloc(MAX_ENTRIES * sizeof(int));
+    unsigned int seed = 1;
+    int size = 0;
+
+    int i = 0;
+    while (i < MAX_ENTRIES) {
+        random_name(&seed, &names[size]);
+        offsets[i] = size;
+        lengths[i] = strlen(&names[size]);
+        size += lengths[i] + 1;
+        i++;
+    }
+    memset(&names[size], 0, NAME_MATCH_PADDING);
+
+    printf("%8s %8s %10s %12s\n", "matcher", "text", "matches", "ns/name");
+    name_matcher matcher = SCALAR_MATCHER;
+    while (matcher <= AVX2_MATCHER) {
+        if (!use_name_matcher(matcher)) {
+            printf("%8s not supported on this CPU\n", matcher_names[matcher]);
+            matcher++;
+            continue;
+        }
+
+        int t = 0;
+        while (t < num_texts) {
+            int text_length = strlen(texts[t]);
+            int matches = 0;
+            double start = now_seconds();
+            i = 0;
+            while (i < MAX_ENTRIES) {
+                matches += name_contains(&names[offsets[i]], lengths[i],
+                    texts[t], text_length);
+                i++;
+            }
+            double seconds = now_seconds() - start;
+            printf("%8s %8s %10d %12.2f\n", matcher_names[matcher], texts[t],
+                matches, seconds * 1e9 / MAX_ENTRIES);
+            t++;
+        }
+        matcher++;
+    }
+
+    free(names);
+    free(offsets);
+    free(lengths);
+}
+
+// Time save_pokedex and load_pokedex for 1k to 1M found Pokemon
+// with random names, against building the same Pokedex with
+// add_new_pokemon. The snapshot is written to SNAPSHOT_PATH.
+static void bench_snapshot(void) {
+    printf("%10s %12s %12s %12s %12s\n",
+        "entries", "build ms", "save ms", "load ms", "MB");
+
+    int entries = MIN_ENTRIES;
+    while (entries <= MAX_ENTRIES) {
+        double start = now_seconds();
+        Pokedex pokedex = new_found_pokedex(entries);
+        double build = now_seconds() - start;
+
+        start = now_seconds();
+        if (!save_pokedex(pokedex, SNAPSHOT_PATH)) {
+            exit(1);
+        }
+        double save = now_seconds() - start;
+
+        Pokedex loaded = new_pokedex();
+        start = now_seconds();
+        if (!load_pokedex(loaded, SNAPSHOT_PATH)) {
+            exit(1);
+        }
+        double load = now_seconds() - start;
+
+        FILE *file = fopen(SNAPSHOT_PATH, "rb");
+        fseek(file, 0, SEEK_END);
+        double megabytes = ftell(file) / 1e6;
+        fclose(file);
+
+        printf("%10d %12.2f %12.2f %12.2f %12.1f\n", count_total_pokemon(loaded),
+            build * 1e3, save * 1e3, load * 1e3, megabytes);
+        destroy_pokedex(loaded);
+        destroy_pokedex(pokedex);
+
+        entries = entries * 10;
+    }
+
+    remove(SNAPSHOT_PATH);
+}
+
+// Time reading the arguments and types of 10M add commands,
+// with sscanf and a strcasecmp over every type name as do_add used
+// to, and with parse_add_command and pokemon_type_from_string.
+static void bench_parse(void) {
+    char *types[] = {"Fire", "water", "None", "PSYCHIC", "fairy", "Bug"};
+    int num_types = sizeof(types) / sizeof(types[0]);
+
+    char *lines = malloc((size_t) PARSE_LINES * PARSE_LINE_SIZE);
+    unsigned int seed = 1;
+    char name[MAX_NAME];
+    int i = 0;
+    while (i < PARSE_LINES) {
+        random_name(&seed, name);
+        snprintf(&lines[(size_t) i * PARSE_LINE_SIZE], PARSE_LINE_SIZE,
+            "%d %s %d.%d %d.%d %s %s", i, name, i % 20, i % 10, i % 900,
+            i % 7, types[i % num_types], types[(i + 1) % num_types]);
+        i++;
+    }
+
+    printf("%20s %12s %12s\n", "parser", "ns/line", "Mlines/s");
+
+    double start = now_seconds();
+    long long checksum = 0;
+    i = 0;
+    while (i < PARSE_LINES) {
+        char *line = &lines[(size_t) i * PARSE_LINE_SIZE];
+        int id;
+        double height, weight;
+        char name[ADD_FIELD_SIZE] = {0};
+        char type_name1[ADD_FIELD_SIZE] = {0};
+        char type_name2[ADD_FIELD_SIZE] = "None";
+        sscanf(line, "%d%s%lf%lf%s%s", &id, name, &height, &weight,
+            type_name1, type_name2);
+        checksum += id + scan_type(type_name1) + scan_type(type_name2);
+        i++;
+    }
+    double seconds = now_seconds() - start;
+    printf("%20s %12.1f %12.2f\n", "sscanf", seconds * 1e9 / PARSE_LINES,
+        PARSE_LINES / seconds / 1e6);
+
+    start = now_seconds();
+    long long fast_checksum = 0;
+    i = 0;
+    while (i < PARSE_LINES) {
+        struct add_command add;
+        parse_add_command(&lines[(size_t) i * PARSE_LINE_SIZE], &add);
+        fast_checksum += add.pokemon_id
+            + pokemon_type_from_string(add.type_name1)
+            + pokemon_type_from_string(add.type_name2);
+        i++;
+    }
+    seconds = now_seconds() - start;
+    printf("%20s %12.1f %12.2f\n", "parse_add_command",
+        seconds * 1e9 / PARSE_LINES, PARSE_LINES / seconds / 1e6);
+
+    if (checksum != fast_checksum) {
+        printf("results differ!\n");
+    }
+    free(lines);
+}
+
+// Look a type name up the way pokemon_type_from_string used to.
+static pokemon_type scan_type(char *type_name) {
+    pokemon_type type = NONE_TYPE;
+    while (type < MAX_TYPE) {
+        if (strcasecmp(pokemon_type_to_string(type), type_name) == 0) {
+            return type;
+        }
+        type++;
+    }
+    return INVALID_TYPE;
+}
+
+// Time import_pokemon on a CSV of 1M rows in shuffled id order,
+// with 1 to MAX_THREADS parsing threads, and the parsing stage
+// (read_import_file) on its own.
+// The CSV is written to IMPORT_PATH.
+static void bench_import(void) {
+    char *types[] = {"Fire", "water", "", "PSYCHIC", "fairy", "Bug"};
+    int num_types = sizeof(types) / sizeof(types[0]);
+
+    FILE *csv = fopen(IMPORT_PATH, "w");
+    if (csv == NULL) {
+        perror(IMPORT_PATH);
+        exit(1);
+    }
+    fprintf(csv, "id,name,height,weight,type1,type2\n");
+    unsigned int seed = 1;
+    char name[MAX_NAME];
+    int i = 0;
+    while (i < IMPORT_ROWS) {
+        random_name(&seed, name);
+        int id = (int) (((long long) i * 7919) % IMPORT_ROWS);
+        fprintf(csv, "%d,%s,%d.%d,%d.%d,%s,%s\n", id, name, i % 20, i % 10,
+            i % 900, i % 7, types[(i + 1) % num_types], types[i % num_types]);
+        i++;
+    }
+    fclose(csv);
+
+    printf("%8s %12s %12s %14s\n", "threads", "parse ms", "import ms",
+        "rows/s");
+    int threads = 1;
+    while (threads <= MAX_THREADS) {
+        Pokedex pokedex = new_pokedex();
+        struct import_report report;
+
+        // The parallel stage on its own, without merging.
+        double start = now_seconds();
+        ImportFile file = read_import_file(IMPORT_PATH, threads, &report);
+        if (file == NULL) {
+            exit(1);
+        }
+        close_import_file(file);
+        double parse_seconds = now_seconds() - start;
+
+        start = now_seconds();
+        if (!import_pokemon(pokedex, IMPORT_PATH, threads, &report)) {
+            exit(1);
+        }
+        double seconds = now_seconds() - start;
+
+        printf("%8d %12.1f %12.1f %14.0f\n", threads, parse_seconds * 1e3,
+            seconds * 1e3, (report.rows + report.invalid) / seconds);
+        destroy_pokedex(pokedex);
+
+        threads = threads * 2;
+    }
+
+    remove(IMPORT_PATH);
+}
+
+// Time p, T and x (print_pokemon, get_pokemon_of_type and
+// go_exploring) on 1M Pokemon, half of them found, with output
+// going to /dev/null.
+// Build it with and without -DPOKEMON_RELEASE to compare the
+// checked and inline Pokemon accessors.
+static void bench_commands(void) {
+#ifdef POKEMON_RELEASE
+    printf("accessors: inline (POKEMON_RELEASE)\n");
+#else
+    printf("accessors: checked\n");
+#endif
+
+    Pokedex pokedex = new_pokedex();
+    unsigned int seed = 1;
+    char name[MAX_NAME];
+    int id = 0;
+    while (id < MAX_ENTRIES) {
+        random_name(&seed, name);
+        add_new_pokemon(pokedex, id, name, 1.0, 1.0,
+            1 + id % (MAX_TYPE - 1), NONE_TYPE);
+        if (id % 2 == 0) {
+            change_current_pokemon(pokedex, id);
+            find_current_pokemon(pokedex);
+        }
+        id++;
+    }
+
+    int null_fd = open("/dev/null", O_WRONLY);
+    out_set_fd(null_fd);
+
+    double start = now_seconds();
+    int repeat = 0;
+    while (repeat < COMMAND_REPEATS) {
+        print_pokemon(pokedex);
+        out_flush();
+        repeat++;
+    }
+    double print_seconds = (now_seconds() - start) / COMMAND_REPEATS;
+
+    start = now_seconds();
+    repeat = 0;
+    while (repeat < COMMAND_REPEATS) {
+        destroy_pokedex(get_pokemon_of_type(pokedex, FIRE_TYPE));
+        repeat++;
+    }
+    double type_seconds = (now_seconds() - start) / COMMAND_REPEATS;
+
+    // Each x finds up to one Pokemon of each type.
+    start = now_seconds();
+    repeat = 0;
+    while (repeat < COMMAND_REPEATS) {
+        go_exploring(pokedex);
+        out_flush();
+        repeat++;
+    }
+    double explore_seconds = (now_seconds() - start) / COMMAND_REPEATS;
+
+    out_set_fd(1);
+    close(null_fd);
+
+    printf("%10s %12s\n", "command", "ms");
+    printf("%10s %12.2f\n", "p", print_seconds * 1e3);
+    printf("%10s %12.2f\n", "T", type_seconds * 1e3);
+    printf("%10s %12.3f\n", "x", explore_seconds * 1e3);
+
+    destroy_pokedex(pokedex);
+}
+
+// Time x, T and a two-letter S (go_exploring, get_pokemon_of_type and
+// search_pokemon) on `entries` Pokemon with 1 to MAX_THREADS scan
+// threads. All but the last 1% are found, so each x scans nearly all
+// of every type's rows before finding the unfound ones.
+// The T and S views are checked against one scan thread's.
+static void bench_scan(int entries) {
+    Pokedex pokedex = new_pokedex();
+    unsigned int seed = 1;
+    char name[MAX_NAME];
+    int id = 0;
+    while (id < entries) {
+        random_name(&seed, name);
+        // The second type is any but the first.
+        int type1 = id % (MAX_TYPE - 1);
+        int type2 = (type1 + 1 + id / 7 % (MAX_TYPE - 2)) % (MAX_TYPE - 1);
+        add_new_pokemon(pokedex, id, name, 1.0, 1.0, 1 + type1, 1 + type2);
+        if (id < entries - entries / 100) {
+            change_current_pokemon(pokedex, id);
+            find_current_pokemon(pokedex);
+        }
+        id++;
+    }
+
+    int null_fd = open("/dev/null", O_WRONLY);
+    out_set_fd(null_fd);
+
+    printf("%d Pokemon\n", entries);
+    printf("%8s %10s %10s %10s\n", "threads", "T ms", "S ms", "x ms");
+    int threads = 1;
+    while (threads <= MAX_THREADS) {
+        // Each x finds more Pokemon, so the sizes change every round.
+        set_scan_threads(1);
+        int type_size = scan_view_size(get_pokemon_of_type(pokedex,
+            FIRE_TYPE));
+        int search_size = scan_view_size(search_pokemon(pokedex, "ab"));
+        set_scan_threads(threads);
+
+        double start = now_seconds();
+        int repeat = 0;
+        while (repeat < SCAN_REPEATS) {
+            if (scan_view_size(get_pokemon_of_type(pokedex, FIRE_TYPE))
+                    != type_size) {
+                fprintf(stderr, "T differs with %d threads\n", threads);
+                exit(1);
+            }
+            repeat++;
+        }
+        double type_seconds = (now_seconds() - start) / SCAN_REPEATS;
+
+        start = now_seconds();
+        repeat = 0;
+        while (repeat < SCAN_REPEATS) {
+            if (scan_view_size(search_pokemon(pokedex, "ab")) != search_size) {
+                fprintf(stderr, "S differs with %d threads\n", threads);
+                exit(1);
+            }
+            repeat++;
+        }
+        double search_seconds = (now_seconds() - start) / SCAN_REPEATS;
+
+        start = now_seconds();
+        repeat = 0;
+        while (repeat < SCAN_REPEATS) {
+            go_exploring(pokedex);
+            out_flush();
+            repeat++;
+        }
+        double explore_seconds = (now_seconds() - start) / SCAN_REPEATS;
+
+        printf("%8d %10.2f %10.2f %10.2f\n", threads, type_seconds * 1e3,
+            search_seconds * 1e3, explore_seconds * 1e3);
+        threads = threads * 2;
+    }
+
+    out_set_fd(1);
+    close(null_fd);
+    destroy_pokedex(pokedex);
+}
+
+// Return the number of Pokemon in a view, and destroy it.
+static int scan_view_size(Pokedex view) {
+    int size = count_total_pokemon(view);
+    destroy_pokedex(view);
+    return size;
+}
+
+// Time p and d (print_pokemon, and detail_pokemon on every Pokemon)
+// on 1M Pokemon, half of them found, with output going to /dev/null,
+// and give their throughput in MB of output per second.
+// The sizes of the output are worked out from the Pokemon added.
+static void bench_print(void) {
+    Pokedex pokedex = new_pokedex();
+    unsigned int seed = 1;
+    char name[MAX_NAME];
+    char line[64];
+    long long print_bytes = 0;
+    long long detail_bytes = 0;
+    int id = 0;
+    while (id < MAX_ENTRIES) {
+        random_name(&seed, name);
+        double height = id % 1000 / 7.0;
+        double weight = id % 3000 / 3.0;
+        add_new_pokemon(pokedex, id, name, height, weight,
+            1 + id % (MAX_TYPE - 1), NONE_TYPE);
+
+        // "    #001: " and the name or its mask.
+        print_bytes += 4 + snprintf(line, sizeof(line), "#%03d: ", id)
+            + strlen(name) + 1;
+        detail_bytes += snprintf(line, sizeof(line), "ID: %03d\n", id)
+            + 6 + strlen(name) + 1;
+        if (id % 2 == 0) {
+            change_current_pokemon(pokedex, id);
+            find_current_pokemon(pokedex);
+            detail_bytes += snprintf(line, sizeof(line),
+                "Height: %.1fm\nWeight: %.1fkg\nType: %s \n", height,
+                weight, pokemon_type_to_string(1 + id % (MAX_TYPE - 1)));
+        } else {
+            detail_bytes += 31;
+        }
+        id++;
+    }
+
+    int null_fd = open("/dev/null", O_WRONLY);
+    out_set_fd(null_fd);
+
+    double start = now_seconds();
+    int repeat = 0;
+    while (repeat < PRINT_REPEATS) {
+        print_pokemon(pokedex);
+        out_flush();
+        repeat++;
+    }
+    double print_seconds = (now_seconds() - start) / PRINT_REPEATS;
+
+    change_current_pokemon(pokedex, 0);
+    start = now_seconds();
+    id = 0;
+    while (id < MAX_ENTRIES) {
+        detail_pokemon(pokedex);
+        next_pokemon(pokedex);
+        id++;
+    }
+    out_flush();
+    double detail_seconds = now_seconds() - start;
+
+    out_set_fd(1);
+    close(null_fd);
+
+    printf("%10s %12s %12s %12s\n", "command", "ms", "MB", "MB/s");
+    printf("%10s %12.2f %12.1f %12.1f\n", "p", print_seconds * 1e3,
+        print_bytes / 1e6, print_bytes / 1e6 / print_seconds);
+    printf("%10s %12.2f %12.1f %12.1f\n", "d", detail_seconds * 1e3,
+        detail_bytes / 1e6, detail_bytes / 1e6 / detail_seconds);
+
+    destroy_pokedex(pokedex);
+}
+
+// Time jumping to a random position, printing a page of PAGE_SIZE
+// Pokemon from it, and printing between two Pokemon PAGE_SIZE apart,
+// on 10k to 1M found Pokemon with every tenth removed.
+// The time per seek should stay roughly flat. The first page, which
+// builds the columns, is timed on its own.
+static void bench_page(void) {
+    printf("%10s %12s %12s %12s %12s\n", "entries", "first ms", "jump ns",
+        "page ns", "between ns");
+
+    int null_fd = open("/dev/null", O_WRONLY);
+    int entries = MIN_ENTRIES * 10;
+    while (entries <= MAX_ENTRIES) {
+        Pokedex pokedex = new_found_pokedex(entries);
+        int id = 0;
+        while (id < entries) {
+            change_current_pokemon(pokedex, id);
+            remove_pokemon(pokedex);
+            id += 10;
+        }
+        int total = count_total_pokemon(pokedex);
+        out_set_fd(null_fd);
+
+        double start = now_seconds();
+        print_pokemon_page(pokedex, 0, PAGE_SIZE);
+        double first_seconds = now_seconds() - start;
+
+        unsigned int seed = 1;
+        start = now_seconds();
+        int i = 0;
+        while (i < PAGE_SEEKS) {
+            seed = seed * 1103515245 + 12345;
+            change_current_position(pokedex, (seed >> 8) % total);
+            i++;
+        }
+        double jump_seconds = (now_seconds() - start) / PAGE_SEEKS;
+
+        start = now_seconds();
+        i = 0;
+        while (i < PAGE_SEEKS) {
+            seed = seed * 1103515245 + 12345;
+            print_pokemon_page(pokedex, (seed >> 8) % total, PAGE_SIZE);
+            i++;
+        }
+        out_flush();
+        double page_seconds = (now_seconds() - start) / PAGE_SEEKS;
+
+        // Ids ending in 0 were removed, so use ones ending in 1.
+        start = now_seconds();
+        i = 0;
+        while (i < PAGE_SEEKS) {
+            seed = seed * 1103515245 + 12345;
+            int from_id = (seed >> 8) % (entries / 10 - 2) * 10 + 1;
+            print_pokemon_between(pokedex, from_id, from_id + PAGE_SIZE);
+            i++;
+        }
+        out_flush();
+        double between_seconds = (now_seconds() - start) / PAGE_SEEKS;
+
+        out_set_fd(1);
+        printf("%10d %12.2f %12.1f %12.1f %12.1f\n", entries,
+            first_seconds * 1e3, jump_seconds * 1e9, page_seconds * 1e9,
+            between_seconds * 1e9);
+        destroy_pokedex(pokedex);
+        entries = entries * 10;
+    }
+    close(null_fd);
+}
+
+// Time JOURNAL_OPS mutations (adds, finds, evolutions and removals)
+// with no journal and with journals committed every 10 and 1 ms,
+// and SYNC_OPS of them with a journal synced after each one.
+// Then time recovering the Pokedex from a journal of JOURNAL_OPS
+// mutations, and from a checkpoint followed by TAIL_OPS of them.
+// The journal is written to JOURNAL_PATH.
+static void bench_journal(void) {
+    int intervals[] = {-1, 10, 1, 0};
+    int num_intervals = sizeof(intervals) / sizeof(intervals[0]);
+
+    printf("%10s %10s %12s %12s %10s\n", "journal", "ops", "seconds",
+        "ops/s", "MB");
+    int i = 0;
+    while (i < num_intervals) {
+        remove_journal();
+        Pokedex pokedex = new_pokedex();
+        if (intervals[i] >= 0
+                && !open_pokedex_journal(pokedex, JOURNAL_PATH, intervals[i])) {
+            exit(1);
+        }
+
+        int ops = intervals[i] == 0 ? SYNC_OPS : JOURNAL_OPS;
+        double start = now_seconds();
+        run_mutations(pokedex, 0, ops);
+        // Closing the journal commits the last group.
+        destroy_pokedex(pokedex);
+        double seconds = now_seconds() - start;
+
+        char name[16];
+        snprintf(name, sizeof(name), "%d ms", intervals[i]);
+        FILE *file = fopen(JOURNAL_PATH, "rb");
+        double megabytes = 0;
+        if (file != NULL) {
+            fseek(file, 0, SEEK_END);
+            megabytes = ftell(file) / 1e6;
+            fclose(file);
+        }
+        printf("%10s %10d %12.3f %12.0f %10.1f\n",
+            intervals[i] < 0 ? "off" : name, ops, seconds, ops / seconds,
+            megabytes);
+        i++;
+    }
+
+    printf("\n%24s %12s %12s\n", "recovery from", "ms", "Pokemon");
+    remove_journal();
+    Pokedex pokedex = new_pokedex();
+    if (!open_pokedex_journal(pokedex, JOURNAL_PATH, DEFAULT_COMMIT_INTERVAL)) {
+        exit(1);
+    }
+    run_mutations(pokedex, 0, JOURNAL_OPS);
+    destroy_pokedex(pokedex);
+    time_recovery("journal of 1M ops");
+
+    pokedex = new_pokedex();
+    if (!open_pokedex_journal(pokedex, JOURNAL_PATH, DEFAULT_COMMIT_INTERVAL)
+            || !checkpoint_pokedex(pokedex)) {
+        exit(1);
+    }
+    destroy_pokedex(pokedex);
+    time_recovery("checkpoint");
+
+    pokedex = new_pokedex();
+    if (!open_pokedex_journal(pokedex, JOURNAL_PATH, DEFAULT_COMMIT_INTERVAL)) {
+        exit(1);
+    }
+    run_mutations(pokedex, JOURNAL_OPS, JOURNAL_OPS + TAIL_OPS);
+    destroy_pokedex(pokedex);
+    time_recovery("checkpoint + 100k ops");
+
+    remove_journal();
+}
+
+// Run mutations first_op to end_op of a fixed sequence on pokedex.
+// In every 10: 5 adds, 2 finds, an evolution between the last two
+// Pokemon added, a removal of the oldest Pokemon left, and a find.
+// Pokemon first_op / 2 to end_op / 2 are added, so a later range
+// carries on from an earlier one.
+static void run_mutations(Pokedex pokedex, int first_op, int end_op) {
+    unsigned int seed = first_op + 1;
+    char name[MAX_NAME];
+    int next_id = first_op / 2;
+    int oldest_id = first_op / 10;
+
+    int op = first_op;
+    while (op < end_op) {
+        int kind = op % 10;
+        if (kind < 5) {
+            random_name(&seed, name);
+            add_new_pokemon(pokedex, next_id, name, 1.0, 1.0,
+                1 + next_id % (MAX_TYPE - 1), NONE_TYPE);
+            next_id++;
+        } else if (kind == 7 && next_id - 2 > oldest_id) {
+            add_pokemon_evolution(pokedex, next_id - 2, next_id - 1);
+        } else if (kind == 8 && next_id - 2 > oldest_id) {
+            change_current_pokemon(pokedex, oldest_id);
+            remove_pokemon(pokedex);
+            oldest_id++;
+        } else {
+            seed = seed * 1103515245 + 12345;
+            change_current_pokemon(pokedex,
+                oldest_id + (seed >> 8) % (next_id - oldest_id));
+            find_current_pokemon(pokedex);
+        }
+        op++;
+    }
+}
+
+// Time recovering a Pokedex from JOURNAL_PATH, and print it as `what`.
+static void time_recovery(char *what) {
+    Pokedex pokedex = new_pokedex();
+    double start = now_seconds();
+    if (!open_pokedex_journal(pokedex, JOURNAL_PATH, DEFAULT_COMMIT_INTERVAL)) {
+        exit(1);
+    }
+    double seconds = now_seconds() - start;
+    printf("%24s %12.1f %12d\n", what, seconds * 1e3,
+        count_total_pokemon(pokedex));
+    destroy_pokedex(pokedex);
+}
+
+// Remove the journal and the snapshots of its first generations.
+static void remove_journal(void) {
+    remove(JOURNAL_PATH);
+    char path[JOURNAL_PATH_MAX];
+    int generation = 1;
+    while (generation <= 2) {
+        snprintf(path, sizeof(path), "%s.%d.snap", JOURNAL_PATH, generation);
+        remove(path);
+        generation++;
+    }
+}
+
+// Time a SharedPokedex of `entries` found Pokemon with one writer
+// thread and 1 to MAX_THREADS reader threads, for SHARED_MS each.
+// The writer adds a Pokemon, finds it and removes the oldest, so the
+// Pokedex stays the same size while its table is grown and compacted.
+// Readers mostly move their cursors, with a count every
+// SHARED_COUNT_EVERY reads, a search every SHARED_SEARCH_EVERY and a
+// type query every SHARED_TYPE_EVERY.
+static void bench_shared(int entries) {
+    SharedPokedex shared = new_shared_pokedex();
+    unsigned int seed = 1;
+    char name[MAX_NAME];
+    int id = 0;
+    while (id < entries) {
+        random_name(&seed, name);
+        shared_add_new_pokemon(shared, id, name, 1.0, 1.0,
+            1 + id % (MAX_TYPE - 1), NONE_TYPE);
+        shared_find_pokemon(shared, id);
+        id++;
+    }
+
+    struct shared_bench bench;
+    bench.shared = shared;
+    bench.next_id = entries;
+    bench.entries = entries;
+
+    printf("%10s %14s %14s %14s\n", "readers", "reads/s", "writes/s",
+        "reads/s/reader");
+    int num_readers = 1;
+    while (num_readers <= MAX_THREADS) {
+        pthread_t threads[MAX_THREADS];
+        struct shared_reader readers[MAX_THREADS];
+        bench.stop = 0;
+        bench.writes = 0;
+
+        pthread_t writer;
+        pthread_create(&writer, NULL, run_shared_writer, &bench);
+        int i = 0;
+        while (i < num_readers) {
+            readers[i].bench = &bench;
+            readers[i].seed = i + 1;
+            readers[i].reads = 0;
+            pthread_create(&threads[i], NULL, run_shared_reader, &readers[i]);
+            i++;
+        }
+
+        double start = now_seconds();
+        struct timespec pause = {0, SHARED_MS * 1000000L};
+        nanosleep(&pause, NULL);
+        __atomic_store_n(&bench.stop, 1, __ATOMIC_RELAXED);
+
+        long reads = 0;
+        i = 0;
+        while (i < num_readers) {
+            pthread_join(threads[i], NULL);
+            reads += readers[i].reads;
+            i++;
+        }
+        pthread_join(writer, NULL);
+        double seconds = now_seconds() - start;
+
+        printf("%10d %14.0f %14.0f %14.0f\n", num_readers, reads / seconds,
+            bench.writes / seconds, reads / seconds / num_readers);
+        num_readers *= 2;
+    }
+
+    Session session = open_session(shared);
+    if (session_count_total(session) != entries
+            || session_count_found(session) != entries) {
+        fprintf(stderr, "bench shared: expected %d Pokemon, found %d/%d\n",
+            entries, session_count_found(session),
+            session_count_total(session));
+        exit(1);
+    }
+    close_session(session);
+    destroy_shared_pokedex(shared);
+}
+
+// Add, find and remove Pokemon until the bench is stopped.
+static void *run_shared_writer(void *argument) {
+    struct shared_bench *bench = argument;
+    unsigned int seed = bench->next_id;
+    char name[MAX_NAME];
+
+    while (!__atomic_load_n(&bench->stop, __ATOMIC_RELAXED)) {
+        int id = bench->next_id;
+        random_name(&seed, name);
+        shared_add_new_pokemon(bench->shared, id, name, 1.0, 1.0,
+            1 + id % (MAX_TYPE - 1), NONE_TYPE);
+        shared_find_pokemon(bench->shared, id);
+        shared_remove_pokemon(bench->shared, id - bench->entries);
+        __atomic_store_n(&bench->next_id, id + 1, __ATOMIC_RELAXED);
+        bench->writes += 3;
+    }
+
+    return NULL;
+}
+
+// Read through a Session of its own until the bench is stopped.
+// Every read of the current Pokemon must find one, as the Pokedex is
+// never empty.
+static void *run_shared_reader(void *argument) {
+    struct shared_reader *reader = argument;
+    struct shared_bench *bench = reader->bench;
+    Session session = open_session(bench->shared);
+    char text[4];
+
+    long reads = 0;
+    while (!__atomic_load_n(&bench->stop, __ATOMIC_RELAXED)) {
+        reader->seed = reader->seed * 1103515245 + 12345;
+        unsigned int random = reader->seed >> 8;
+        if (reads % SHARED_TYPE_EVERY == SHARED_TYPE_EVERY - 1) {
+            destroy_pokedex(session_get_pokemon_of_type(session,
+                1 + random % (MAX_TYPE - 1)));
+        } else if (reads % SHARED_SEARCH_EVERY == SHARED_SEARCH_EVERY - 1) {
+            text[0] = 'a' + random % 26;
+            text[1] = 'a' + random / 26 % 26;
+            text[2] = 'a' + random / 676 % 26;
+            text[3] = '\0';
+            destroy_pokedex(session_search_pokemon(session, text));
+        } else if (reads % SHARED_COUNT_EVERY == 0) {
+            session_count_total(session);
+            session_count_found(session);
+        } else if (random % 4 == 0) {
+            int next_id = __atomic_load_n(&bench->next_id, __ATOMIC_RELAXED);
+            session_change_current(session,
+                next_id - 1 - random % bench->entries);
+        } else if (random % 4 == 1) {
+            session_next(session);
+        } else if (random % 4 == 2) {
+            session_prev(session);
+        } else {
+            Pokemon pokemon = session_current_pokemon(session);
+            if (pokemon == NULL) {
+                fprintf(stderr, "bench shared: no current Pokemon\n");
+                exit(1);
+            }
+            destroy_pokemon(pokemon);
+        }
+        reads++;
+    }
+
+    reader->reads = reads;
+    close_session(session);
+    return NULL;
+}
+
+// Print a script of CLI commands using every command on a Pokedex
+// of `entries` Pokemon, for training and timing builds of the CLI
+// (see the pgo and compare targets of the Makefile).
+// The same entries always give the same script.
+static void write_workload(int entries) {
+    char *types[] = {"fire", "water", "grass", "bug", "psychic",
+        "ghost", "dragon", "fairy"};
+    int num_types = sizeof(types) / sizeof(types[0]);
+    char *searches[] = {"ab", "abc", "Pika", "zzy", "mon"};
+    int num_searches = sizeof(searches) / sizeof(searches[0]);
+
+    unsigned int seed = 1;
+    char name[MAX_NAME];
+    int previous_id = -1;
+    int i = 0;
+    while (i < entries) {
+        // Spread the ids out so they are not simply 0..n-1.
+        int id = (int) (((long long) i * 7919) % entries);
+        random_name(&seed, name);
+        printf("a %d %s %d.%d %d.%d %s %s\n", id, name, i % 20, i % 10,
+            i % 900, i % 7, types[i % num_types],
+            i % 3 == 0 ? "none" : types[(i + 1) % num_types]);
+
+        if (i % 3 == 0) {
+            printf("m %d\nf\n", id);
+        }
+        // Evolutions only go to larger ids, so there are no cycles.
+        if (i % 5 == 0 && previous_id >= 0) {
+            int from = previous_id < id ? previous_id : id;
+            int to = previous_id < id ? id : previous_id;
+            printf("e %d %d\nm %d\ns\nn\n", from, to, from);
+        }
+        if (i % 1000 == 999) {
+            printf("d\ng\n>\n<\nc\nt\ny\nx\n");
+            printf("T %s\nc\nq\n", types[(i / 1000) % num_types]);
+            printf("S %s\nt\nq\n", searches[(i / 1000) % num_searches]);
+            printf("F\nt\nq\n");
+            printf("m %d\nr\n", id);
+            id = -1;
+        }
+        if (i % (entries / 4 + 1) == entries / 4) {
+            printf("p\n");
+        }
+        previous_id = id;
+        i++;
+    }
+
+    printf("p\nF\np\nq\nq\n");
+}
@@ -0,0 +1,440 @@
+// columns.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#include "columns.h"
+#include "scan.h"
+#include "stats.h"
+
+#define INITIAL_ROWS 64
+#define INITIAL_NAME_BYTES 1024
+
+// Resize every array of columns to hold `capacity` rows.
+static void grow_rows(Columns columns, int capacity);
+
+// Make room for `length` more bytes in the name pool.
+static void grow_names(Columns columns, int length);
+
+// Return `p` resized to `count` elements of `size` bytes.
+static void *resize(void *p, int count, int size);
+
+// What each scan's chunks read and write.
+
+struct first_rows_scan {
+    Columns        columns;
+    const uint64_t *except;
+    int            first[MAX_TYPE];
+};
+
+struct collect_scan {
+    Columns        columns;
+    const uint64_t *a;
+    const uint64_t *b;
+    int            *offsets;
+    void           **nodes;
+};
+
+struct match_scan {
+    Columns        columns;
+    const uint64_t *a;
+    const uint64_t *b;
+    const char     *text;
+    int            text_length;
+    uint64_t       *matches;
+    int            checked;
+};
+
+// Find the first row of each type in one chunk of a first_rows_scan.
+static void first_rows_chunk(void *context, int chunk,
+    int first_word, int end_word);
+
+// Count the rows of one chunk of a collect_scan.
+static void count_chunk(void *context, int chunk,
+    int first_word, int end_word);
+
+// Copy the nodes of one chunk of a collect_scan to its place in nodes.
+static void collect_chunk(void *context, int chunk,
+    int first_word, int end_word);
+
+// Match the names of one chunk of a match_scan.
+static void match_chunk(void *context, int chunk,
+    int first_word, int end_word);
+
+// Return word `word` of `a` AND `b`, where a NULL `b` is all ones.
+static inline uint64_t both_bits(const uint64_t *a, const uint64_t *b,
+    int word) {
+    return b == NULL ? a[word] : a[word] & b[word];
+}
+
+// Creates new Columns, and returns a pointer to them.
+Columns new_columns(void) {
+    Columns columns = calloc(1, sizeof(struct columns));
+    assert(columns != NULL);
+    STATS_ALLOC(sizeof(struct columns));
+
+    grow_rows(columns, INITIAL_ROWS);
+    grow_names(columns, INITIAL_NAME_BYTES);
+    columns->positions = new_fenwick();
+
+    return columns;
+}
+
+// Destroy the given Columns and free all associated memory.
+void destroy_columns(Columns columns) {
+    free(columns->id);
+    free(columns->type1);
+    free(columns->type2);
+    free(columns->height);
+    free(columns->weight);
+    free(columns->name);
+    free(columns->node);
+    free(columns->live);
+    free(columns->found);
+    free(columns->names);
+    destroy_fenwick(columns->positions);
+
+    int type = 0;
+    while (type < MAX_TYPE) {
+        free(columns->type_bits[type]);
+        type++;
+    }
+
+    free(columns);
+}
+
+// Add a row for `pokemon` and return its number.
+int columns_append(Columns columns, Pokemon pokemon, int found, void *node) {
+    if (columns->rows == columns->capacity) {
+        grow_rows(columns, columns->capacity * 2);
+    }
+
+    char *name = pokemon_name(pokemon);
+    int length = strlen(name) + 1;
+    grow_names(columns, length);
+
+    int row = columns->rows;
+    columns->id[row] = pokemon_id(pokemon);
+    columns->type1[row] = pokemon_first_type(pokemon);
+    columns->type2[row] = pokemon_second_type(pokemon);
+    columns->height[row] = pokemon_height(pokemon);
+    columns->weight[row] = pokemon_weight(pokemon);
+    columns->name[row] = columns->names_size;
+    columns->node[row] = node;
+
+    memcpy(columns->names + columns->names_size, name, length);
+    columns->names_size += length;
+
+    columns->live[row >> 6] |= (uint64_t) 1 << (row & 63);
+    if (found) {
+        columns->found[row >> 6] |= (uint64_t) 1 << (row & 63);
+    }
+    columns->type_bits[columns->type1[row]][row >> 6]
+        |= (uint64_t) 1 << (row & 63);
+    columns->type_bits[columns->type2[row]][row >> 6]
+        |= (uint64_t) 1 << (row & 63);
+
+    fenwick_append(columns->positions, 1);
+
+    columns->rows++;
+    return row;
+}
+
+// Mark `row` as removed.
+void columns_remove(Columns columns, int row) {
+    columns->live[row >> 6] &= ~((uint64_t) 1 << (row & 63));
+    columns->found[row >> 6] &= ~((uint64_t) 1 << (row & 63));
+    columns->type_bits[columns->type1[row]][row >> 6]
+        &= ~((uint64_t) 1 << (row & 63));
+    columns->type_bits[columns->type2[row]][row >> 6]
+        &= ~((uint64_t) 1 << (row & 63));
+    columns->node[row] = NULL;
+    fenwick_add(columns->positions, row, -1);
+    columns->removed++;
+}
+
+// Mark the Pokemon in `row` as found.
+void columns_set_found(Columns columns, int row) {
+    columns->found[row >> 6] |= (uint64_t) 1 << (row & 63);
+}
+
+// Return the first row with a bit set in `bits` and clear in `except`.
+int columns_first_row(Columns columns, const uint64_t *bits,
+    const uint64_t *except) {
+
+    int words = column_words(columns);
+    int word = 0;
+    while (word < words) {
+        uint64_t set = bits[word];
+        if (except != NULL) {
+            set &= ~except[word];
+        }
+        if (set != 0) {
+            return word * 64 + __builtin_ctzll(set);
+        }
+        word++;
+    }
+
+    return -1;
+}
+
+// Find the first row of each type clear in `except`.
+// Every chunk looks for every type, but skips a type once an earlier
+// chunk has found it, so with one thread this stops where
+// columns_first_row would for each type.
+// Types not asked for start as found at row 0, so no chunk scans them.
+void columns_first_rows(Columns columns, const uint64_t *except,
+    unsigned int types, int first_rows[MAX_TYPE]) {
+
+    struct first_rows_scan scan;
+    scan.columns = columns;
+    scan.except = except;
+
+    int type = 0;
+    while (type < MAX_TYPE) {
+        scan.first[type] = (types & (1u << type)) ? INT_MAX : 0;
+        type++;
+    }
+
+    run_scan(column_words(columns), first_rows_chunk, &scan);
+
+    type = 0;
+    while (type < MAX_TYPE) {
+        first_rows[type] = -1;
+        if ((types & (1u << type)) && scan.first[type] != INT_MAX) {
+            first_rows[type] = scan.first[type];
+        }
+        type++;
+    }
+}
+
+// Collect the nodes of the rows set in `a` and `b`.
+// The first pass counts each chunk's rows, so that the second can
+// write each chunk's nodes straight to their place.
+int columns_collect(Columns columns, const uint64_t *a, const uint64_t *b,
+    void ***nodes) {
+
+    int words = column_words(columns);
+    int chunks = scan_chunks(words);
+
+    struct collect_scan scan;
+    scan.columns = columns;
+    scan.a = a;
+    scan.b = b;
+    scan.offsets = malloc((chunks + 1) * sizeof(int));
+    assert(scan.offsets != NULL);
+    STATS_ALLOC((chunks + 1) * sizeof(int));
+
+    run_scan(words, count_chunk, &scan);
+
+    int size = 0;
+    int chunk = 0;
+    while (chunk < chunks) {
+        int count = scan.offsets[chunk];
+        scan.offsets[chunk] = size;
+        size += count;
+        chunk++;
+    }
+
+    scan.nodes = NULL;
+    if (size > 0) {
+        scan.nodes = malloc(size * sizeof(void *));
+        assert(scan.nodes != NULL);
+        STATS_ALLOC(size * sizeof(void *));
+        run_scan(words, collect_chunk, &scan);
+    }
+
+    free(scan.offsets);
+    *nodes = scan.nodes;
+    return size;
+}
+
+// Set `matches` to the rows set in `a` and `b` whose names hold text.
+// Each chunk writes only its own words of matches.
+int columns_match_names(Columns columns, const uint64_t *a,
+    const uint64_t *b, const char *text, int text_length,
+    uint64_t *matches) {
+
+    struct match_scan scan;
+    scan.columns = columns;
+    scan.a = a;
+    scan.b = b;
+    scan.text = text;
+    scan.text_length = text_length;
+    scan.matches = matches;
+    scan.checked = 0;
+
+    run_scan(column_words(columns), match_chunk, &scan);
+
+    return scan.checked;
+}
+
+// Find the first row of each type in one chunk of a first_rows_scan,
+// lowering the type's first row if it is the earliest yet.
+static void first_rows_chunk(void *context, int chunk,
+    int first_word, int end_word) {
+
+    struct first_rows_scan *scan = context;
+    Columns columns = scan->columns;
+
+    int type = NONE_TYPE + 1;
+    while (type < MAX_TYPE) {
+        int *first = &scan->first[type];
+        const uint64_t *bits = columns->type_bits[type];
+
+        int word = first_word;
+        while (word < end_word
+                && word * 64 < __atomic_load_n(first, __ATOMIC_RELAXED)) {
+            uint64_t set = bits[word];
+            if (scan->except != NULL) {
+                set &= ~scan->except[word];
+            }
+            if (set != 0) {
+                int row = word * 64 + __builtin_ctzll(set);
+                int seen = __atomic_load_n(first, __ATOMIC_RELAXED);
+                while (row < seen && !__atomic_compare_exchange_n(first,
+                        &seen, row, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                }
+                break;
+            }
+            word++;
+        }
+
+        type++;
+    }
+}
+
+// Count the rows of one chunk of a collect_scan into its offset.
+static void count_chunk(void *context, int chunk,
+    int first_word, int end_word) {
+
+    struct collect_scan *scan = context;
+
+    int count = 0;
+    int word = first_word;
+    while (word < end_word) {
+        count += __builtin_popcountll(both_bits(scan->a, scan->b, word));
+        word++;
+    }
+    scan->offsets[chunk] = count;
+}
+
+// Copy the nodes of one chunk of a collect_scan, from its offset on.
+static void collect_chunk(void *context, int chunk,
+    int first_word, int end_word) {
+
+    struct collect_scan *scan = context;
+    void **nodes = scan->nodes + scan->offsets[chunk];
+
+    int word = first_word;
+    while (word < end_word) {
+        uint64_t set = both_bits(scan->a, scan->b, word);
+        while (set != 0) {
+            *nodes = scan->columns->node[word * 64 + __builtin_ctzll(set)];
+            nodes++;
+            set &= set - 1;
+        }
+        word++;
+    }
+}
+
+// Match the names of the rows in one chunk of a match_scan.
+static void match_chunk(void *context, int chunk,
+    int first_word, int end_word) {
+
+    struct match_scan *scan = context;
+    Columns columns = scan->columns;
+
+    int checked = 0;
+    int word = first_word;
+    while (word < end_word) {
+        uint64_t set = both_bits(scan->a, scan->b, word);
+        uint64_t matched = 0;
+        while (set != 0) {
+            int bit = __builtin_ctzll(set);
+            int row = word * 64 + bit;
+            if (name_contains(columns_name(columns, row),
+                    columns_name_length(columns, row),
+                    scan->text, scan->text_length)) {
+                matched |= (uint64_t) 1 << bit;
+            }
+            checked++;
+            set &= set - 1;
+        }
+        scan->matches[word] = matched;
+        word++;
+    }
+    __atomic_fetch_add(&scan->checked, checked, __ATOMIC_RELAXED);
+}
+
+// Resize every array of columns to hold `capacity` rows.
+// The bitsets are cleared past the old capacity.
+// type_bits[NONE_TYPE] is kept like the others, but never queried.
+static void grow_rows(Columns columns, int capacity) {
+    int old_words = (columns->capacity + 63) / 64;
+    int words = (capacity + 63) / 64;
+
+    columns->id = resize(columns->id, capacity, sizeof(int32_t));
+    columns->type1 = resize(columns->type1, capacity, sizeof(uint8_t));
+    columns->type2 = resize(columns->type2, capacity, sizeof(uint8_t));
+    columns->height = resize(columns->height, capacity, sizeof(double));
+    columns->weight = resize(columns->weight, capacity, sizeof(double));
+    columns->name = resize(columns->name, capacity, sizeof(int32_t));
+    columns->node = resize(columns->node, capacity, sizeof(void *));
+    columns->live = resize(columns->live, words, sizeof(uint64_t));
+    columns->found = resize(columns->found, words, sizeof(uint64_t));
+
+    memset(columns->live + old_words, 0,
+        (words - old_words) * sizeof(uint64_t));
+    memset(columns->found + old_words, 0,
+        (words - old_words) * sizeof(uint64_t));
+
+    int type = 0;
+    while (type < MAX_TYPE) {
+        columns->type_bits[type] = resize(columns->type_bits[type],
+            words, sizeof(uint64_t));
+        memset(columns->type_bits[type] + old_words, 0,
+            (words - old_words) * sizeof(uint64_t));
+        type++;
+    }
+
+    columns->capacity = capacity;
+}
+
+// Make room for `length` more bytes in the name pool,
+// keeping the padding after the last name.
+// New bytes are zeroed, so the padding is never uninitialised.
+static void grow_names(Columns columns, int length) {
+    int needed = columns->names_size + length + NAME_MATCH_PADDING;
+    if (needed <= columns->names_capacity) {
+        return;
+    }
+
+    int capacity = columns->names_capacity;
+    if (capacity == 0) {
+        capacity = INITIAL_NAME_BYTES;
+    }
+    while (capacity < needed) {
+        capacity = capacity * 2;
+    }
+
+    columns->names = resize(columns->names, capacity, sizeof(char));
+    memset(columns->names + columns->names_capacity, 0,
+        capacity - columns->names_capacity);
+    columns->names_capacity = capacity;
+}
+
+// Return `p` resized to `count` elements of `size` bytes.
+static void *resize(void *p, int count, int size) {
+    p = realloc(p, (size_t) count * size);
+    assert(p != NULL);
+    STATS_ALLOC((size_t) count * size);
+    return p;
+}
@@ -0,0 +1,138 @@
+// columns.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _COLUMNS_H_
+#define _COLUMNS_H_
+
+#include <stdint.h>
+
+#include "pokemon.h"
+#include "namematch.h"
+#include "fenwick.h"
+
+// A structure-of-arrays copy of the Pokemon in a Pokedex.
+// Row r of every array describes the same Pokemon, and rows are in
+// the order the Pokemon were added, so scans are linear passes over
+// packed arrays instead of walks over nodes.
+// Removed rows stay in place, cleared from `live`, until the owner
+// rebuilds the columns.
+//
+// type_bits[t] has a bit set for every live row with t as either of
+// its types, so type queries are bitmap ANDs.
+//
+// positions counts the live rows in a Fenwick tree, so the position
+// of a row among the live rows, and the row at a position, take
+// O(log n).
+//
+// Names are stored one after another in `names`, which always has
+// NAME_MATCH_PADDING readable bytes past the last name,
+// so any name can be passed straight to name_contains.
+struct columns {
+    int      rows;
+    int      capacity;
+    int      removed;
+    int32_t  *id;
+    uint8_t  *type1;
+    uint8_t  *type2;
+    double   *height;
+    double   *weight;
+    int32_t  *name;
+    void     **node;
+    uint64_t *live;
+    uint64_t *found;
+    uint64_t *type_bits[MAX_TYPE];
+    Fenwick  positions;
+    char     *names;
+    int      names_size;
+    int      names_capacity;
+};
+
+typedef struct columns *Columns;
+
+// Create new, empty Columns and return a pointer to them.
+Columns new_columns(void);
+
+// Destroy the given Columns and free all associated memory.
+void destroy_columns(Columns columns);
+
+// Add a row for `pokemon`, owned by `node`, and return its number.
+int columns_append(Columns columns, Pokemon pokemon, int found, void *node);
+
+// Mark `row` as removed.
+void columns_remove(Columns columns, int row);
+
+// Mark the Pokemon in `row` as found.
+void columns_set_found(Columns columns, int row);
+
+// Return the number of live rows before `row`.
+static inline int columns_position(Columns columns, int row) {
+    return fenwick_prefix(columns->positions, row);
+}
+
+// Return the live row at `position` (0 for the first),
+// or -1 if there are not that many.
+static inline int columns_row_at(Columns columns, int position) {
+    return fenwick_find(columns->positions, position);
+}
+
+// Return the name of the Pokemon in `row`.
+static inline char *columns_name(Columns columns, int row) {
+    return columns->names + columns->name[row];
+}
+
+// Return the length of the name of the Pokemon in `row`.
+// Each name ends where the next row's name starts.
+static inline int columns_name_length(Columns columns, int row) {
+    int end = columns->names_size;
+    if (row + 1 < columns->rows) {
+        end = columns->name[row + 1];
+    }
+    return end - columns->name[row] - 1;
+}
+
+// Return bit `row` of a bitset.
+static inline int column_bit(const uint64_t *bits, int row) {
+    return (bits[row >> 6] >> (row & 63)) & 1;
+}
+
+// Return the number of 64-bit words in each bitset of columns.
+static inline int column_words(Columns columns) {
+    return (columns->rows + 63) / 64;
+}
+
+// Return the first row with a bit set in `bits` and clear in `except`,
+// or -1 if there is none. `except` may be NULL.
+int columns_first_row(Columns columns, const uint64_t *bits,
+    const uint64_t *except);
+
+// The scans below split the columns into chunks run on the scan
+// threads (see scan.h), and give the same results on any number.
+
+// A set of types for columns_first_rows: bit t is type t.
+#define ALL_TYPES (((1u << MAX_TYPE) - 1) & ~(1u << NONE_TYPE))
+
+// Set first_rows[t], for every type t in `types`, to the first row
+// with t as either of its types and clear in `except`, or -1 if there
+// is none. Types not in `types` are set to -1 without a scan.
+// `except` may be NULL.
+void columns_first_rows(Columns columns, const uint64_t *except,
+    unsigned int types, int first_rows[MAX_TYPE]);
+
+// Set *nodes to a malloced array of the node of every row with a bit
+// set in both `a` and `b`, in row order, and return how many there
+// are. *nodes is NULL if there are none. `b` may be NULL.
+int columns_collect(Columns columns, const uint64_t *a, const uint64_t *b,
+    void ***nodes);
+
+// Set `matches` (column_words words) to the rows with a bit set in both
+// `a` and `b` whose names contain `text`, and return how many rows
+// were checked.
+int columns_match_names(Columns columns, const uint64_t *a,
+    const uint64_t *b, const char *text, int text_length,
+    uint64_t *matches);
+
+#endif // _COLUMNS_H_
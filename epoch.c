@@ -0,0 +1,184 @@
+// epoch.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "epoch.h"
+#include "stats.h"
+
+#define CACHE_LINE 64
+// The epoch a participant announces is 2 * epoch + 1 while it reads,
+// and NOT_READING while it does not.
+#define NOT_READING 0
+
+// Each participant's announced epoch has a cache line of its own,
+// so readers entering and leaving do not slow each other down.
+struct participant {
+    uint64_t announced;
+    int      claimed;
+    char     padding[CACHE_LINE - sizeof(uint64_t) - sizeof(int)];
+};
+
+struct retired {
+    void                *object;
+    epoch_free_function free_object;
+    uint64_t            epoch;
+    struct retired      *next;
+};
+
+// An object retired in epoch e may be in use by readers that entered
+// in e - 1 or e, so it is freed once the epoch reaches e + 2.
+// The retired list is only touched by the writing thread.
+struct epochs {
+    struct participant participants[MAX_EPOCH_PARTICIPANTS];
+    uint64_t           epoch;
+    int                num_participants;
+    struct retired     *retired;
+    int                num_retired;
+};
+
+// Creates a new Epochs, and returns a pointer to it.
+Epochs new_epochs(void) {
+    // aligned_alloc wants a multiple of the alignment.
+    size_t size = (sizeof(struct epochs) + CACHE_LINE - 1)
+        / CACHE_LINE * CACHE_LINE;
+    Epochs epochs = aligned_alloc(CACHE_LINE, size);
+    assert(epochs != NULL);
+    STATS_ALLOC(size);
+
+    int i = 0;
+    while (i < MAX_EPOCH_PARTICIPANTS) {
+        epochs->participants[i].announced = NOT_READING;
+        epochs->participants[i].claimed = 0;
+        i++;
+    }
+    epochs->epoch = 1;
+    epochs->num_participants = 0;
+    epochs->retired = NULL;
+    epochs->num_retired = 0;
+
+    return epochs;
+}
+
+// Free everything still retired, and destroy the Epochs.
+void destroy_epochs(Epochs epochs) {
+    struct retired *curr = epochs->retired;
+    while (curr != NULL) {
+        struct retired *next = curr->next;
+        curr->free_object(curr->object);
+        free(curr);
+        curr = next;
+    }
+    free(epochs);
+}
+
+// Claim the first participant number nobody holds.
+// Only participants below num_participants are checked by
+// epoch_reclaim, so it is raised before the number is used.
+int epoch_register(Epochs epochs) {
+    int i = 0;
+    while (i < MAX_EPOCH_PARTICIPANTS) {
+        int unclaimed = 0;
+        if (__atomic_compare_exchange_n(&epochs->participants[i].claimed,
+                &unclaimed, 1, 0, __ATOMIC_ACQ_REL,
+                __ATOMIC_RELAXED)) {
+            int count = __atomic_load_n(&epochs->num_participants,
+                __ATOMIC_RELAXED);
+            while (count < i + 1 && !__atomic_compare_exchange_n(
+                    &epochs->num_participants, &count, i + 1, 0,
+                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            }
+            return i;
+        }
+        i++;
+    }
+
+    fprintf(stderr, "Too many Pokedex sessions (at most %d)\n",
+        MAX_EPOCH_PARTICIPANTS);
+    exit(1);
+}
+
+void epoch_unregister(Epochs epochs, int participant) {
+    __atomic_store_n(&epochs->participants[participant].announced,
+        NOT_READING, __ATOMIC_RELEASE);
+    __atomic_store_n(&epochs->participants[participant].claimed, 0,
+        __ATOMIC_RELEASE);
+}
+
+// Announce the current epoch. The fence orders the announcement
+// before every read that follows it, against the fence in
+// epoch_reclaim: either the writer sees the announcement, or the
+// reader sees everything the writer unlinked before checking.
+void epoch_enter(Epochs epochs, int participant) {
+    uint64_t epoch = __atomic_load_n(&epochs->epoch, __ATOMIC_RELAXED);
+    __atomic_store_n(&epochs->participants[participant].announced,
+        2 * epoch + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void epoch_exit(Epochs epochs, int participant) {
+    __atomic_store_n(&epochs->participants[participant].announced,
+        NOT_READING, __ATOMIC_RELEASE);
+}
+
+void epoch_retire(Epochs epochs, void *object,
+    epoch_free_function free_object) {
+    struct retired *retired = malloc(sizeof(struct retired));
+    assert(retired != NULL);
+    STATS_ALLOC(sizeof(struct retired));
+    retired->object = object;
+    retired->free_object = free_object;
+    retired->epoch = epochs->epoch;
+    retired->next = epochs->retired;
+    epochs->retired = retired;
+    epochs->num_retired++;
+
+    epoch_reclaim(epochs);
+}
+
+// The epoch only moves on when every reader is in it, or not reading.
+int epoch_reclaim(Epochs epochs) {
+    if (epochs->num_retired == 0) {
+        return 0;
+    }
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    uint64_t epoch = epochs->epoch;
+    int caught_up = 1;
+    int count = __atomic_load_n(&epochs->num_participants, __ATOMIC_ACQUIRE);
+    int i = 0;
+    while (caught_up && i < count) {
+        uint64_t announced = __atomic_load_n(
+            &epochs->participants[i].announced, __ATOMIC_ACQUIRE);
+        if (announced != NOT_READING && announced != 2 * epoch + 1) {
+            caught_up = 0;
+        }
+        i++;
+    }
+    if (caught_up) {
+        epoch++;
+        __atomic_store_n(&epochs->epoch, epoch, __ATOMIC_RELEASE);
+    }
+
+    struct retired **link = &epochs->retired;
+    while (*link != NULL) {
+        struct retired *curr = *link;
+        if (curr->epoch + 2 <= epoch) {
+            *link = curr->next;
+            curr->free_object(curr->object);
+            free(curr);
+            epochs->num_retired--;
+        } else {
+            link = &curr->next;
+        }
+    }
+
+    return epochs->num_retired;
+}
@@ -0,0 +1,58 @@
+// epoch.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _EPOCH_H_
+#define _EPOCH_H_
+
+// Epoch-based reclamation: memory that readers may still be using,
+// without locks, is retired by the one thread that changes it, and
+// only freed once every reader that could have seen it has left the
+// epoch it was reading in.
+//
+// Each reading thread registers as a participant, and brackets each
+// read with epoch_enter and epoch_exit. Entering and leaving are two
+// atomic stores; a reader never waits.
+#define MAX_EPOCH_PARTICIPANTS 64
+
+typedef struct epochs *Epochs;
+
+// A function that frees a retired object.
+typedef void (*epoch_free_function)(void *object);
+
+// Create a new Epochs, with no participants and nothing retired.
+Epochs new_epochs(void);
+
+// Free everything still retired, and destroy the Epochs.
+// Every participant must have been unregistered.
+void destroy_epochs(Epochs epochs);
+
+// Register a reading thread, and return its participant number.
+// Exits with an error if there are already MAX_EPOCH_PARTICIPANTS.
+int epoch_register(Epochs epochs);
+
+// Give back a participant number returned by epoch_register.
+void epoch_unregister(Epochs epochs, int participant);
+
+// Start reading: nothing retired from now on is freed until
+// epoch_exit.
+void epoch_enter(Epochs epochs, int participant);
+
+// Stop reading.
+void epoch_exit(Epochs epochs, int participant);
+
+// Retire an object that readers can no longer reach, to be freed
+// with free_object once none of them can still be using it.
+// Only the writing thread may retire objects.
+void epoch_retire(Epochs epochs, void *object,
+    epoch_free_function free_object);
+
+// Advance the epoch if every reader has caught up with it, and free
+// what can be freed. Returns the number of objects still retired.
+// Only the writing thread may call this.
+int epoch_reclaim(Epochs epochs);
+
+#endif // _EPOCH_H_
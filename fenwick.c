@@ -0,0 +1,115 @@
+// fenwick.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "fenwick.h"
+#include "stats.h"
+
+#define INITIAL_CAPACITY 64
+
+// tree[i] (from 1) is the sum of the counts at positions
+// i - (i & -i) to i - 1, so any prefix is the sum of O(log n) of them.
+struct fenwick {
+    int size;
+    int capacity;
+    int *tree;
+};
+
+// Return the lowest set bit of i.
+static inline int low_bit(int i) {
+    return i & -i;
+}
+
+// Creates a new Fenwick tree, and returns a pointer to it.
+Fenwick new_fenwick(void) {
+    Fenwick fenwick = malloc(sizeof(struct fenwick));
+    assert(fenwick != NULL);
+    STATS_ALLOC(sizeof(struct fenwick));
+
+    fenwick->size = 0;
+    fenwick->capacity = INITIAL_CAPACITY;
+    fenwick->tree = malloc((INITIAL_CAPACITY + 1) * sizeof(int));
+    assert(fenwick->tree != NULL);
+    STATS_ALLOC((INITIAL_CAPACITY + 1) * sizeof(int));
+
+    return fenwick;
+}
+
+// Destroy the given Fenwick tree and free all associated memory.
+void destroy_fenwick(Fenwick fenwick) {
+    free(fenwick->tree);
+    free(fenwick);
+}
+
+// Add a new last position, holding `count`.
+// Its node covers the positions from i - (i & -i), which are all
+// there already, so it is `count` plus their sum.
+void fenwick_append(Fenwick fenwick, int count) {
+    if (fenwick->size == fenwick->capacity) {
+        fenwick->capacity = fenwick->capacity * 2;
+        fenwick->tree = realloc(fenwick->tree,
+            (fenwick->capacity + 1) * sizeof(int));
+        assert(fenwick->tree != NULL);
+        STATS_ALLOC((fenwick->capacity + 1) * sizeof(int));
+    }
+
+    int i = fenwick->size + 1;
+    fenwick->tree[i] = count + fenwick_prefix(fenwick, i - 1)
+        - fenwick_prefix(fenwick, i - low_bit(i));
+    fenwick->size = i;
+}
+
+// Add `change` to the count at `position`.
+void fenwick_add(Fenwick fenwick, int position, int change) {
+    int i = position + 1;
+    while (i <= fenwick->size) {
+        fenwick->tree[i] += change;
+        i += low_bit(i);
+    }
+}
+
+// Return the sum of the counts before `position`.
+int fenwick_prefix(Fenwick fenwick, int position) {
+    int sum = 0;
+    int i = position;
+    while (i > 0) {
+        sum += fenwick->tree[i];
+        i -= low_bit(i);
+    }
+    return sum;
+}
+
+// Return the position holding unit `n` of all the counts.
+// It goes down the tree from the largest power of two, skipping every
+// node whose counts are all before unit n.
+int fenwick_find(Fenwick fenwick, int n) {
+    if (n < 0) {
+        return -1;
+    }
+
+    int step = 1;
+    while (step * 2 <= fenwick->size) {
+        step = step * 2;
+    }
+
+    int position = 0;
+    while (step > 0) {
+        if (position + step <= fenwick->size
+                && fenwick->tree[position + step] <= n) {
+            position += step;
+            n -= fenwick->tree[position];
+        }
+        step = step / 2;
+    }
+
+    if (position >= fenwick->size) {
+        return -1;
+    }
+    return position;
+}
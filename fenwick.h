@@ -0,0 +1,37 @@
+// fenwick.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _FENWICK_H_
+#define _FENWICK_H_
+
+// A Fenwick tree (binary indexed tree) over a growing array of counts,
+// at positions 0, 1, 2, ...
+// Counts before a position, and the position holding the n-th unit
+// counted, are found in O(log n).
+typedef struct fenwick *Fenwick;
+
+// Create a new Fenwick tree with no positions and return a pointer to it.
+Fenwick new_fenwick(void);
+
+// Destroy the given Fenwick tree and free all associated memory.
+void destroy_fenwick(Fenwick fenwick);
+
+// Add a new last position, holding `count`.
+void fenwick_append(Fenwick fenwick, int count);
+
+// Add `change` to the count at `position`.
+void fenwick_add(Fenwick fenwick, int position, int change);
+
+// Return the sum of the counts before `position`.
+int fenwick_prefix(Fenwick fenwick, int position);
+
+// Return the position holding unit `n` (0 for the first) of all the
+// counts, or -1 if they add up to n or less.
+// Counts must not be negative.
+int fenwick_find(Fenwick fenwick, int n);
+
+#endif // _FENWICK_H_
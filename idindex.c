@@ -0,0 +1,194 @@
+// idindex.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "idindex.h"
+#include "stats.h"
+
+#define INITIAL_CAPACITY 16
+#define EMPTY_KEY (-1)
+
+// Slots are kept at most half full, so probe sequences stay short.
+struct id_index {
+    struct id_slot *slots;
+    int            capacity;
+    int            size;
+};
+
+struct id_slot {
+    int  key;
+    void *value;
+};
+
+// Return the home slot of `id` in a table of `capacity` slots.
+static int home_slot(int id, int capacity);
+
+// Allocate `capacity` empty slots.
+static struct id_slot *new_slots(int capacity);
+
+// Double the capacity of the index and rehash every id.
+static void grow_index(IdIndex index);
+
+// Move every id into a table of `capacity` slots.
+static void rehash_index(IdIndex index, int capacity);
+
+// Creates a new IdIndex, and returns a pointer to it.
+IdIndex new_id_index(void) {
+    IdIndex index = malloc(sizeof(struct id_index));
+    assert(index != NULL);
+    STATS_ALLOC(sizeof(struct id_index));
+
+    index->slots = new_slots(INITIAL_CAPACITY);
+    index->capacity = INITIAL_CAPACITY;
+    index->size = 0;
+
+    return index;
+}
+
+// Destroy the given IdIndex and free all associated memory.
+void destroy_id_index(IdIndex index) {
+    free(index->slots);
+    free(index);
+}
+
+// Return the value stored for `id`, or NULL if there is none.
+void *id_index_get(IdIndex index, int id) {
+    int mask = index->capacity - 1;
+    int i = home_slot(id, index->capacity);
+
+    while (index->slots[i].key != EMPTY_KEY) {
+        if (index->slots[i].key == id) {
+            return index->slots[i].value;
+        }
+        i = (i + 1) & mask;
+    }
+
+    return NULL;
+}
+
+// Store `value` for `id`, replacing any previous value.
+void id_index_put(IdIndex index, int id, void *value) {
+    assert(id >= 0);
+
+    if (2 * (index->size + 1) > index->capacity) {
+        grow_index(index);
+    }
+
+    int mask = index->capacity - 1;
+    int i = home_slot(id, index->capacity);
+
+    while (index->slots[i].key != EMPTY_KEY) {
+        if (index->slots[i].key == id) {
+            index->slots[i].value = value;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    index->slots[i].key = id;
+    index->slots[i].value = value;
+    index->size++;
+}
+
+// Remove `id` from the index.
+// Later slots of the same probe run are shifted back into the hole,
+// so lookups never need tombstones.
+void id_index_remove(IdIndex index, int id) {
+    int mask = index->capacity - 1;
+    int i = home_slot(id, index->capacity);
+
+    while (index->slots[i].key != id) {
+        if (index->slots[i].key == EMPTY_KEY) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    int hole = i;
+    int j = (hole + 1) & mask;
+    while (index->slots[j].key != EMPTY_KEY) {
+        int home = home_slot(index->slots[j].key, index->capacity);
+
+        // Move slot j into the hole unless its home lies
+        // cyclically in (hole, j].
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            index->slots[hole] = index->slots[j];
+            hole = j;
+        }
+        j = (j + 1) & mask;
+    }
+
+    index->slots[hole].key = EMPTY_KEY;
+    index->slots[hole].value = NULL;
+    index->size--;
+}
+
+// Make room for `size` ids in total, keeping the load at most half.
+void id_index_reserve(IdIndex index, int size) {
+    int capacity = index->capacity;
+    while (2 * size > capacity) {
+        capacity *= 2;
+    }
+    if (capacity != index->capacity) {
+        rehash_index(index, capacity);
+    }
+}
+
+// Return the number of ids stored in the index.
+int id_index_size(IdIndex index) {
+    return index->size;
+}
+
+// Fibonacci hashing: the top bits of id * 2^32/phi.
+static int home_slot(int id, int capacity) {
+    uint32_t hash = (uint32_t) id * 2654435769u;
+    return (int) ((((uint64_t) hash) * (uint32_t) capacity) >> 32);
+}
+
+// Allocate `capacity` empty slots.
+static struct id_slot *new_slots(int capacity) {
+    struct id_slot *slots = malloc(capacity * sizeof(struct id_slot));
+    assert(slots != NULL);
+    STATS_ALLOC(capacity * sizeof(struct id_slot));
+
+    int i = 0;
+    while (i < capacity) {
+        slots[i].key = EMPTY_KEY;
+        slots[i].value = NULL;
+        i++;
+    }
+
+    return slots;
+}
+
+// Double the capacity of the index and rehash every id.
+static void grow_index(IdIndex index) {
+    rehash_index(index, index->capacity * 2);
+}
+
+// Move every id into a table of `capacity` slots.
+static void rehash_index(IdIndex index, int capacity) {
+    struct id_slot *old_slots = index->slots;
+    int old_capacity = index->capacity;
+
+    index->capacity = capacity;
+    index->slots = new_slots(index->capacity);
+    index->size = 0;
+
+    int i = 0;
+    while (i < old_capacity) {
+        if (old_slots[i].key != EMPTY_KEY) {
+            id_index_put(index, old_slots[i].key, old_slots[i].value);
+        }
+        i++;
+    }
+
+    free(old_slots);
+}
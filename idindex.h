@@ -0,0 +1,39 @@
+// idindex.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _IDINDEX_H_
+#define _IDINDEX_H_
+
+// An open-addressing hash index from a non-negative pokemon_id
+// to a pointer (the pokenode holding that Pokemon).
+typedef struct id_index *IdIndex;
+
+// Create a new, empty IdIndex and return a pointer to it.
+IdIndex new_id_index(void);
+
+// Destroy the given IdIndex and free all associated memory.
+// The values stored in the index are not freed.
+void destroy_id_index(IdIndex index);
+
+// Return the value stored for `id`, or NULL if there is none.
+void *id_index_get(IdIndex index, int id);
+
+// Store `value` for `id`, replacing any previous value.
+void id_index_put(IdIndex index, int id, void *value);
+
+// Remove `id` from the index.
+// If there is no value stored for `id`, this function does nothing.
+void id_index_remove(IdIndex index, int id);
+
+// Make room for `size` ids in total, so that adding them
+// does not have to grow the index again.
+void id_index_reserve(IdIndex index, int size);
+
+// Return the number of ids stored in the index.
+int id_index_size(IdIndex index);
+
+#endif // _IDINDEX_H_
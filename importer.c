@@ -0,0 +1,699 @@
+// importer.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+//
+// The file is read in chunks of whole lines. Each chunk is parsed,
+// checked and sorted by id on its own, by one of a pool of threads,
+// and the sorted chunks are then merged with a heap, so the rows come
+// out in id order without sorting the whole file at once.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <assert.h>
+
+#include "importer.h"
+#include "addcommand.h"
+
+#define TURE 1
+#define FALSE 0
+#define CHUNK_SIZE (1 << 20)
+#define MAX_FIELDS 6
+#define MIN_FIELDS 5
+#define CHUNKS_PER_THREAD 2
+#define NO_POKEMON_ID (-1)
+
+// A checked row; its name is an offset into the names of its chunk.
+struct parsed_row {
+    int          pokemon_id;
+    int          line;
+    uint32_t     name;
+    double       height;
+    double       weight;
+    pokemon_type type1;
+    pokemon_type type2;
+};
+
+// A chunk of whole lines of the file, and what was parsed from it.
+// Lines are counted from the start of the chunk until every chunk
+// has been parsed and the number of lines before it is known.
+struct chunk {
+    char                  *text;
+    size_t                size;
+    int                   first;
+    int                   lines;
+    struct parsed_row     *rows;
+    int                   num_rows;
+    int                   rows_capacity;
+    char                  *names;
+    size_t                names_size;
+    size_t                names_capacity;
+    int                   invalid;
+    int                   num_examples;
+    struct import_problem examples[IMPORT_EXAMPLES];
+    int                   position;
+};
+
+struct import_file {
+    struct chunk    **chunks;
+    int             num_chunks;
+    int             chunks_capacity;
+    char            delimiter;
+
+    // The chunks from next_to_parse on wait for a thread to parse them.
+    pthread_mutex_t lock;
+    pthread_cond_t  work_ready;
+    pthread_cond_t  work_done;
+    int             next_to_parse;
+    int             num_parsed;
+    int             reading_done;
+
+    // A heap of the chunks with rows left, by their next row.
+    int             *heap;
+    int             heap_size;
+};
+
+// Wait for chunks, and parse them, until the file has been read.
+static void *parse_worker(void *arg);
+
+// Hand a chunk of whole lines over to be parsed.
+static void add_chunk(ImportFile file, char *text, size_t size,
+    int threads);
+
+// Once every chunk is parsed, number their lines from the start of
+// the file, fill in report and set up the heap.
+static void finish_chunks(ImportFile file, struct import_report *report);
+
+// Parse, check and sort the lines of a chunk, then free its text.
+static void parse_chunk(struct chunk *chunk, char delimiter);
+
+// Parse and check one line, ending at end, of a chunk.
+static void parse_line(struct chunk *chunk, char *start, char *end,
+    int line, char delimiter);
+
+// Split a line into '\0'-terminated fields with the space around them
+// removed, and return how many there are (more than MAX_FIELDS
+// are counted but not kept), or -1 if its quotes are unbalanced.
+static int split_line(char *start, char delimiter, char **fields);
+
+// Read a field as a decimal, as sscanf's %lf would.
+static int read_decimal(char *field, double *value);
+
+// Count an invalid line of chunk.
+static void add_invalid(struct chunk *chunk, int line, int pokemon_id,
+    const char *reason);
+
+// Add a checked row, and a copy of its name, to chunk.
+static void add_row(struct chunk *chunk, struct parsed_row row,
+    const char *name);
+
+// Return the delimiter of a file from its first line.
+static char find_delimiter(const char *text, size_t size);
+
+// Determine if the first line of a file is a header.
+static int is_header(const char *line);
+
+// Compare two rows by pokemon_id, then line.
+static int compare_rows(const void *a, const void *b);
+
+// Determine if the next row of chunk a comes before that of chunk b.
+static int row_before(ImportFile file, int a, int b);
+
+// Restore the heap from position i down.
+static void sift_down(ImportFile file, int i);
+
+// Free every chunk, the heap and file.
+static void free_import_file(ImportFile file);
+
+// Read and check every row of the file at `path`.
+ImportFile read_import_file(const char *path, int threads,
+    struct import_report *report) {
+
+    memset(report, 0, sizeof(struct import_report));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    ImportFile file = calloc(1, sizeof(struct import_file));
+    assert(file != NULL);
+    pthread_mutex_init(&file->lock, NULL);
+    pthread_cond_init(&file->work_ready, NULL);
+    pthread_cond_init(&file->work_done, NULL);
+
+    if (threads < 1) {
+        threads = 1;
+    }
+    pthread_t *workers = NULL;
+    if (threads > 1) {
+        workers = malloc(threads * sizeof(pthread_t));
+        assert(workers != NULL);
+        int i = 0;
+        while (i < threads) {
+            pthread_create(&workers[i], NULL, parse_worker, file);
+            i++;
+        }
+    }
+
+    // Each chunk is CHUNK_SIZE bytes read after the partial line
+    // left over from the last one, cut after its last newline.
+    char *carry = NULL;
+    size_t carry_size = 0;
+    int error = 0;
+    int end_of_file = FALSE;
+    while (!end_of_file && error == 0) {
+        size_t capacity = carry_size + CHUNK_SIZE;
+        char *text = malloc(capacity + 1);
+        assert(text != NULL);
+        if (carry_size > 0) {
+            memcpy(text, carry, carry_size);
+        }
+        free(carry);
+        carry = NULL;
+
+        size_t size = carry_size;
+        while (size < capacity) {
+            ssize_t n = read(fd, &text[size], capacity - size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0) {
+                error = errno;
+                break;
+            } else if (n == 0) {
+                end_of_file = TURE;
+                break;
+            }
+            size += n;
+        }
+
+        size_t end = size;
+        if (!end_of_file) {
+            while (end > 0 && text[end - 1] != '\n') {
+                end--;
+            }
+        }
+
+        carry_size = size - end;
+        if (end == 0) {
+            // No newline yet: keep reading into a bigger chunk.
+            carry = text;
+            continue;
+        }
+        if (carry_size > 0) {
+            carry = malloc(carry_size);
+            assert(carry != NULL);
+            memcpy(carry, &text[end], carry_size);
+        }
+        add_chunk(file, text, end, threads);
+    }
+    free(carry);
+    close(fd);
+
+    pthread_mutex_lock(&file->lock);
+    file->reading_done = TURE;
+    pthread_cond_broadcast(&file->work_ready);
+    pthread_mutex_unlock(&file->lock);
+    if (workers != NULL) {
+        int i = 0;
+        while (i < threads) {
+            pthread_join(workers[i], NULL);
+            i++;
+        }
+        free(workers);
+    }
+
+    if (error != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(error));
+        free_import_file(file);
+        return NULL;
+    }
+
+    finish_chunks(file, report);
+    return file;
+}
+
+// Take the next valid row, in order of pokemon_id.
+int next_import_row(ImportFile file, struct import_row *row) {
+    if (file->heap_size == 0) {
+        return FALSE;
+    }
+
+    struct chunk *chunk = file->chunks[file->heap[0]];
+    struct parsed_row *parsed = &chunk->rows[chunk->position];
+    row->pokemon_id = parsed->pokemon_id;
+    row->line = parsed->line;
+    row->name = &chunk->names[parsed->name];
+    row->height = parsed->height;
+    row->weight = parsed->weight;
+    row->type1 = parsed->type1;
+    row->type2 = parsed->type2;
+
+    chunk->position++;
+    if (chunk->position == chunk->num_rows) {
+        file->heap_size--;
+        file->heap[0] = file->heap[file->heap_size];
+    }
+    sift_down(file, 0);
+
+    return TURE;
+}
+
+// Count row in report as a duplicate of a pokemon_id already added.
+void import_report_duplicate(struct import_report *report,
+    struct import_row *row) {
+
+    if (report->num_duplicate_examples < IMPORT_EXAMPLES) {
+        struct import_problem *problem =
+            &report->duplicate_examples[report->num_duplicate_examples];
+        problem->line = row->line;
+        problem->pokemon_id = row->pokemon_id;
+        problem->reason = "duplicate pokemon_id";
+        report->num_duplicate_examples++;
+    }
+    report->duplicates++;
+}
+
+// Free an ImportFile and the names of its rows.
+void close_import_file(ImportFile file) {
+    free_import_file(file);
+}
+
+// Wait for chunks, and parse them, until the file has been read.
+static void *parse_worker(void *arg) {
+    ImportFile file = arg;
+
+    pthread_mutex_lock(&file->lock);
+    while (TURE) {
+        while (file->next_to_parse == file->num_chunks
+                && !file->reading_done) {
+            pthread_cond_wait(&file->work_ready, &file->lock);
+        }
+        if (file->next_to_parse == file->num_chunks) {
+            break;
+        }
+
+        struct chunk *chunk = file->chunks[file->next_to_parse];
+        file->next_to_parse++;
+        pthread_mutex_unlock(&file->lock);
+
+        parse_chunk(chunk, file->delimiter);
+
+        pthread_mutex_lock(&file->lock);
+        file->num_parsed++;
+        pthread_cond_signal(&file->work_done);
+    }
+    pthread_mutex_unlock(&file->lock);
+
+    return NULL;
+}
+
+// Hand a chunk of whole lines over to be parsed.
+// With one thread it is parsed straight away; otherwise the reader
+// waits while CHUNKS_PER_THREAD chunks per thread are still unparsed,
+// so memory stays bounded however large the file is.
+static void add_chunk(ImportFile file, char *text, size_t size,
+    int threads) {
+
+    struct chunk *chunk = calloc(1, sizeof(struct chunk));
+    assert(chunk != NULL);
+    chunk->text = text;
+    chunk->size = size;
+    chunk->first = file->num_chunks == 0;
+    if (chunk->first) {
+        file->delimiter = find_delimiter(text, size);
+    }
+
+    pthread_mutex_lock(&file->lock);
+    while (file->num_chunks - file->num_parsed >= CHUNKS_PER_THREAD * threads) {
+        pthread_cond_wait(&file->work_done, &file->lock);
+    }
+    if (file->num_chunks == file->chunks_capacity) {
+        file->chunks_capacity = file->chunks_capacity == 0
+            ? 16 : file->chunks_capacity * 2;
+        file->chunks = realloc(file->chunks,
+            file->chunks_capacity * sizeof(struct chunk *));
+        assert(file->chunks != NULL);
+    }
+    file->chunks[file->num_chunks] = chunk;
+    file->num_chunks++;
+
+    if (threads > 1) {
+        pthread_cond_signal(&file->work_ready);
+        pthread_mutex_unlock(&file->lock);
+    } else {
+        file->next_to_parse++;
+        pthread_mutex_unlock(&file->lock);
+        parse_chunk(chunk, file->delimiter);
+        file->num_parsed++;
+    }
+}
+
+// Once every chunk is parsed, number their lines from the start of
+// the file, fill in report and set up the heap.
+static void finish_chunks(ImportFile file, struct import_report *report) {
+    file->heap = malloc((file->num_chunks + 1) * sizeof(int));
+    assert(file->heap != NULL);
+
+    int lines_before = 0;
+    int i = 0;
+    while (i < file->num_chunks) {
+        struct chunk *chunk = file->chunks[i];
+
+        int j = 0;
+        while (j < chunk->num_rows) {
+            chunk->rows[j].line += lines_before;
+            j++;
+        }
+        j = 0;
+        while (j < chunk->num_examples
+                && report->num_invalid_examples < IMPORT_EXAMPLES) {
+            report->invalid_examples[report->num_invalid_examples] =
+                chunk->examples[j];
+            report->invalid_examples[report->num_invalid_examples].line +=
+                lines_before;
+            report->num_invalid_examples++;
+            j++;
+        }
+        report->rows += chunk->num_rows;
+        report->invalid += chunk->invalid;
+        lines_before += chunk->lines;
+
+        if (chunk->num_rows > 0) {
+            file->heap[file->heap_size] = i;
+            file->heap_size++;
+        }
+        i++;
+    }
+
+    i = file->heap_size / 2 - 1;
+    while (i >= 0) {
+        sift_down(file, i);
+        i--;
+    }
+}
+
+// Parse, check and sort the lines of a chunk, then free its text.
+// The text has room for a '\0' after its last byte.
+static void parse_chunk(struct chunk *chunk, char delimiter) {
+    char *p = chunk->text;
+    char *end = chunk->text + chunk->size;
+    int line = 0;
+
+    while (p < end) {
+        char *line_end = memchr(p, '\n', end - p);
+        if (line_end == NULL) {
+            line_end = end;
+        }
+        *line_end = '\0';
+        line++;
+
+        if (!(chunk->first && line == 1 && is_header(p))) {
+            parse_line(chunk, p, line_end, line, delimiter);
+        }
+        p = line_end + 1;
+    }
+    chunk->lines = line;
+
+    free(chunk->text);
+    chunk->text = NULL;
+    qsort(chunk->rows, chunk->num_rows, sizeof(struct parsed_row),
+        compare_rows);
+}
+
+// Parse and check one line, ending at end, of a chunk.
+// The checks are those of do_add and new_pokemon, which would
+// otherwise print an error or exit.
+static void parse_line(struct chunk *chunk, char *start, char *end,
+    int line, char delimiter) {
+
+    if (end > start && end[-1] == '\r') {
+        end[-1] = '\0';
+    }
+
+    char *fields[MAX_FIELDS];
+    int num_fields = split_line(start, delimiter, fields);
+    if (num_fields < 0) {
+        add_invalid(chunk, line, NO_POKEMON_ID, "unbalanced quotes");
+        return;
+    }
+    if (num_fields == 1 && fields[0][0] == '\0') {
+        return;
+    }
+    if (num_fields < MIN_FIELDS || num_fields > MAX_FIELDS) {
+        add_invalid(chunk, line, NO_POKEMON_ID, "wrong number of fields");
+        return;
+    }
+
+    struct parsed_row row;
+    row.line = line;
+    if (!read_plain_int(fields[0], strlen(fields[0]), &row.pokemon_id)
+            || row.pokemon_id < 0) {
+        add_invalid(chunk, line, NO_POKEMON_ID, "invalid pokemon_id");
+        return;
+    }
+    if (fields[1][0] == '\0' || !pokemon_valid_name(fields[1])) {
+        add_invalid(chunk, line, row.pokemon_id, "invalid name");
+        return;
+    }
+    if (!read_decimal(fields[2], &row.height)) {
+        add_invalid(chunk, line, row.pokemon_id, "invalid height");
+        return;
+    }
+    if (!read_decimal(fields[3], &row.weight)) {
+        add_invalid(chunk, line, row.pokemon_id, "invalid weight");
+        return;
+    }
+
+    row.type1 = pokemon_type_from_string(fields[4]);
+    if (row.type1 == INVALID_TYPE || row.type1 == NONE_TYPE) {
+        add_invalid(chunk, line, row.pokemon_id, "invalid type1");
+        return;
+    }
+    row.type2 = NONE_TYPE;
+    if (num_fields == MAX_FIELDS && fields[5][0] != '\0') {
+        row.type2 = pokemon_type_from_string(fields[5]);
+    }
+    if (row.type2 == INVALID_TYPE || row.type2 == row.type1) {
+        add_invalid(chunk, line, row.pokemon_id, "invalid type2");
+        return;
+    }
+
+    add_row(chunk, row, fields[1]);
+}
+
+// Split a line into '\0'-terminated fields with the space around them
+// removed, and return how many there are (more than MAX_FIELDS
+// are counted but not kept), or -1 if its quotes are unbalanced.
+// In a CSV a field in double quotes may hold commas, and "" inside
+// the quotes stands for one double quote.
+static int split_line(char *start, char delimiter, char **fields) {
+    int num_fields = 0;
+    char *p = start;
+
+    while (TURE) {
+        while (*p == ' ' || (*p == '\t' && delimiter != '\t')) {
+            p++;
+        }
+
+        char *field = p;
+        char *field_end;
+        if (*p == '"' && delimiter == ',') {
+            // Unquote the field in place.
+            p++;
+            field = p;
+            field_end = p;
+            while (TURE) {
+                if (*p == '\0') {
+                    return -1;
+                } else if (*p == '"' && p[1] == '"') {
+                    *field_end++ = '"';
+                    p += 2;
+                } else if (*p == '"') {
+                    p++;
+                    break;
+                } else {
+                    *field_end++ = *p++;
+                }
+            }
+            while (*p == ' ' || *p == '\t') {
+                p++;
+            }
+            if (*p != delimiter && *p != '\0') {
+                return -1;
+            }
+        } else {
+            while (*p != delimiter && *p != '\0') {
+                p++;
+            }
+            field_end = p;
+            while (field_end > field
+                    && (field_end[-1] == ' ' || field_end[-1] == '\t')) {
+                field_end--;
+            }
+        }
+
+        int last = *p == '\0';
+        *field_end = '\0';
+        if (num_fields < MAX_FIELDS) {
+            fields[num_fields] = field;
+        }
+        num_fields++;
+
+        if (last) {
+            return num_fields;
+        }
+        p++;
+    }
+}
+
+// Read a field as a decimal, as sscanf's %lf would.
+// Plain decimals are read by hand; anything else goes to strtod.
+static int read_decimal(char *field, double *value) {
+    int length = strlen(field);
+    if (read_plain_decimal(field, length, value)) {
+        return TURE;
+    }
+
+    char *end;
+    *value = strtod(field, &end);
+    return length > 0 && end == field + length;
+}
+
+// Count an invalid line of chunk,
+// keeping the first IMPORT_EXAMPLES of them.
+static void add_invalid(struct chunk *chunk, int line, int pokemon_id,
+    const char *reason) {
+
+    if (chunk->num_examples < IMPORT_EXAMPLES) {
+        struct import_problem *problem = &chunk->examples[chunk->num_examples];
+        problem->line = line;
+        problem->pokemon_id = pokemon_id;
+        problem->reason = reason;
+        chunk->num_examples++;
+    }
+    chunk->invalid++;
+}
+
+// Add a checked row, and a copy of its name, to chunk.
+static void add_row(struct chunk *chunk, struct parsed_row row,
+    const char *name) {
+
+    if (chunk->num_rows == chunk->rows_capacity) {
+        chunk->rows_capacity = chunk->rows_capacity == 0
+            ? 1024 : chunk->rows_capacity * 2;
+        chunk->rows = realloc(chunk->rows,
+            chunk->rows_capacity * sizeof(struct parsed_row));
+        assert(chunk->rows != NULL);
+    }
+
+    size_t length = strlen(name) + 1;
+    while (chunk->names_size + length > chunk->names_capacity) {
+        chunk->names_capacity = chunk->names_capacity == 0
+            ? 16384 : chunk->names_capacity * 2;
+        chunk->names = realloc(chunk->names, chunk->names_capacity);
+        assert(chunk->names != NULL);
+    }
+    memcpy(&chunk->names[chunk->names_size], name, length);
+    row.name = chunk->names_size;
+    chunk->names_size += length;
+
+    chunk->rows[chunk->num_rows] = row;
+    chunk->num_rows++;
+}
+
+// Return the delimiter of a file from its first line:
+// a tab if it has one, or else a comma.
+static char find_delimiter(const char *text, size_t size) {
+    size_t i = 0;
+    while (i < size && text[i] != '\n') {
+        if (text[i] == '\t') {
+            return '\t';
+        }
+        i++;
+    }
+    return ',';
+}
+
+// Determine if the first line of a file is a header:
+// one that does not start with a number.
+static int is_header(const char *line) {
+    while (*line == ' ' || *line == '\t' || *line == '"') {
+        line++;
+    }
+    if (*line == '+' || *line == '-') {
+        line++;
+    }
+    return *line != '\0' && (*line < '0' || *line > '9');
+}
+
+// Compare two rows by pokemon_id, then line.
+static int compare_rows(const void *a, const void *b) {
+    const struct parsed_row *row_a = a;
+    const struct parsed_row *row_b = b;
+    if (row_a->pokemon_id != row_b->pokemon_id) {
+        return row_a->pokemon_id < row_b->pokemon_id ? -1 : 1;
+    }
+    return row_a->line - row_b->line;
+}
+
+// Determine if the next row of chunk a comes before that of chunk b.
+// Chunks are in file order, so ties go to the earlier chunk.
+static int row_before(ImportFile file, int a, int b) {
+    struct chunk *chunk_a = file->chunks[a];
+    struct chunk *chunk_b = file->chunks[b];
+    int id_a = chunk_a->rows[chunk_a->position].pokemon_id;
+    int id_b = chunk_b->rows[chunk_b->position].pokemon_id;
+    return id_a < id_b || (id_a == id_b && a < b);
+}
+
+// Restore the heap from position i down.
+static void sift_down(ImportFile file, int i) {
+    while (TURE) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < file->heap_size
+                && row_before(file, file->heap[left], file->heap[smallest])) {
+            smallest = left;
+        }
+        if (right < file->heap_size
+                && row_before(file, file->heap[right], file->heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+
+        int swap = file->heap[i];
+        file->heap[i] = file->heap[smallest];
+        file->heap[smallest] = swap;
+        i = smallest;
+    }
+}
+
+// Free every chunk, the heap and file.
+static void free_import_file(ImportFile file) {
+    int i = 0;
+    while (i < file->num_chunks) {
+        free(file->chunks[i]->text);
+        free(file->chunks[i]->rows);
+        free(file->chunks[i]->names);
+        free(file->chunks[i]);
+        i++;
+    }
+    free(file->chunks);
+    free(file->heap);
+    pthread_mutex_destroy(&file->lock);
+    pthread_cond_destroy(&file->work_ready);
+    pthread_cond_destroy(&file->work_done);
+    free(file);
+}
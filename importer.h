@@ -0,0 +1,79 @@
+// importer.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _IMPORTER_H_
+#define _IMPORTER_H_
+
+#include "pokemon.h"
+
+// An import file has one Pokemon per line:
+//   pokemon_id,name,height,weight,type1[,type2]
+// with commas (CSV) or, if the first line has a tab, tabs (TSV)
+// between the fields. Space around a field is ignored, and in a CSV
+// a field may be in double quotes. A first line that does not start
+// with a number is a header, and is skipped, as are blank lines.
+// Rows are checked as new_pokemon and do_add check them.
+
+// How many of the problems of each kind a report keeps.
+#define IMPORT_EXAMPLES 5
+
+// A row of an import file that was not added, and why.
+struct import_problem {
+    int        line;
+    int        pokemon_id;
+    const char *reason;
+};
+
+// What happened to the rows of an import file.
+// Every problem is counted, but only the first IMPORT_EXAMPLES
+// of each kind (in file order for invalid rows, and in id order
+// for duplicates) are kept.
+struct import_report {
+    int                   rows;
+    int                   added;
+    int                   invalid;
+    int                   duplicates;
+    int                   num_invalid_examples;
+    struct import_problem invalid_examples[IMPORT_EXAMPLES];
+    int                   num_duplicate_examples;
+    struct import_problem duplicate_examples[IMPORT_EXAMPLES];
+};
+
+// A valid row of an import file.
+// name belongs to the ImportFile it came from.
+struct import_row {
+    int          pokemon_id;
+    int          line;
+    char         *name;
+    double       height;
+    double       weight;
+    pokemon_type type1;
+    pokemon_type type2;
+};
+
+// The checked rows of an import file, ready to be merged in id order.
+typedef struct import_file *ImportFile;
+
+// Read and check every row of the file at `path`, in chunks parsed by
+// `threads` threads, filling in rows and the invalid rows of report.
+// Returns NULL, after printing why, if the file cannot be read.
+ImportFile read_import_file(const char *path, int threads,
+    struct import_report *report);
+
+// Take the next valid row, in order of pokemon_id,
+// and of line for rows with the same pokemon_id.
+// Returns 0 when there are no more rows.
+int next_import_row(ImportFile file, struct import_row *row);
+
+// Count row in report as a duplicate of a pokemon_id already added.
+void import_report_duplicate(struct import_report *report,
+    struct import_row *row);
+
+// Free an ImportFile and the names of its rows.
+void close_import_file(ImportFile file);
+
+#endif // _IMPORTER_H_
@@ -0,0 +1,616 @@
+// journal.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+#include <libgen.h>
+#include <sys/stat.h>
+
+#include "journal.h"
+#include "stats.h"
+
+#define JOURNAL_MAGIC "PKDXJRNL"
+#define ADD_HEAD_SIZE 23
+#define INITIAL_CAPACITY 65536
+
+// Records written since the last commit are kept in pending, after
+// room for their frame, so a group is written with a single write.
+// lock guards pending and closing; file_lock is held while a group is
+// written and synced, and while the file is replaced, so groups reach
+// the file in the order they were taken from pending.
+// failed is set, under file_lock, once a group could not be committed;
+// nothing more is written to the journal after that.
+//
+// The records read back by next_journal_record are in contents,
+// which is freed once they have all been read.
+struct journal {
+    char            *path;
+    int             fd;
+    uint32_t        generation;
+    int             commit_interval;
+
+    char            *contents;
+    uint64_t        read_offset;
+    uint64_t        read_end;
+    uint64_t        frame_left;
+
+    pthread_mutex_t lock;
+    pthread_mutex_t file_lock;
+    pthread_cond_t  wake;
+    char            *pending;
+    uint64_t        pending_size;
+    uint64_t        pending_capacity;
+    uint32_t        pending_records;
+    char            *spare;
+    uint64_t        spare_capacity;
+    int             closing;
+    int             failed;
+    int             has_committer;
+    pthread_t       committer;
+
+    struct journal  *next_open;
+};
+
+// Every open journal, so what is pending can be committed at exit.
+static pthread_mutex_t open_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct journal *open_journals = NULL;
+static int exit_registered = 0;
+// Set once exit has begun committing the open journals.
+static int exiting = 0;
+
+// Read the whole journal file into contents, check its header, and
+// find the end of its last whole frame. Returns why it cannot be
+// used, or NULL.
+static char *read_contents(Journal journal, uint64_t size);
+
+// Write the header of an empty journal for `generation` to fd, and
+// sync it. Returns 1, or 0 if it could not be written.
+static int write_header(int fd, uint32_t generation);
+
+// Read the record at data, of at most size bytes, into record.
+// Returns its size, or 0 if it is not a whole record.
+static uint64_t parse_record(const char *data, uint64_t size,
+    struct journal_record *record);
+
+// Add a record, made of head and then tail, to pending.
+static void append_record(Journal journal, const void *head,
+    uint64_t head_size, const void *tail, uint64_t tail_size);
+
+// Take the pending records, then write them as one frame and sync
+// the file.
+static void commit_pending(Journal journal);
+
+// Wait for records, give more of them an interval to arrive, and
+// commit them together, until the journal is closed.
+static void *run_committer(void *arg);
+
+// Commit what is pending in every open journal.
+static void commit_open_journals(void);
+
+// Write size bytes to fd. Returns 1, or 0 if they could not all be
+// written.
+static int write_all(int fd, const void *data, uint64_t size);
+
+// Sync the directory holding path, so a file renamed into it stays.
+static void sync_directory(const char *path);
+
+// Return a 64-bit FNV-1a checksum of data.
+static uint64_t checksum(const void *data, uint64_t size);
+
+// Opens the journal at `path`, and returns a pointer to it.
+Journal open_journal(const char *path, int commit_interval) {
+    if (strlen(path) + 16 > JOURNAL_PATH_MAX) {
+        fprintf(stderr, "%s: journal path is too long\n", path);
+        return NULL;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0666);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return NULL;
+    }
+
+    Journal journal = calloc(1, sizeof(struct journal));
+    assert(journal != NULL);
+    STATS_ALLOC(sizeof(struct journal));
+    journal->path = strdup(path);
+    assert(journal->path != NULL);
+    journal->fd = fd;
+    journal->commit_interval = commit_interval;
+
+    char *problem = NULL;
+    if (info.st_size == 0) {
+        if (!write_header(fd, 0)) {
+            problem = strerror(errno);
+        }
+        sync_directory(path);
+    } else {
+        problem = read_contents(journal, info.st_size);
+    }
+    if (problem == NULL && journal->read_end < (uint64_t) info.st_size
+            && ftruncate(fd, journal->read_end) < 0) {
+        problem = strerror(errno);
+    }
+    if (problem != NULL) {
+        fprintf(stderr, "%s: %s\n", path, problem);
+        free(journal->contents);
+        free(journal->path);
+        free(journal);
+        close(fd);
+        return NULL;
+    }
+
+    journal->pending_capacity = INITIAL_CAPACITY;
+    journal->pending = malloc(journal->pending_capacity);
+    assert(journal->pending != NULL);
+    STATS_ALLOC(journal->pending_capacity);
+    journal->pending_size = sizeof(struct journal_frame);
+    journal->spare_capacity = INITIAL_CAPACITY;
+    journal->spare = malloc(journal->spare_capacity);
+    assert(journal->spare != NULL);
+    STATS_ALLOC(journal->spare_capacity);
+
+    pthread_mutex_init(&journal->lock, NULL);
+    pthread_mutex_init(&journal->file_lock, NULL);
+    pthread_cond_init(&journal->wake, NULL);
+    if (commit_interval > 0) {
+        if (pthread_create(&journal->committer, NULL, run_committer,
+                journal) != 0) {
+            fprintf(stderr, "Could not start a journal thread\n");
+            exit(1);
+        }
+        journal->has_committer = 1;
+    }
+
+    pthread_mutex_lock(&open_lock);
+    journal->next_open = open_journals;
+    open_journals = journal;
+    if (!exit_registered) {
+        atexit(commit_open_journals);
+        exit_registered = 1;
+    }
+    pthread_mutex_unlock(&open_lock);
+
+    return journal;
+}
+
+// Commit every record written so far, stop the committer, and free
+// the journal.
+void close_journal(Journal journal) {
+    pthread_mutex_lock(&open_lock);
+    struct journal **link = &open_journals;
+    while (*link != journal) {
+        link = &(*link)->next_open;
+    }
+    *link = journal->next_open;
+    pthread_mutex_unlock(&open_lock);
+
+    if (journal->has_committer) {
+        pthread_mutex_lock(&journal->lock);
+        journal->closing = 1;
+        pthread_cond_signal(&journal->wake);
+        pthread_mutex_unlock(&journal->lock);
+        pthread_join(journal->committer, NULL);
+    }
+    commit_pending(journal);
+
+    close(journal->fd);
+    pthread_mutex_destroy(&journal->lock);
+    pthread_mutex_destroy(&journal->file_lock);
+    pthread_cond_destroy(&journal->wake);
+    free(journal->contents);
+    free(journal->pending);
+    free(journal->spare);
+    free(journal->path);
+    free(journal);
+}
+
+uint32_t journal_generation(Journal journal) {
+    return journal->generation;
+}
+
+void journal_snapshot_path(Journal journal, uint32_t generation,
+    char path[JOURNAL_PATH_MAX]) {
+    snprintf(path, JOURNAL_PATH_MAX, "%s.%u.snap", journal->path,
+        generation);
+}
+
+// Read the next record of contents, past the frames around it.
+int next_journal_record(Journal journal, struct journal_record *record) {
+    while (journal->frame_left == 0) {
+        if (journal->read_offset >= journal->read_end) {
+            free(journal->contents);
+            journal->contents = NULL;
+            return 0;
+        }
+        struct journal_frame frame;
+        memcpy(&frame, journal->contents + journal->read_offset,
+            sizeof(frame));
+        journal->read_offset += sizeof(frame);
+        journal->frame_left = frame.size;
+    }
+
+    // Every frame was checked when the journal was opened.
+    uint64_t size = parse_record(journal->contents + journal->read_offset,
+        journal->frame_left, record);
+    journal->read_offset += size;
+    journal->frame_left -= size;
+    return 1;
+}
+
+void journal_add(Journal journal, int pokemon_id, const char *name,
+    double height, double weight, int type1, int type2) {
+    char head[ADD_HEAD_SIZE];
+    int32_t id = pokemon_id;
+    head[0] = JOURNAL_ADD;
+    memcpy(&head[1], &id, sizeof(id));
+    head[5] = type1;
+    head[6] = type2;
+    memcpy(&head[7], &height, sizeof(height));
+    memcpy(&head[15], &weight, sizeof(weight));
+    append_record(journal, head, sizeof(head), name, strlen(name) + 1);
+}
+
+void journal_remove(Journal journal, int pokemon_id) {
+    char record[5];
+    int32_t id = pokemon_id;
+    record[0] = JOURNAL_REMOVE;
+    memcpy(&record[1], &id, sizeof(id));
+    append_record(journal, record, sizeof(record), NULL, 0);
+}
+
+void journal_find(Journal journal, int pokemon_id) {
+    char record[5];
+    int32_t id = pokemon_id;
+    record[0] = JOURNAL_FIND;
+    memcpy(&record[1], &id, sizeof(id));
+    append_record(journal, record, sizeof(record), NULL, 0);
+}
+
+void journal_evolve(Journal journal, int from_id, int to_id) {
+    char record[9];
+    int32_t ids[2] = {from_id, to_id};
+    record[0] = JOURNAL_EVOLVE;
+    memcpy(&record[1], ids, sizeof(ids));
+    append_record(journal, record, sizeof(record), NULL, 0);
+}
+
+void journal_commit(Journal journal) {
+    commit_pending(journal);
+}
+
+// Write the next generation's empty journal next to the journal,
+// rename it over the journal, then drop what is pending and remove
+// the snapshot of the previous generation, which nothing needs now.
+int journal_restart(Journal journal) {
+    pthread_mutex_lock(&journal->file_lock);
+
+    char temp_path[JOURNAL_PATH_MAX];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", journal->path);
+    int fd = open(temp_path, O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0666);
+    int ok = fd >= 0 && write_header(fd, journal->generation + 1)
+        && rename(temp_path, journal->path) == 0;
+    if (!ok) {
+        fprintf(stderr, "%s: %s\n", journal->path, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+            unlink(temp_path);
+        }
+        pthread_mutex_unlock(&journal->file_lock);
+        return 0;
+    }
+    sync_directory(journal->path);
+
+    pthread_mutex_lock(&journal->lock);
+    close(journal->fd);
+    journal->fd = fd;
+    journal->pending_size = sizeof(struct journal_frame);
+    journal->pending_records = 0;
+    journal->generation++;
+    pthread_mutex_unlock(&journal->lock);
+
+    if (journal->generation > 1) {
+        char old_path[JOURNAL_PATH_MAX];
+        journal_snapshot_path(journal, journal->generation - 1, old_path);
+        unlink(old_path);
+    }
+
+    pthread_mutex_unlock(&journal->file_lock);
+    return 1;
+}
+
+// Read the whole journal file into contents, and check each frame.
+static char *read_contents(Journal journal, uint64_t size) {
+    journal->contents = malloc(size);
+    assert(journal->contents != NULL);
+    STATS_ALLOC(size);
+
+    uint64_t done = 0;
+    while (done < size) {
+        ssize_t got = pread(journal->fd, journal->contents + done,
+            size - done, done);
+        if (got <= 0) {
+            return got < 0 ? strerror(errno) : "journal is truncated";
+        }
+        done += got;
+    }
+
+    struct journal_header header;
+    if (size < sizeof(header)) {
+        return "not a Pokedex journal";
+    }
+    memcpy(&header, journal->contents, sizeof(header));
+    if (memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0) {
+        return "not a Pokedex journal";
+    } else if (header.version != JOURNAL_VERSION) {
+        return "unsupported journal version";
+    }
+    journal->generation = header.generation;
+
+    uint64_t offset = sizeof(header);
+    journal->read_offset = offset;
+    journal->read_end = offset;
+    while (offset + sizeof(struct journal_frame) <= size) {
+        struct journal_frame frame;
+        memcpy(&frame, journal->contents + offset, sizeof(frame));
+        offset += sizeof(frame);
+        if (frame.size > size - offset
+                || checksum(journal->contents + offset, frame.size)
+                    != frame.checksum) {
+            return NULL;
+        }
+
+        uint64_t end = offset + frame.size;
+        uint32_t records = 0;
+        struct journal_record record;
+        while (offset < end) {
+            uint64_t record_size = parse_record(journal->contents + offset,
+                end - offset, &record);
+            if (record_size == 0) {
+                return NULL;
+            }
+            offset += record_size;
+            records++;
+        }
+        if (records != frame.records) {
+            return NULL;
+        }
+        journal->read_end = end;
+    }
+
+    return NULL;
+}
+
+static int write_header(int fd, uint32_t generation) {
+    struct journal_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    header.generation = generation;
+    return write_all(fd, &header, sizeof(header)) && fdatasync(fd) == 0;
+}
+
+static uint64_t parse_record(const char *data, uint64_t size,
+    struct journal_record *record) {
+
+    int32_t ids[2];
+    record->kind = data[0];
+    if (record->kind == JOURNAL_ADD) {
+        if (size < ADD_HEAD_SIZE + 1) {
+            return 0;
+        }
+        const char *end = memchr(&data[ADD_HEAD_SIZE], '\0',
+            size - ADD_HEAD_SIZE);
+        if (end == NULL) {
+            return 0;
+        }
+        memcpy(ids, &data[1], sizeof(int32_t));
+        record->pokemon_id = ids[0];
+        record->type1 = (unsigned char) data[5];
+        record->type2 = (unsigned char) data[6];
+        memcpy(&record->height, &data[7], sizeof(double));
+        memcpy(&record->weight, &data[15], sizeof(double));
+        record->name = (char *) &data[ADD_HEAD_SIZE];
+        return end + 1 - data;
+    } else if (record->kind == JOURNAL_REMOVE
+            || record->kind == JOURNAL_FIND) {
+        if (size < 5) {
+            return 0;
+        }
+        memcpy(ids, &data[1], sizeof(int32_t));
+        record->pokemon_id = ids[0];
+        return 5;
+    } else if (record->kind == JOURNAL_EVOLVE) {
+        if (size < 9) {
+            return 0;
+        }
+        memcpy(ids, &data[1], sizeof(ids));
+        record->pokemon_id = ids[0];
+        record->to_id = ids[1];
+        return 9;
+    }
+    return 0;
+}
+
+// Copy the record into pending, and wake the committer if it was
+// waiting for one. With no committer, commit it straight away.
+static void append_record(Journal journal, const void *head,
+    uint64_t head_size, const void *tail, uint64_t tail_size) {
+
+    assert(journal->contents == NULL);
+    pthread_mutex_lock(&journal->lock);
+    uint64_t size = journal->pending_size + head_size + tail_size;
+    if (size > journal->pending_capacity) {
+        while (size > journal->pending_capacity) {
+            journal->pending_capacity *= 2;
+        }
+        journal->pending = realloc(journal->pending,
+            journal->pending_capacity);
+        assert(journal->pending != NULL);
+        STATS_ALLOC(journal->pending_capacity);
+    }
+
+    int was_empty = journal->pending_records == 0;
+    memcpy(journal->pending + journal->pending_size, head, head_size);
+    if (tail_size > 0) {
+        memcpy(journal->pending + journal->pending_size + head_size,
+            tail, tail_size);
+    }
+    journal->pending_size = size;
+    journal->pending_records++;
+    if (was_empty && journal->has_committer) {
+        pthread_cond_signal(&journal->wake);
+    }
+    pthread_mutex_unlock(&journal->lock);
+
+    if (!journal->has_committer) {
+        commit_pending(journal);
+    }
+}
+
+// Swap pending with the spare buffer while holding the file, so new
+// records can be written while this group is synced.
+// If the group cannot be committed the process exits, after letting
+// go of the file and marking the journal failed, as exit commits every
+// open journal again; if this is that commit, exit has already begun,
+// so the process ends straight away.
+static void commit_pending(Journal journal) {
+    pthread_mutex_lock(&journal->file_lock);
+    if (journal->failed) {
+        pthread_mutex_unlock(&journal->file_lock);
+        return;
+    }
+
+    pthread_mutex_lock(&journal->lock);
+    char *group = journal->pending;
+    uint64_t group_capacity = journal->pending_capacity;
+    uint64_t size = journal->pending_size;
+    uint32_t records = journal->pending_records;
+    journal->pending = journal->spare;
+    journal->pending_capacity = journal->spare_capacity;
+    journal->pending_size = sizeof(struct journal_frame);
+    journal->pending_records = 0;
+    journal->spare = group;
+    journal->spare_capacity = group_capacity;
+    pthread_mutex_unlock(&journal->lock);
+
+    if (records > 0) {
+        struct journal_frame frame;
+        frame.size = size - sizeof(frame);
+        frame.records = records;
+        frame.checksum = checksum(group + sizeof(frame), frame.size);
+        memcpy(group, &frame, sizeof(frame));
+        if (!write_all(journal->fd, group, size)
+                || fdatasync(journal->fd) != 0) {
+            fprintf(stderr, "%s: %s\n", journal->path, strerror(errno));
+            journal->failed = 1;
+            pthread_mutex_unlock(&journal->file_lock);
+            if (__atomic_load_n(&exiting, __ATOMIC_ACQUIRE)) {
+                fflush(NULL);
+                _exit(1);
+            }
+            exit(1);
+        }
+    }
+
+    pthread_mutex_unlock(&journal->file_lock);
+}
+
+static void *run_committer(void *arg) {
+    Journal journal = arg;
+
+    pthread_mutex_lock(&journal->lock);
+    while (!journal->closing) {
+        while (journal->pending_records == 0 && !journal->closing) {
+            pthread_cond_wait(&journal->wake, &journal->lock);
+        }
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += journal->commit_interval % 1000 * 1000000L;
+        deadline.tv_sec += journal->commit_interval / 1000
+            + deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        int waited = 0;
+        while (!journal->closing && waited != ETIMEDOUT) {
+            waited = pthread_cond_timedwait(&journal->wake, &journal->lock,
+                &deadline);
+        }
+
+        pthread_mutex_unlock(&journal->lock);
+        commit_pending(journal);
+        pthread_mutex_lock(&journal->lock);
+    }
+    pthread_mutex_unlock(&journal->lock);
+    return NULL;
+}
+
+static void commit_open_journals(void) {
+    __atomic_store_n(&exiting, 1, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&open_lock);
+    struct journal *journal = open_journals;
+    while (journal != NULL) {
+        commit_pending(journal);
+        journal = journal->next_open;
+    }
+    pthread_mutex_unlock(&open_lock);
+}
+
+static int write_all(int fd, const void *data, uint64_t size) {
+    const char *bytes = data;
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0 && errno != EINTR) {
+            return 0;
+        }
+        if (written > 0) {
+            bytes += written;
+            size -= written;
+        }
+    }
+    return 1;
+}
+
+static void sync_directory(const char *path) {
+    char copy[JOURNAL_PATH_MAX];
+    snprintf(copy, sizeof(copy), "%s", path);
+    int fd = open(dirname(copy), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+// Return a 64-bit FNV-1a checksum of data, taken 8 bytes at a time
+// like the checksum of a snapshot.
+static uint64_t checksum(const void *data, uint64_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char *bytes = data;
+    uint64_t i = 0;
+    while (i + 8 <= size) {
+        uint64_t word;
+        memcpy(&word, &bytes[i], sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+        i += 8;
+    }
+    while (i < size) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+        i++;
+    }
+    return hash;
+}
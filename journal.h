@@ -0,0 +1,116 @@
+// journal.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _JOURNAL_H_
+#define _JOURNAL_H_
+
+#include <stdint.h>
+
+// A journal file records the changes made to a Pokedex since its
+// last checkpoint, in native byte order:
+//
+//   header      struct journal_header
+//   frames      each a struct journal_frame, then `size` bytes of
+//               records, written and synced together
+//
+// generation is the number of checkpoints made so far; the Pokedex
+// the journal starts from is the snapshot journal_snapshot_path
+// gives for it, or an empty Pokedex for generation 0.
+// The checksum of a frame covers its records. A frame that is cut
+// short or does not match its checksum (because writing it was
+// interrupted) ends the journal, and is cut off when it is opened.
+//
+// Each record is a JOURNAL_ kind byte, then:
+//   JOURNAL_ADD     int32 id, uint8 type1, uint8 type2,
+//                   double height, double weight, '\0'-terminated name
+//   JOURNAL_REMOVE  int32 id
+//   JOURNAL_FIND    int32 id
+//   JOURNAL_EVOLVE  int32 from id, int32 to id
+// with no padding.
+
+#define JOURNAL_VERSION 1
+#define JOURNAL_PATH_MAX 4096
+
+// Records are committed at most this many milliseconds after they
+// are written, unless the journal is opened with another interval.
+#define DEFAULT_COMMIT_INTERVAL 10
+
+#define JOURNAL_ADD    1
+#define JOURNAL_REMOVE 2
+#define JOURNAL_FIND   3
+#define JOURNAL_EVOLVE 4
+
+struct journal_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t generation;
+};
+
+struct journal_frame {
+    uint32_t size;
+    uint32_t records;
+    uint64_t checksum;
+};
+
+// A record read back from a journal. name points into the journal,
+// and is only valid until the next record is read.
+struct journal_record {
+    int    kind;
+    int    pokemon_id;
+    int    to_id;
+    int    type1;
+    int    type2;
+    double height;
+    double weight;
+    char   *name;
+};
+
+typedef struct journal *Journal;
+
+// Open the journal at `path`, creating an empty one if there is none,
+// and cut off anything after its last whole frame.
+// Records are committed (written and synced) in groups, at most
+// `commit_interval` milliseconds after they are written, by a thread
+// of the journal; with an interval of 0, every record is committed
+// before it is returned from.
+// Returns NULL, after printing why, if it cannot be used.
+Journal open_journal(const char *path, int commit_interval);
+
+// Commit every record written so far, and close the journal.
+void close_journal(Journal journal);
+
+// Return the number of checkpoints made so far.
+uint32_t journal_generation(Journal journal);
+
+// Write the path of the snapshot for `generation` into path.
+void journal_snapshot_path(Journal journal, uint32_t generation,
+    char path[JOURNAL_PATH_MAX]);
+
+// Read the next record that was in the journal when it was opened.
+// Returns 1, or 0 once there are none left.
+// Every record must be read before any is written.
+int next_journal_record(Journal journal, struct journal_record *record);
+
+// Write a record to the journal. It is committed later,
+// as described for open_journal.
+void journal_add(Journal journal, int pokemon_id, const char *name,
+    double height, double weight, int type1, int type2);
+void journal_remove(Journal journal, int pokemon_id);
+void journal_find(Journal journal, int pokemon_id);
+void journal_evolve(Journal journal, int from_id, int to_id);
+
+// Commit every record written so far, and wait until it is synced.
+void journal_commit(Journal journal);
+
+// Replace the journal with an empty one for the next generation,
+// dropping the records written so far, once the snapshot for that
+// generation has been saved.
+// Returns 1, or prints why and returns 0, leaving the journal as it
+// was.
+int journal_restart(Journal journal);
+
+#endif // _JOURNAL_H_
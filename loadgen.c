@@ -0,0 +1,545 @@
+// loadgen.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+//
+// Load generator for the Pokedex server (pokedex -s socket).
+// Usage: ./loadgen [-c connections] [-d ms] [-p depth] [-n entries]
+//                  [-s seed] socket
+//
+// Adds `entries` Pokemon to the server, then for each number of
+// connections keeps `depth` commands in flight on every connection for
+// `ms` milliseconds, and prints the requests per second and the
+// median, 99th percentile and worst latency of a command.
+// The connections are driven by one thread with epoll.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <assert.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "pokemon.h"
+#include "server.h"
+
+#define MAX_COUNTS 8
+#define MAX_DEPTH 64
+#define MAX_NAME 16
+#define MAX_REQUEST 64
+#define MAX_EVENTS 256
+#define READ_SIZE 65536
+#define PRELOAD_BATCH 1000
+#define MIN_LATENCIES 65536
+
+struct config {
+    int          num_counts;
+    int          counts[MAX_COUNTS];
+    int          duration_ms;
+    int          depth;
+    int          entries;
+    unsigned int seed;
+    char         *path;
+};
+
+// A connection to the server, with the send times of the commands in
+// flight on it, oldest first from `oldest` (the server answers them in
+// order), and the bytes of commands not yet sent.
+struct connection {
+    int          fd;
+    unsigned int seed;
+    long long    sent_ns[MAX_DEPTH];
+    int          oldest;
+    int          in_flight;
+    char         pending[MAX_DEPTH * MAX_REQUEST];
+    int          pending_length;
+    int          watching_output;
+};
+
+// The latency of every command answered in a run, in nanoseconds.
+struct latencies {
+    long long *ns;
+    long      count;
+    long      capacity;
+};
+
+static void parse_arguments(int argc, char *argv[], struct config *config);
+static void usage(char *program);
+static long long now_ns(void);
+static unsigned int next_random(unsigned int *seed);
+static void random_name(unsigned int *seed, char *name);
+static int connect_to(char *path);
+static void send_all(int fd, char *bytes, int length);
+static void wait_for_outputs(int fd, int count);
+static void preload(struct config *config);
+static void run_load(struct config *config, int num_connections);
+static void send_command(struct connection *connection,
+    struct config *config);
+static int send_pending(struct connection *connection);
+static void read_outputs(struct connection *connection,
+    struct latencies *latencies);
+static void watch_output(int epoll_fd, struct connection *connection);
+static int compare_ns(const void *a, const void *b);
+static void raise_file_limit(void);
+
+int main(int argc, char *argv[]) {
+    struct config config;
+    parse_arguments(argc, argv, &config);
+    raise_file_limit();
+
+    preload(&config);
+    printf("%12s %10s %12s %10s %10s %10s\n", "connections", "requests",
+        "requests/s", "p50 us", "p99 us", "max us");
+    int i = 0;
+    while (i < config.num_counts) {
+        run_load(&config, config.counts[i]);
+        i++;
+    }
+
+    return 0;
+}
+
+static void parse_arguments(int argc, char *argv[], struct config *config) {
+    config->num_counts = 4;
+    config->counts[0] = 1;
+    config->counts[1] = 10;
+    config->counts[2] = 100;
+    config->counts[3] = 1000;
+    config->duration_ms = 2000;
+    config->depth = 1;
+    config->entries = 10000;
+    config->seed = 1;
+    config->path = NULL;
+
+    int i = 1;
+    while (i < argc) {
+        if (argv[i][0] != '-' && i == argc - 1) {
+            config->path = argv[i];
+            i++;
+            continue;
+        }
+        if (i + 1 >= argc || argv[i][0] != '-' || strlen(argv[i]) != 2) {
+            usage(argv[0]);
+        }
+        char *value = argv[i + 1];
+        char option = argv[i][1];
+        if (option == 'c') {
+            // A comma-separated list of numbers of connections.
+            config->num_counts = 0;
+            char *end = value;
+            while (*end != '\0' && config->num_counts < MAX_COUNTS) {
+                int count = (int) strtol(end, &end, 10);
+                if (count <= 0 || (*end != ',' && *end != '\0')) {
+                    usage(argv[0]);
+                }
+                config->counts[config->num_counts] = count;
+                config->num_counts++;
+                if (*end == ',') {
+                    end++;
+                }
+            }
+        } else if (option == 'd') {
+            config->duration_ms = atoi(value);
+            if (config->duration_ms <= 0) {
+                usage(argv[0]);
+            }
+        } else if (option == 'p') {
+            config->depth = atoi(value);
+            if (config->depth < 1 || config->depth > MAX_DEPTH) {
+                usage(argv[0]);
+            }
+        } else if (option == 'n') {
+            config->entries = atoi(value);
+            if (config->entries < 1) {
+                usage(argv[0]);
+            }
+        } else if (option == 's') {
+            config->seed = (unsigned int) strtoul(value, NULL, 10);
+        } else {
+            usage(argv[0]);
+        }
+        i += 2;
+    }
+
+    if (config->path == NULL) {
+        usage(argv[0]);
+    }
+}
+
+// Print how to run loadgen, and exit.
+static void usage(char *program) {
+    fprintf(stderr, "Usage: %s [-c connections] [-d ms] [-p depth] "
+        "[-n entries] [-s seed] socket\n", program);
+    fprintf(stderr, "  -c  comma-separated numbers of connections "
+        "(default 1,10,100,1000)\n");
+    fprintf(stderr, "  -d  milliseconds to run each number of connections "
+        "(default 2000)\n");
+    fprintf(stderr, "  -p  commands in flight on each connection, "
+        "1 to %d (default 1)\n", MAX_DEPTH);
+    fprintf(stderr, "  -n  Pokemon to add to the server first "
+        "(default 10000)\n");
+    exit(1);
+}
+
+// Return a monotonic timestamp in nanoseconds.
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Return the next number from the generator in seed.
+static unsigned int next_random(unsigned int *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+// Write a random capitalised name of 6 to 12 letters into name.
+static void random_name(unsigned int *seed, char *name) {
+    int length = 6 + next_random(seed) % 7;
+    int i = 0;
+    while (i < length) {
+        char letter = 'a' + next_random(seed) % 26;
+        if (i == 0) {
+            letter = letter - 'a' + 'A';
+        }
+        name[i] = letter;
+        i++;
+    }
+    name[length] = '\0';
+}
+
+// Connect to the server's socket, or exit if it cannot be reached.
+static int connect_to(char *path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "%s: socket path is too long\n", path);
+        exit(1);
+    }
+    strcpy(address.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *) &address,
+            sizeof(address)) < 0) {
+        perror(path);
+        exit(1);
+    }
+    return fd;
+}
+
+// Send every byte on a blocking socket, or exit.
+static void send_all(int fd, char *bytes, int length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("send");
+            exit(1);
+        }
+        bytes += sent;
+        length -= sent;
+    }
+}
+
+// Read from a blocking socket until `count` outputs have ended.
+static void wait_for_outputs(int fd, int count) {
+    char buffer[READ_SIZE];
+    while (count > 0) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            if (length < 0 && errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "loadgen: the server closed the connection\n");
+            exit(1);
+        }
+        char *end = memchr(buffer, SERVER_END_OF_OUTPUT, length);
+        while (end != NULL) {
+            count--;
+            end = memchr(end + 1, SERVER_END_OF_OUTPUT,
+                &buffer[length] - (end + 1));
+        }
+    }
+}
+
+// Add Pokemon 0 to entries - 1 to the server, finding every other one,
+// PRELOAD_BATCH at a time. A server that already has them says so and
+// carries on.
+static void preload(struct config *config) {
+    int fd = connect_to(config->path);
+    unsigned int seed = config->seed;
+    char name[MAX_NAME];
+    char batch[PRELOAD_BATCH * 2 * MAX_REQUEST];
+
+    int id = 0;
+    while (id < config->entries) {
+        int length = 0;
+        int commands = 0;
+        while (commands < PRELOAD_BATCH && id < config->entries) {
+            random_name(&seed, name);
+            length += snprintf(&batch[length], MAX_REQUEST,
+                "a %d %s %.1f %.1f %s\n", id, name,
+                0.1 * (1 + next_random(&seed) % 100),
+                0.1 * (1 + next_random(&seed) % 1000),
+                pokemon_type_to_string(1 + id % (MAX_TYPE - 1)));
+            commands++;
+            if (id % 2 == 0) {
+                length += snprintf(&batch[length], MAX_REQUEST,
+                    "m %d\nf\n", id);
+                commands += 2;
+            }
+            id++;
+        }
+        send_all(fd, batch, length);
+        wait_for_outputs(fd, commands);
+    }
+
+    send_all(fd, "q\n", 2);
+    wait_for_outputs(fd, 1);
+    close(fd);
+}
+
+// Open num_connections connections, keep `depth` commands in flight
+// on each for duration_ms, then print what the run measured.
+// Commands answered after the end are not counted.
+static void run_load(struct config *config, int num_connections) {
+    struct connection *connections =
+        malloc(num_connections * sizeof(struct connection));
+    assert(connections != NULL);
+    struct latencies latencies;
+    latencies.capacity = MIN_LATENCIES;
+    latencies.count = 0;
+    latencies.ns = malloc(latencies.capacity * sizeof(long long));
+    assert(latencies.ns != NULL);
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        perror("epoll_create1");
+        exit(1);
+    }
+
+    long long start = now_ns();
+    int i = 0;
+    while (i < num_connections) {
+        struct connection *connection = &connections[i];
+        connection->fd = connect_to(config->path);
+        fcntl(connection->fd, F_SETFL,
+            fcntl(connection->fd, F_GETFL) | O_NONBLOCK);
+        connection->seed = config->seed + i;
+        connection->oldest = 0;
+        connection->in_flight = 0;
+        connection->pending_length = 0;
+        connection->watching_output = 0;
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = connection;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, connection->fd, &event);
+
+        while (connection->in_flight < config->depth) {
+            send_command(connection, config);
+        }
+        if (!send_pending(connection)) {
+            exit(1);
+        }
+        watch_output(epoll_fd, connection);
+        i++;
+    }
+
+    long long end = start + config->duration_ms * 1000000LL;
+    struct epoll_event events[MAX_EVENTS];
+    long long now = now_ns();
+    while (now < end) {
+        int timeout_ms = (end - now) / 1000000 + 1;
+        int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+        if (ready < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            exit(1);
+        }
+
+        int e = 0;
+        while (e < ready) {
+            struct connection *connection = events[e].data.ptr;
+            if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                read_outputs(connection, &latencies);
+                while (connection->in_flight < config->depth) {
+                    send_command(connection, config);
+                }
+            }
+            if (!send_pending(connection)) {
+                exit(1);
+            }
+            watch_output(epoll_fd, connection);
+            e++;
+        }
+        now = now_ns();
+    }
+    double seconds = (now - start) / 1e9;
+
+    i = 0;
+    while (i < num_connections) {
+        close(connections[i].fd);
+        i++;
+    }
+    close(epoll_fd);
+
+    qsort(latencies.ns, latencies.count, sizeof(long long), compare_ns);
+    long long p50 = 0;
+    long long p99 = 0;
+    long long worst = 0;
+    if (latencies.count > 0) {
+        p50 = latencies.ns[latencies.count / 2];
+        p99 = latencies.ns[latencies.count * 99 / 100];
+        worst = latencies.ns[latencies.count - 1];
+    }
+    printf("%12d %10ld %12.0f %10.1f %10.1f %10.1f\n", num_connections,
+        latencies.count, latencies.count / seconds, p50 / 1e3, p99 / 1e3,
+        worst / 1e3);
+    fflush(stdout);
+
+    free(latencies.ns);
+    free(connections);
+}
+
+// Queue a random command: mostly moving the cursor and reading the
+// current Pokemon, with counts, short pages and finds.
+static void send_command(struct connection *connection,
+    struct config *config) {
+
+    unsigned int random = next_random(&connection->seed);
+    int kind = random % 16;
+    int value = next_random(&connection->seed) % config->entries;
+    char *to = &connection->pending[connection->pending_length];
+
+    int length = 0;
+    if (kind < 3) {
+        length = snprintf(to, MAX_REQUEST, "g\n");
+    } else if (kind < 5) {
+        length = snprintf(to, MAX_REQUEST, "d\n");
+    } else if (kind < 7) {
+        length = snprintf(to, MAX_REQUEST, ">\n");
+    } else if (kind < 8) {
+        length = snprintf(to, MAX_REQUEST, "<\n");
+    } else if (kind < 10) {
+        length = snprintf(to, MAX_REQUEST, "m %d\n", value);
+    } else if (kind < 11) {
+        length = snprintf(to, MAX_REQUEST, "j %d\n", value);
+    } else if (kind < 12) {
+        length = snprintf(to, MAX_REQUEST, "t\n");
+    } else if (kind < 13) {
+        length = snprintf(to, MAX_REQUEST, "c\n");
+    } else if (kind < 15) {
+        length = snprintf(to, MAX_REQUEST, "p %d 10\n", value);
+    } else {
+        length = snprintf(to, MAX_REQUEST, "f\n");
+    }
+    connection->pending_length += length;
+
+    int slot = (connection->oldest + connection->in_flight) % MAX_DEPTH;
+    connection->sent_ns[slot] = now_ns();
+    connection->in_flight++;
+}
+
+// Returns 0 if the server has gone.
+static int send_pending(struct connection *connection) {
+    int sent_total = 0;
+    while (sent_total < connection->pending_length) {
+        ssize_t sent = send(connection->fd, &connection->pending[sent_total],
+            connection->pending_length - sent_total, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            perror("send");
+            return 0;
+        }
+        sent_total += sent;
+    }
+
+    memmove(connection->pending, &connection->pending[sent_total],
+        connection->pending_length - sent_total);
+    connection->pending_length -= sent_total;
+    return 1;
+}
+
+// Read what the server has sent, and record the latency of each
+// command whose output has ended.
+static void read_outputs(struct connection *connection,
+    struct latencies *latencies) {
+
+    char buffer[READ_SIZE];
+    ssize_t length = read(connection->fd, buffer, sizeof(buffer));
+    if (length == 0) {
+        fprintf(stderr, "loadgen: the server closed the connection\n");
+        exit(1);
+    }
+    if (length < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return;
+        }
+        perror("read");
+        exit(1);
+    }
+
+    long long now = now_ns();
+    char *end = memchr(buffer, SERVER_END_OF_OUTPUT, length);
+    while (end != NULL) {
+        if (latencies->count == latencies->capacity) {
+            latencies->capacity *= 2;
+            latencies->ns = realloc(latencies->ns,
+                latencies->capacity * sizeof(long long));
+            assert(latencies->ns != NULL);
+        }
+        latencies->ns[latencies->count] =
+            now - connection->sent_ns[connection->oldest];
+        latencies->count++;
+        connection->oldest = (connection->oldest + 1) % MAX_DEPTH;
+        connection->in_flight--;
+        end = memchr(end + 1, SERVER_END_OF_OUTPUT,
+            &buffer[length] - (end + 1));
+    }
+}
+
+// Wait for room to send only while commands are left unsent.
+static void watch_output(int epoll_fd, struct connection *connection) {
+    int watching = connection->pending_length > 0;
+    if (watching != connection->watching_output) {
+        struct epoll_event event;
+        event.events = EPOLLIN | (watching ? EPOLLOUT : 0);
+        event.data.ptr = connection;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, connection->fd, &event);
+        connection->watching_output = watching;
+    }
+}
+
+static int compare_ns(const void *a, const void *b) {
+    long long x = *(const long long *) a;
+    long long y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+// Raise the limit on open files as far as it goes, for many
+// connections.
+static void raise_file_limit(void) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0
+            && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
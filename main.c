@@ -11,10 +11,19 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <assert.h>
 
 #include "pokedex.h"
+#include "output.h"
+#include "addcommand.h"
+#include "journal.h"
+#include "server.h"
+#include "stats.h"
 
 #define MAX_LINE    1024
+#define INPUT_BUFFER_SIZE (1 << 20)
 
 #define ADD_COMMAND            'a'
 #define PRINT_COMMAND          'p'
@@ -37,21 +46,57 @@
 #define GET_FOUND_COMMAND      'F'
 #define SEARCH_COMMAND         'S'
 #define GET_TYPE_COMMAND       'T'
+#define SAVE_COMMAND           'w'
+#define LOAD_COMMAND           'l'
+#define IMPORT_COMMAND         'i'
+#define FAMILY_COMMAND         'E'
+#define CHAINS_COMMAND         'C'
+#define STATS_COMMAND          'Z'
+#define JUMP_COMMAND           'j'
+#define CHECKPOINT_COMMAND     'k'
+
+// A Pokedex made by F, S or T for a client (a copy, if it was made
+// from the served Pokedex), and the one it was made in.
+struct view {
+    Pokedex     pokedex;
+    struct view *outer;
+};
+
+// A client of the server: its views, innermost first (its commands go
+// to the innermost, or to the served Pokedex if it has none), and the
+// pokemon_id and position of its currently selected Pokemon in the
+// served Pokedex.
+struct client {
+    struct view *views;
+    int         has_cursor;
+    int         cursor_id;
+    int         cursor_position;
+};
 
 static int run_command(Pokedex pokedex, char *line);
+static int parse_options(int argc, char *argv[]);
 
 void explore_pokedex(Pokedex pokedex);
+static Pokedex open_root_pokedex(void);
+static void explore_view(Pokedex view);
+static int serve_pokedex(void);
+static void *open_client(void *context);
+static int run_client_command(void *session, char *line);
+static void close_client(void *session);
+static void restore_cursor(struct client *client);
+static void save_cursor(struct client *client);
 static void print_welcome_msg(void);
 static void show_help(void);
 static int get_command(char *command, int max_command_length);
 
 static void do_add(Pokedex pokedex, char *line);
-static void do_print(Pokedex pokedex);
+static void do_print(Pokedex pokedex, char *line);
 static void do_get(Pokedex pokedex);
 static void do_details(Pokedex pokedex);
 static void do_next(Pokedex pokedex);
 static void do_prev(Pokedex pokedex);
 static void do_change_curr(Pokedex pokedex, char *line);
+static void do_jump(Pokedex pokedex, char *line);
 static void do_remove(Pokedex pokedex);
 static void do_show_types(Pokedex pokedex);
 static void do_explore(Pokedex pokedex);
@@ -61,34 +106,271 @@ static void do_count_total(Pokedex pokedex);
 static void do_evolution(Pokedex pokedex, char *line);
 static void do_show_evolutions(Pokedex pokedex);
 static void do_next_evolution(Pokedex pokedex) ;
+static void do_show_family(Pokedex pokedex);
+static void do_show_chains(Pokedex pokedex);
 static void do_get_found(Pokedex pokedex);
 static void do_get_type(Pokedex pokedex, char *line);
 static void do_search(Pokedex pokedex, char *line);
+static void do_save(Pokedex pokedex, char *line);
+static void do_load(Pokedex pokedex, char *line);
+static void do_import(Pokedex pokedex, char *line);
+static void do_checkpoint(Pokedex pokedex);
+static void print_import_problems(int count, char *what,
+    struct import_problem *examples, int num_examples);
+static int trim_end(char *line);
 static void do_quit(void);
 
-int main(void) {
+// In batch mode there is no "Enter command: " prompt,
+// and input and output both go through large buffers.
+// Command results are the same in both modes.
+static int batch_mode = 0;
+
+// With a journal, the Pokedex is recovered from it at the start,
+// and every change to it is recorded in it.
+static char *journal_path = NULL;
+static int commit_interval = DEFAULT_COMMIT_INTERVAL;
+
+// In server mode, one Pokedex is served to every client of a Unix
+// domain socket (see server.h), instead of being explored on stdin.
+// Each client has its own cursor in it, and its own views.
+static char *server_path = NULL;
+static Pokedex served_pokedex = NULL;
+
+// The client whose command is being run, or NULL outside server mode.
+static struct client *serving_client = NULL;
+
+int main(int argc, char *argv[]) {
+    if (!parse_options(argc, argv)) {
+        fprintf(stderr, "Usage: %s [-b | -i] [-j journal] [-g interval] "
+            "[-s socket]\n", argv[0]);
+        fprintf(stderr, "  -b  batch mode: no prompts, buffered input\n");
+        fprintf(stderr, "  -i  interactive mode: prompt for every command\n");
+        fprintf(stderr, "  -j  recover from, and record changes in, "
+            "a journal\n");
+        fprintf(stderr, "  -g  commit the journal every interval ms "
+            "(default %d, 0 for every change)\n", DEFAULT_COMMIT_INTERVAL);
+        fprintf(stderr, "  -s  serve the Pokedex on a Unix domain socket\n");
+        return 1;
+    }
+
+    if (server_path != NULL) {
+        return serve_pokedex() ? 0 : 1;
+    }
+
+    if (batch_mode) {
+        setvbuf(stdin, NULL, _IOFBF, INPUT_BUFFER_SIZE);
+    }
+
     explore_pokedex(NULL);
+    out_flush();
     return 0;
 }
 
+// Set batch_mode, journal_path, commit_interval and server_path from
+// the arguments. Returns 1, or 0 if they are invalid.
+// Without -b or -i, batch mode is used when stdin is not a terminal.
+static int parse_options(int argc, char *argv[]) {
+    batch_mode = !isatty(STDIN_FILENO);
+    int modes = 0;
+
+    int i = 1;
+    while (i < argc) {
+        if (strcmp(argv[i], "-b") == 0) {
+            batch_mode = 1;
+            modes++;
+        } else if (strcmp(argv[i], "-i") == 0) {
+            batch_mode = 0;
+            modes++;
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            journal_path = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            char *end;
+            long interval = strtol(argv[i + 1], &end, 10);
+            if (*end != '\0' || end == argv[i + 1] || interval < 0
+                    || interval > INT_MAX) {
+                return 0;
+            }
+            commit_interval = interval;
+            i++;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            server_path = argv[i + 1];
+            i++;
+        } else {
+            return 0;
+        }
+        i++;
+    }
+
+    return modes <= 1;
+}
+
 
 void explore_pokedex(Pokedex supplied_pokedex) {
     Pokedex pokedex = supplied_pokedex;
     if (pokedex == NULL) {
         print_welcome_msg();
-        pokedex = new_pokedex();
+        pokedex = open_root_pokedex();
     } else {
-        printf("Enter '%c' to return to previous pokedex\n", QUIT_COMMAND);
+        out_printf("Enter '%c' to return to previous pokedex\n", QUIT_COMMAND);
+    }
+
+#ifdef POKEDEX_STATS
+    // The command that made this view is not charged for the commands
+    // run on it.
+    if (supplied_pokedex != NULL) {
+        stats_pause();
     }
+#endif
 
     char line[MAX_LINE];
     while (get_command(line, MAX_LINE) && run_command(pokedex, line)) {
     }
 
+#ifdef POKEDEX_STATS
+    if (supplied_pokedex != NULL) {
+        stats_resume();
+    }
+#endif
+
     destroy_pokedex(pokedex);
 
     if (supplied_pokedex != NULL) {
-        printf("Returning to previous pokedex.\n");
+        out_printf("Returning to previous pokedex.\n");
+    }
+}
+
+// Make the Pokedex that is explored or served, recovering it from
+// the journal if there is one.
+static Pokedex open_root_pokedex(void) {
+    Pokedex pokedex = new_pokedex();
+    if (journal_path != NULL) {
+        out_flush();
+        if (!open_pokedex_journal(pokedex, journal_path, commit_interval)) {
+            exit(1);
+        }
+        out_printf("Recovered %d Pokemon from %s\n",
+            count_total_pokemon(pokedex), journal_path);
+    }
+    return pokedex;
+}
+
+// Explore a view made by F, S or T until 'q' returns from it.
+// A client of the server explores it with its next commands instead.
+// A view of the served Pokedex would be left pointing at freed
+// Pokemon when another client changes it, so the client keeps a copy;
+// a view of one of the client's own Pokedexes cannot change under it.
+static void explore_view(Pokedex view) {
+    if (serving_client == NULL) {
+        explore_pokedex(view);
+        return;
+    }
+
+    struct view *inner = malloc(sizeof(struct view));
+    assert(inner != NULL);
+    STATS_ALLOC(sizeof(struct view));
+    inner->pokedex = view;
+    if (serving_client->views == NULL) {
+        inner->pokedex = copy_pokedex(view);
+        destroy_pokedex(view);
+    }
+    inner->outer = serving_client->views;
+    serving_client->views = inner;
+    out_printf("Enter '%c' to return to previous pokedex\n", QUIT_COMMAND);
+}
+
+// Serve the Pokedex until the server is stopped.
+// Returns 1, or 0 if the socket could not be made.
+static int serve_pokedex(void) {
+    served_pokedex = open_root_pokedex();
+    out_printf("Serving the Pokedex on %s\n", server_path);
+    out_flush();
+
+    struct server_handlers handlers;
+    handlers.open = open_client;
+    handlers.command = run_client_command;
+    handlers.close = close_client;
+    handlers.context = NULL;
+    int served = serve(server_path, &handlers);
+
+    destroy_pokedex(served_pokedex);
+    return served;
+}
+
+static void *open_client(void *context) {
+    struct client *client = malloc(sizeof(struct client));
+    assert(client != NULL);
+    STATS_ALLOC(sizeof(struct client));
+    client->views = NULL;
+    client->has_cursor = 0;
+    client->cursor_id = 0;
+    client->cursor_position = 0;
+    return client;
+}
+
+// 'q' returns from the client's innermost view, or closes the
+// connection if it has none, after the same output as on stdin.
+static int run_client_command(void *session, char *line) {
+    struct client *client = session;
+    serving_client = client;
+
+    int keep_open = 1;
+    if (client->views != NULL) {
+        struct view *view = client->views;
+        if (!run_command(view->pokedex, line)) {
+            client->views = view->outer;
+            destroy_pokedex(view->pokedex);
+            free(view);
+            out_printf("Returning to previous pokedex.\n");
+        }
+    } else {
+        restore_cursor(client);
+        keep_open = run_command(served_pokedex, line);
+        save_cursor(client);
+    }
+
+    serving_client = NULL;
+    return keep_open;
+}
+
+static void close_client(void *session) {
+    struct client *client = session;
+    while (client->views != NULL) {
+        struct view *view = client->views;
+        client->views = view->outer;
+        destroy_pokedex(view->pokedex);
+        free(view);
+    }
+    free(client);
+}
+
+// Select the client's Pokemon in the served Pokedex. If another client
+// has removed it, the one now at its position is selected (or the
+// last, if it was last), as if this client had removed it.
+// A new client starts at the first Pokemon.
+static void restore_cursor(struct client *client) {
+    int total = count_total_pokemon(served_pokedex);
+    if (total == 0) {
+        return;
+    }
+
+    if (!client->has_cursor) {
+        change_current_position(served_pokedex, 0);
+    } else if (has_pokemon(served_pokedex, client->cursor_id)) {
+        change_current_pokemon(served_pokedex, client->cursor_id);
+    } else if (client->cursor_position < total) {
+        change_current_position(served_pokedex, client->cursor_position);
+    } else {
+        change_current_position(served_pokedex, total - 1);
+    }
+}
+
+static void save_cursor(struct client *client) {
+    Pokemon current = get_current_pokemon(served_pokedex);
+    client->has_cursor = current != NULL;
+    if (current != NULL) {
+        client->cursor_id = pokemon_id(current);
+        client->cursor_position = get_current_position(served_pokedex);
     }
 }
 
@@ -110,10 +392,14 @@ int run_command(Pokedex pokedex, char *line) {
         }
     }
 
+#ifdef POKEDEX_STATS
+    stats_begin_command(cmd);
+#endif
+
     if (cmd == ADD_COMMAND) {
         do_add(pokedex, &line[next]);
     } else if (cmd == PRINT_COMMAND) {
-        do_print(pokedex);
+        do_print(pokedex, &line[next]);
     } else if (cmd == DETAILS_COMMAND) {
         do_details(pokedex);
     } else if (cmd == GET_COMMAND) {
@@ -124,6 +410,8 @@ int run_command(Pokedex pokedex, char *line) {
         do_prev(pokedex);
     } else if (cmd == CHANGE_CURR_COMMAND) {
         do_change_curr(pokedex, &line[next]);
+    } else if (cmd == JUMP_COMMAND) {
+        do_jump(pokedex, &line[next]);
     } else if (cmd == REMOVE_COMMAND) {
         do_remove(pokedex);
     } else if (cmd == SHOW_TYPES_COMMAND) {
@@ -142,12 +430,28 @@ int run_command(Pokedex pokedex, char *line) {
         do_show_evolutions(pokedex);
     } else if (cmd == NEXT_EVOLUTION_COMMAND) {
         do_next_evolution(pokedex);
+    } else if (cmd == FAMILY_COMMAND) {
+        do_show_family(pokedex);
+    } else if (cmd == CHAINS_COMMAND) {
+        do_show_chains(pokedex);
     } else if (cmd == GET_FOUND_COMMAND) {
         do_get_found(pokedex);
     } else if (cmd == SEARCH_COMMAND) {
         do_search(pokedex, &line[next]);
     } else if (cmd == GET_TYPE_COMMAND) {
         do_get_type(pokedex, &line[next]);
+    } else if (cmd == SAVE_COMMAND) {
+        do_save(pokedex, &line[next]);
+    } else if (cmd == LOAD_COMMAND) {
+        do_load(pokedex, &line[next]);
+    } else if (cmd == IMPORT_COMMAND) {
+        do_import(pokedex, &line[next]);
+    } else if (cmd == CHECKPOINT_COMMAND) {
+        do_checkpoint(pokedex);
+#ifdef POKEDEX_STATS
+    } else if (cmd == STATS_COMMAND) {
+        stats_print();
+#endif
     } else if (cmd == QUIT_COMMAND) {
         do_quit();
     } else if (cmd == HELP_COMMAND) {
@@ -155,15 +459,19 @@ int run_command(Pokedex pokedex, char *line) {
     } else if (cmd == '\0') {
         // Don't do anything, just print the prompt again.
     } else {
-        printf("Unknown Command '%c'\n", cmd);
-        printf("Type '%c' for a list of commands\n", HELP_COMMAND);
+        out_printf("Unknown Command '%c'\n", cmd);
+        out_printf("Type '%c' for a list of commands\n", HELP_COMMAND);
     }
 
+#ifdef POKEDEX_STATS
+    stats_end_command();
+#endif
+
     return cmd != QUIT_COMMAND;
 }
 
 static void print_welcome_msg(void) {
-    printf(
+    out_printf(
         "===========================[ Pokédex ]==========================\n"
         "            Welcome to the Pokédex!  How can I help?\n"
         "================================================================\n"
@@ -171,123 +479,178 @@ static void print_welcome_msg(void) {
 }
 
 static void show_help(void) {
-    printf(""
+    out_printf(""
         "============================[ Help ]============================\n"
     );
 
-    printf(""
+    out_printf(""
         "  %c [pokemon_id] [name] [height] [weight] [type1] [type2]\n"
         "    Add a Pokemon to the Pokedex\n",
         ADD_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Print all of the Pokemon in the Pokedex (in the order they "
         "were added)\n",
         PRINT_COMMAND
     );
-    printf(""
+    out_printf(""
+        "  %c [position] [limit]\n"
+        "    Print at most limit Pokemon from a position (0 is the first)\n",
+        PRINT_COMMAND
+    );
+    out_printf(""
+        "  %c #[pokemon_A] #[pokemon_B]\n"
+        "    Print the Pokemon from Pokemon A to Pokemon B\n",
+        PRINT_COMMAND
+    );
+    out_printf(""
         "  %c\n"
         "    Print currently selected Pokemon\n",
         GET_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Display details of the currently selected Pokemon\n",
         DETAILS_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Move the cursor to the next Pokemon in the Pokedex\n",
         NEXT_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Move the cursor to the previous Pokemon in the Pokedex\n",
         PREV_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c [pokemon_id]\n"
         "    Move the cursor to the Pokemon with the specified pokemon_id\n",
         CHANGE_CURR_COMMAND
     );
-    printf(""
+    out_printf(""
+        "  %c [position]\n"
+        "    Move the cursor to the Pokemon at a position (0 is the first)\n",
+        JUMP_COMMAND
+    );
+    out_printf(""
         "  %c\n"
         "    Remove the current Pokemon from the Pokedex\n",
         REMOVE_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Show Pokemon types\n",
         SHOW_TYPES_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Go exploring for Pokemon\n",
         EXPLORE_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Set the current Pokemon to be found\n",
         SET_FOUND_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Print out the count of Pokemon who have been found\n",
         COUNT_FOUND_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Print out the total count of Pokemon in the Pokedex\n",
         COUNT_TOTAL_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c [pokemon_A] [pokemon_B]\n"
         "    Add an evolution from Pokemon A to Pokemon B\n",
         EVOLUTION_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Show evolutions of the currently selected Pokemon\n",
         SHOW_EVOLUTION_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Show next evolution of current selected Pokemon\n",
         NEXT_EVOLUTION_COMMAND
     );
-    printf(""
+    out_printf(""
+        "  %c\n"
+        "    Show the family of the current Pokemon, from its final form\n",
+        FAMILY_COMMAND
+    );
+    out_printf(""
+        "  %c\n"
+        "    Show every family of Pokemon linked by evolutions\n",
+        CHAINS_COMMAND
+    );
+    out_printf(""
         "  %c\n"
         "     Create a new Pokedex containing Pokemon that have previously been found\n",
         GET_FOUND_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c [string]\n"
        "     Create a new Pokedex containing Pokemon that have the specified string in their name\n",
         SEARCH_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c [type]\n"
        "     Create a new Pokedex containing Pokemon that have the specified type\n",
         GET_TYPE_COMMAND
     );
-    printf(""
+    out_printf(""
+        "  %c [file]\n"
+        "    Save the Pokedex to a snapshot file\n",
+        SAVE_COMMAND
+    );
+    out_printf(""
+        "  %c [file]\n"
+        "    Replace the Pokedex with the one saved in a snapshot file\n",
+        LOAD_COMMAND
+    );
+    out_printf(""
+        "  %c [file] [threads]\n"
+        "    Add the Pokemon in a CSV or TSV file, in order of pokemon_id\n",
+        IMPORT_COMMAND
+    );
+    out_printf(""
+        "  %c\n"
+        "    Checkpoint the journal: save a snapshot and empty the journal\n",
+        CHECKPOINT_COMMAND
+    );
+#ifdef POKEDEX_STATS
+    out_printf(""
+        "  %c\n"
+        "    Show the calls, work and latency of each command\n",
+        STATS_COMMAND
+    );
+#endif
+    out_printf(""
         "  %c\n"
         "    Quit\n",
         QUIT_COMMAND
     );
-    printf(""
+    out_printf(""
         "  %c\n"
         "    Show help\n",
         HELP_COMMAND
     );
-    printf(""
+    out_printf(""
         "================================================================\n"
     );
 }
 
 static int get_command(char *command, int max_command_length) {
-    printf("Enter command: ");
+    if (!batch_mode) {
+        out_printf("Enter command: ");
+        out_flush();
+    }
 
     if (fgets(command, max_command_length, stdin) == NULL) {
         return 0;
@@ -299,51 +662,78 @@ static int get_command(char *command, int max_command_length) {
     return 1;
 }
 
+// On stdin a negative id, a duplicate id or a type2 the same as type1
+// stop the program in new_pokemon or add_new_pokemon, as they always
+// have. A client must not stop the server, so for one they are only
+// reported.
 static void do_add(Pokedex pokedex, char *line) {
-    int pokemon_id;
-    double height, weight;
-    char name[MAX_LINE] = {0};
-    char type_name1[MAX_LINE] = {0};
-    char type_name2[MAX_LINE] = "None";
-
-    int items_read = sscanf(line, "%d%s%lf%lf%s%s", &pokemon_id,
-        name, &height, &weight, type_name1, type_name2);
+    struct add_command add;
+    int items_read = parse_add_command(line, &add);
 
     if (items_read < 5) {
-        printf("Invalid Add Command\n");
+        out_printf("Invalid Add Command\n");
         return;
     }
 
-    if (pokemon_id < 0) {
-        printf("Invalid pokemon_id\n");
+    if (add.pokemon_id < 0) {
+        out_printf("Invalid pokemon_id\n");
+        if (serving_client != NULL) {
+            return;
+        }
     }
 
-    if (!pokemon_valid_name(name)) {
-        printf("Invalid name\n");
+    if (!pokemon_valid_name(add.name)) {
+        out_printf("Invalid name\n");
         return;
     }
 
-    pokemon_type type1 = pokemon_type_from_string(type_name1);
-    pokemon_type type2 = pokemon_type_from_string(type_name2);
+    if (serving_client != NULL && has_pokemon(pokedex, add.pokemon_id)) {
+        out_printf("There's already a Pokemon with pokemon_id %d\n",
+            add.pokemon_id);
+        return;
+    }
+
+    pokemon_type type1 = pokemon_type_from_string(add.type_name1);
+    pokemon_type type2 = pokemon_type_from_string(add.type_name2);
 
     if (type1 == INVALID_TYPE || type1 == NONE_TYPE) {
-        printf("Invalid type1\n");
+        out_printf("Invalid type1\n");
         return;
     }
 
-    if (type2 == INVALID_TYPE) {
-        printf("Invalid type2\n");
+    if (type2 == INVALID_TYPE
+            || (serving_client != NULL && type2 == type1)) {
+        out_printf("Invalid type2\n");
         return;
     }
 
-    Pokemon pokemon = new_pokemon(pokemon_id, name, height, weight, type1, type2);
-
-    add_pokemon(pokedex, pokemon);
-    printf("Added %s to the Pokedex!\n", name);
+    add_new_pokemon(pokedex, add.pokemon_id, add.name,
+        add.height, add.weight, type1, type2);
+    out_printf("Added %s to the Pokedex!\n", add.name);
 }
 
-static void do_print(Pokedex pokedex) {
-    print_pokemon(pokedex);
+// p prints every Pokemon, "p position [limit]" a page of them,
+// and "p #id #id" the ones between two Pokemon.
+static void do_print(Pokedex pokedex, char *line) {
+    if (line[0] == '\0') {
+        print_pokemon(pokedex);
+        return;
+    }
+
+    int from_id, to_id;
+    if (sscanf(line, "#%d #%d", &from_id, &to_id) == 2) {
+        print_pokemon_between(pokedex, from_id, to_id);
+        return;
+    }
+
+    int position;
+    int limit = INT_MAX;
+    if (sscanf(line, "%d%d", &position, &limit) < 1
+            || position < 0 || limit < 0) {
+        out_printf("Invalid Print Command\n");
+        return;
+    }
+    print_pokemon_page(pokedex, position, limit);
 }
 
 static void do_details(Pokedex pokedex) {
@@ -353,10 +743,10 @@ static void do_details(Pokedex pokedex) {
 static void do_get(Pokedex pokedex) {
     Pokemon current = get_current_pokemon(pokedex);
     if (current != NULL) {
-        printf("Currently selected Pokemon: #%d (%s)\n",
+        out_printf("Currently selected Pokemon: #%d (%s)\n",
             pokemon_id(current), pokemon_name(current));
     } else {
-        printf("No current Pokemon\n");
+        out_printf("No current Pokemon\n");
     }
 }
 
@@ -371,12 +761,21 @@ static void do_prev(Pokedex pokedex) {
 static void do_change_curr(Pokedex pokedex, char *line) {
     int pokemon_id;
     if (sscanf(line, "%d", &pokemon_id) != 1) {
-        printf("Invalid Change Current Command\n");
+        out_printf("Invalid Change Current Command\n");
         return;
     }
     change_current_pokemon(pokedex, pokemon_id);
 }
 
+static void do_jump(Pokedex pokedex, char *line) {
+    int position;
+    if (sscanf(line, "%d", &position) != 1 || position < 0) {
+        out_printf("Invalid Jump Command\n");
+        return;
+    }
+    change_current_position(pokedex, position);
+}
+
 static void do_remove(Pokedex pokedex) {
     remove_pokemon(pokedex);
 }
@@ -394,20 +793,25 @@ static void do_set_found(Pokedex pokedex) {
 }
 
 static void do_count_found(Pokedex pokedex) {
-    printf("Total Found Pokemon: %d\n", count_found_pokemon(pokedex));
+    out_printf("Total Found Pokemon: %d\n", count_found_pokemon(pokedex));
 }
 
 static void do_count_total(Pokedex pokedex) {
-    printf("Total Pokemon: %d\n", count_total_pokemon(pokedex));
+    out_printf("Total Pokemon: %d\n", count_total_pokemon(pokedex));
 }
 
 static void do_evolution(Pokedex pokedex, char *line) {
     int pokemonA, pokemonB;
     if (sscanf(line, "%d%d", &pokemonA, &pokemonB) != 2) {
-        printf("Invalid Evolution Command\n");
+        out_printf("Invalid Evolution Command\n");
         return;
     }
 
+    if (serving_client != NULL
+            && !can_add_evolution(pokedex, pokemonA, pokemonB)) {
+        out_printf("Invalid Pokemon Evolution!\n");
+        return;
+    }
     add_pokemon_evolution(pokedex, pokemonA, pokemonB);
 }
 
@@ -416,42 +820,150 @@ static void do_show_evolutions(Pokedex pokedex) {
 }
 
 static void do_next_evolution(Pokedex pokedex) {
+    if (serving_client != NULL && get_current_pokemon(pokedex) == NULL) {
+        out_printf("The Pokedex is empty!\n");
+        return;
+    }
     int id = get_next_evolution(pokedex);
     if (id == DOES_NOT_EVOLVE) {
-        printf("DOES_NOT_EVOLVE\n");
+        out_printf("DOES_NOT_EVOLVE\n");
     } else {
-        printf("ID: %03d\n", id);
+        out_printf("ID: %03d\n", id);
     }
 }
 
+static void do_show_family(Pokedex pokedex) {
+    show_family(pokedex);
+}
+
+static void do_show_chains(Pokedex pokedex) {
+    show_all_chains(pokedex);
+}
+
 static void do_get_found(Pokedex pokedex) {
     Pokedex new_pokedex = get_found_pokemon(pokedex);
-    printf("Switching to explore the Pokedex get_found_pokemon returned\n");
-    explore_pokedex(new_pokedex);
+    out_printf("Switching to explore the Pokedex get_found_pokemon returned\n");
+    explore_view(new_pokedex);
 }
 
 static void do_get_type(Pokedex pokedex, char *line) {
     pokemon_type type = pokemon_type_from_string(line);
 
     if (type == INVALID_TYPE || type == NONE_TYPE || type == MAX_TYPE) {
-        printf("Invalid type\n");
+        out_printf("Invalid type\n");
         return;
     }
     Pokedex new_pokedex = get_pokemon_of_type(pokedex, type);
-    printf("Switching to explore the Pokedex get_pokemon_of_type %s returned\n", line);
-    explore_pokedex(new_pokedex);
+    out_printf("Switching to explore the Pokedex get_pokemon_of_type %s returned\n", line);
+    explore_view(new_pokedex);
 }
 
 static void do_search(Pokedex pokedex, char *line) {
     if (line[0]) {
         Pokedex new_pokedex = search_pokemon(pokedex, line);
-        printf("Switching to explore the Pokedex search_pokemon \"%s\" returned\n", line);
-        explore_pokedex(new_pokedex);
+        out_printf("Switching to explore the Pokedex search_pokemon \"%s\" returned\n", line);
+        explore_view(new_pokedex);
     } else {
-        printf("Invalid Search Command\n");
+        out_printf("Invalid Search Command\n");
+    }
+}
+
+static void do_save(Pokedex pokedex, char *line) {
+    if (trim_end(line) == 0) {
+        out_printf("Invalid Save Command\n");
+        return;
+    }
+
+    out_flush();
+    if (save_pokedex(pokedex, line)) {
+        out_printf("Saved %d Pokemon to %s\n",
+            count_total_pokemon(pokedex), line);
+    } else {
+        out_printf("Could not save to %s\n", line);
+    }
+}
+
+static void do_load(Pokedex pokedex, char *line) {
+    if (trim_end(line) == 0) {
+        out_printf("Invalid Load Command\n");
+        return;
+    }
+
+    out_flush();
+    if (load_pokedex(pokedex, line)) {
+        out_printf("Loaded %d Pokemon from %s\n",
+            count_total_pokemon(pokedex), line);
+    } else {
+        out_printf("Could not load from %s\n", line);
+    }
+}
+
+static void do_import(Pokedex pokedex, char *line) {
+    char path[MAX_LINE];
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (sscanf(line, "%s%d", path, &threads) < 1 || threads < 1) {
+        out_printf("Invalid Import Command\n");
+        return;
+    }
+
+    struct import_report report;
+    out_flush();
+    if (!import_pokemon(pokedex, path, threads, &report)) {
+        out_printf("Could not import from %s\n", path);
+        return;
+    }
+
+    out_printf("Imported %d Pokemon from %s\n", report.added, path);
+    print_import_problems(report.invalid, "invalid rows",
+        report.invalid_examples, report.num_invalid_examples);
+    print_import_problems(report.duplicates, "rows with duplicate ids",
+        report.duplicate_examples, report.num_duplicate_examples);
+}
+
+static void do_checkpoint(Pokedex pokedex) {
+    out_flush();
+    if (checkpoint_pokedex(pokedex)) {
+        out_printf("Checkpointed %d Pokemon\n", count_total_pokemon(pokedex));
+    } else {
+        out_printf("Could not checkpoint\n");
+    }
+}
+
+// Print how many rows of an import were skipped, and a few of them.
+static void print_import_problems(int count, char *what,
+    struct import_problem *examples, int num_examples) {
+
+    if (count == 0) {
+        return;
+    }
+
+    out_printf("Skipped %d %s:\n", count, what);
+    int i = 0;
+    while (i < num_examples) {
+        if (examples[i].pokemon_id >= 0) {
+            out_printf("    line %d: #%03d %s\n", examples[i].line,
+                examples[i].pokemon_id, examples[i].reason);
+        } else {
+            out_printf("    line %d: %s\n", examples[i].line,
+                examples[i].reason);
+        }
+        i++;
+    }
+    if (count > num_examples) {
+        out_printf("    ...\n");
+    }
+}
+
+// Remove white space from the end of line, and return its new length.
+static int trim_end(char *line) {
+    int length = strlen(line);
+    while (length > 0 && isspace(line[length - 1])) {
+        length--;
     }
+    line[length] = '\0';
+    return length;
 }
 
 static void do_quit(void) {
-    printf("Goodbye.\n");
+    out_printf("Goodbye.\n");
 }
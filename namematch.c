@@ -0,0 +1,225 @@
+// namematch.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+//
+// Case-insensitive substring matching for search_pokemon.
+// The vector matchers fold 16 or 32 name positions at a time and keep
+// only the positions where both the first and the last character of
+// the text match, then check those few positions in full.
+
+#include <stdint.h>
+
+#include "namematch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86
+#include <immintrin.h>
+#endif
+
+typedef int (*matcher_function)(const char *name, int name_length,
+    const char *text, int text_length);
+
+// Make an uppercase letter lowercase.
+static char fold(char c);
+
+// Return whether text matches name at a position, ignoring case.
+static int matches_at(const char *name, const char *text, int text_length);
+
+// Return whether text appears in name, a byte at a time.
+static int scalar_contains(const char *name, int name_length,
+    const char *text, int text_length);
+
+#ifdef HAVE_X86
+static int sse2_contains(const char *name, int name_length,
+    const char *text, int text_length);
+static int avx2_contains(const char *name, int name_length,
+    const char *text, int text_length);
+#endif
+
+// Pick the fastest matcher this CPU supports.
+static matcher_function best_matcher(void);
+
+static matcher_function contains = NULL;
+
+// Return whether text appears in name, ignoring case,
+// using the matcher chosen for this CPU.
+int name_contains(const char *name, int name_length,
+    const char *text, int text_length) {
+
+    if (text_length == 0 || text_length > name_length) {
+        return 0;
+    }
+    // Scans call this from several threads at once; each picks the
+    // same matcher, so whichever store lands last is fine.
+    matcher_function matcher = __atomic_load_n(&contains, __ATOMIC_RELAXED);
+    if (matcher == NULL) {
+        matcher = best_matcher();
+        __atomic_store_n(&contains, matcher, __ATOMIC_RELAXED);
+    }
+    return matcher(name, name_length, text, text_length);
+}
+
+// Make name_contains use `matcher`, if this CPU can run it.
+int use_name_matcher(name_matcher matcher) {
+    if (matcher == SCALAR_MATCHER) {
+        contains = scalar_contains;
+        return 1;
+    }
+#ifdef HAVE_X86
+    if (matcher == SSE2_MATCHER) {
+        contains = sse2_contains;
+        return 1;
+    }
+    if (matcher == AVX2_MATCHER && __builtin_cpu_supports("avx2")) {
+        contains = avx2_contains;
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+// Pick the fastest matcher this CPU supports.
+// Every x86-64 CPU has SSE2; AVX2 is checked at run time.
+static matcher_function best_matcher(void) {
+#ifdef HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return avx2_contains;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return sse2_contains;
+    }
+#endif
+    return scalar_contains;
+}
+
+// Make an uppercase letter lowercase.
+static char fold(char c) {
+    if (c >= 'A' && c <= 'Z') {
+        return c + 'a' - 'A';
+    }
+    return c;
+}
+
+// Return whether text matches name at a position, ignoring case.
+static int matches_at(const char *name, const char *text, int text_length) {
+    int j = 0;
+    while (j < text_length && fold(name[j]) == fold(text[j])) {
+        j++;
+    }
+    return j == text_length;
+}
+
+// Try every position in turn.
+// Unlike the old matcher, a failed partial match never skips
+// a position, so "aab" is found in "aaab".
+static int scalar_contains(const char *name, int name_length,
+    const char *text, int text_length) {
+
+    char first = fold(text[0]);
+    int i = 0;
+    while (i + text_length <= name_length) {
+        if (fold(name[i]) == first
+                && matches_at(&name[i], text, text_length)) {
+            return 1;
+        }
+        i++;
+    }
+    return 0;
+}
+
+#ifdef HAVE_X86
+
+// Fold 16 characters: set bit 0x20 of every byte in 'A'..'Z'.
+static __m128i fold_16(__m128i chars) {
+    __m128i upper = _mm_and_si128(
+        _mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)),
+        _mm_cmplt_epi8(chars, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(chars, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+// Check 16 positions at a time with the first/last character filter.
+static int sse2_contains(const char *name, int name_length,
+    const char *text, int text_length) {
+
+    __m128i first = _mm_set1_epi8(fold(text[0]));
+    __m128i last = _mm_set1_epi8(fold(text[text_length - 1]));
+    int positions = name_length - text_length + 1;
+
+    int i = 0;
+    while (i < positions) {
+        __m128i block_first = fold_16(
+            _mm_loadu_si128((const __m128i *) &name[i]));
+        __m128i block_last = fold_16(
+            _mm_loadu_si128((const __m128i *) &name[i + text_length - 1]));
+
+        uint32_t mask = _mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(block_first, first),
+            _mm_cmpeq_epi8(block_last, last)));
+        if (positions - i < 16) {
+            mask &= (1u << (positions - i)) - 1;
+        }
+
+        while (mask != 0) {
+            int offset = __builtin_ctz(mask);
+            if (matches_at(&name[i + offset], text, text_length)) {
+                return 1;
+            }
+            mask &= mask - 1;
+        }
+
+        i += 16;
+    }
+    return 0;
+}
+
+// Fold 32 characters: set bit 0x20 of every byte in 'A'..'Z'.
+__attribute__((target("avx2")))
+static __m256i fold_32(__m256i chars) {
+    __m256i upper = _mm256_and_si256(
+        _mm256_cmpgt_epi8(chars, _mm256_set1_epi8('A' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), chars));
+    return _mm256_or_si256(chars,
+        _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+// Check 32 positions at a time with the first/last character filter.
+__attribute__((target("avx2")))
+static int avx2_contains(const char *name, int name_length,
+    const char *text, int text_length) {
+
+    __m256i first = _mm256_set1_epi8(fold(text[0]));
+    __m256i last = _mm256_set1_epi8(fold(text[text_length - 1]));
+    int positions = name_length - text_length + 1;
+
+    int i = 0;
+    while (i < positions) {
+        __m256i block_first = fold_32(
+            _mm256_loadu_si256((const __m256i *) &name[i]));
+        __m256i block_last = fold_32(
+            _mm256_loadu_si256((const __m256i *) &name[i + text_length - 1]));
+
+        uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(block_first, first),
+            _mm256_cmpeq_epi8(block_last, last)));
+        if (positions - i < 32) {
+            mask &= (1u << (positions - i)) - 1;
+        }
+
+        while (mask != 0) {
+            int offset = __builtin_ctz(mask);
+            if (matches_at(&name[i + offset], text, text_length)) {
+                return 1;
+            }
+            mask &= mask - 1;
+        }
+
+        i += 32;
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,34 @@
+// namematch.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _NAMEMATCH_H_
+#define _NAMEMATCH_H_
+
+// The vector matchers may read this many bytes past the end of a name,
+// so every name passed to name_contains must be followed by at least
+// this many readable bytes.
+#define NAME_MATCH_PADDING 32
+
+// The matchers name_contains can use, slowest first.
+typedef enum name_matcher {
+    SCALAR_MATCHER,
+    SSE2_MATCHER,
+    AVX2_MATCHER
+} name_matcher;
+
+// Return 1 if `text` appears in `name`, ignoring the case of letters,
+// or 0 if not. An empty text appears in no name.
+// `name_length` and `text_length` exclude the '\0'.
+int name_contains(const char *name, int name_length,
+    const char *text, int text_length);
+
+// Make name_contains use `matcher` (for benchmarks).
+// Returns 0, and changes nothing, if this CPU cannot run it.
+// By default the fastest matcher the CPU supports is used.
+int use_name_matcher(name_matcher matcher);
+
+#endif // _NAMEMATCH_H_
@@ -0,0 +1,247 @@
+// output.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <unistd.h>
+#include <assert.h>
+
+#include "output.h"
+
+#define BUFFER_SIZE (1 << 20)
+
+static char buffer[BUFFER_SIZE];
+static int buffered = 0;
+static int out_fd = STDOUT_FILENO;
+static int flush_at_exit = 0;
+static out_sink_function out_sink = NULL;
+static void *out_sink_context = NULL;
+
+// Make sure the buffer is written out when the program exits,
+// including through exit(1) after an error.
+static void register_flush(void);
+
+// Write `length` bytes straight to the output file descriptor,
+// or the sink.
+static void write_all(const char *bytes, int length);
+
+// Write the digits of `value` into `to`, padded with zeros to `width`,
+// and return how many there are.
+static int format_digits(char *to, unsigned long long value, int width);
+
+// Write formatted output, like printf.
+void out_printf(const char *format, ...) {
+    register_flush();
+
+    va_list args;
+    va_start(args, format);
+    va_list retry;
+    va_copy(retry, args);
+
+    int space = BUFFER_SIZE - buffered;
+    int length = vsnprintf(&buffer[buffered], space, format, args);
+    va_end(args);
+    assert(length >= 0);
+
+    if (length < space) {
+        buffered += length;
+    } else if (length < BUFFER_SIZE) {
+        out_flush();
+        vsnprintf(buffer, BUFFER_SIZE, format, retry);
+        buffered = length;
+    } else {
+        char *text = malloc(length + 1);
+        assert(text != NULL);
+        vsnprintf(text, length + 1, format, retry);
+        out_write(text, length);
+        free(text);
+    }
+    va_end(retry);
+}
+
+// Write `length` bytes of output.
+void out_write(const char *bytes, int length) {
+    register_flush();
+
+    if (length > BUFFER_SIZE - buffered) {
+        out_flush();
+    }
+    if (length >= BUFFER_SIZE) {
+        write_all(bytes, length);
+        return;
+    }
+
+    memcpy(&buffer[buffered], bytes, length);
+    buffered += length;
+}
+
+// Write one character of output.
+void out_char(char c) {
+    if (buffered == BUFFER_SIZE) {
+        out_flush();
+    }
+    register_flush();
+    buffer[buffered] = c;
+    buffered++;
+}
+
+// Write out everything in the buffer.
+void out_flush(void) {
+    write_all(buffer, buffered);
+    buffered = 0;
+}
+
+// Write output to file descriptor `fd` from now on.
+void out_set_fd(int fd) {
+    out_flush();
+    out_fd = fd;
+}
+
+// Give output to `sink` from now on.
+void out_set_sink(out_sink_function sink, void *context) {
+    out_flush();
+    out_sink = sink;
+    out_sink_context = context;
+}
+
+// Return room for `length` bytes at the end of the buffer.
+char *out_reserve(int length) {
+    register_flush();
+    assert(length <= OUT_RESERVE_MAX);
+
+    if (length > BUFFER_SIZE - buffered) {
+        out_flush();
+    }
+    return &buffer[buffered];
+}
+
+// Make the `length` bytes written after out_reserve output.
+void out_commit(int length) {
+    buffered += length;
+}
+
+// Write `value` into `to` like "%0*d".
+int format_padded_int(char *to, int value, int width) {
+    if (value < 0) {
+        // The minus sign counts towards the width, as in printf.
+        to[0] = '-';
+        return 1 + format_digits(to + 1,
+            -(unsigned long long) (long long) value, width - 1);
+    }
+    return format_digits(to, value, width);
+}
+
+// Write `value` into `to` like "%.1f".
+// A finite double below 2^53 is m * 2^e for an integer m below 2^53,
+// so value * 10 is exactly m * 10 / 2^-e, and the tenths are that
+// quotient, rounded half to even on the remainder as printf does.
+// Anything else goes to snprintf.
+int format_fixed1(char *to, double value) {
+    double size = fabs(value);
+    if (!(size < 9007199254740992.0)) {
+        return snprintf(to, FIXED1_MAX, "%.1f", value);
+    }
+
+    int length = 0;
+    if (signbit(value)) {
+        to[length] = '-';
+        length++;
+    }
+
+    int exponent;
+    double fraction = frexp(size, &exponent);
+    unsigned long long mantissa = (unsigned long long) ldexp(fraction, 53);
+    int shift = 53 - exponent;
+
+    // mantissa * 10 is below 2^57; a shift past 60 leaves less than
+    // half a tenth, which rounds down to 0.
+    unsigned long long tenths = 0;
+    if (shift <= 0) {
+        tenths = (mantissa << -shift) * 10;
+    } else if (shift <= 60) {
+        unsigned long long scaled = mantissa * 10;
+        unsigned long long half = 1ULL << (shift - 1);
+        unsigned long long rest = scaled & ((1ULL << shift) - 1);
+        tenths = scaled >> shift;
+        if (rest > half || (rest == half && (tenths & 1))) {
+            tenths++;
+        }
+    }
+
+    length += format_digits(to + length, tenths / 10, 1);
+    to[length] = '.';
+    to[length + 1] = '0' + tenths % 10;
+    return length + 2;
+}
+
+// Write output formatted like "%0*d".
+void out_padded_int(int value, int width) {
+    char *to = out_reserve(11);
+    out_commit(format_padded_int(to, value, width));
+}
+
+// Write output formatted like "%.1f".
+void out_fixed1(double value) {
+    char *to = out_reserve(FIXED1_MAX);
+    out_commit(format_fixed1(to, value));
+}
+
+// Write the digits of `value` into `to`, padded with zeros to `width`.
+// They are made backwards into a scratch array, then copied.
+static int format_digits(char *to, unsigned long long value, int width) {
+    char digits[20];
+    int count = 0;
+    while (count == 0 || value != 0) {
+        digits[sizeof(digits) - 1 - count] = '0' + value % 10;
+        value /= 10;
+        count++;
+    }
+
+    int length = 0;
+    while (length < width - count) {
+        to[length] = '0';
+        length++;
+    }
+    memcpy(to + length, &digits[sizeof(digits) - count], count);
+    return length + count;
+}
+
+// Make sure the buffer is written out when the program exits.
+static void register_flush(void) {
+    if (!flush_at_exit) {
+        atexit(out_flush);
+        flush_at_exit = 1;
+    }
+}
+
+// Write `length` bytes straight to the output file descriptor (or
+// the sink), retrying after partial writes and interrupts.
+static void write_all(const char *bytes, int length) {
+    if (out_sink != NULL) {
+        if (length > 0) {
+            out_sink(bytes, length, out_sink_context);
+        }
+        return;
+    }
+
+    while (length > 0) {
+        ssize_t written = write(out_fd, bytes, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("write");
+            return;
+        }
+        bytes += written;
+        length -= written;
+    }
+}
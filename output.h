@@ -0,0 +1,68 @@
+// output.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _OUTPUT_H_
+#define _OUTPUT_H_
+
+// All normal output of the Pokedex goes through one large buffer,
+// which is written out when it fills up, when out_flush is called,
+// and when the program exits.
+// Error messages still go straight to stderr.
+
+// Write formatted output, like printf.
+void out_printf(const char *format, ...)
+    __attribute__((format(printf, 1, 2)));
+
+// Write `length` bytes of output.
+void out_write(const char *bytes, int length);
+
+// Write one character of output.
+void out_char(char c);
+
+// Write out everything in the buffer.
+void out_flush(void);
+
+// The most out_reserve can give at once.
+#define OUT_RESERVE_MAX 65536
+
+// The most format_fixed1 can write.
+#define FIXED1_MAX 320
+
+// Return room for `length` bytes (at most OUT_RESERVE_MAX) at the end
+// of the buffer, flushing it first if there is not enough.
+// What is written there becomes output when out_commit is called with
+// how many bytes were written, before any other out_ call.
+char *out_reserve(int length);
+void out_commit(int length);
+
+// Write `value` into `to` in decimal like "%0*d", padded with zeros to
+// `width` digits (at most 10), and return how many chars it took.
+// `to` needs room for 11 chars.
+int format_padded_int(char *to, int value, int width);
+
+// Write `value` into `to` like "%.1f", with the same rounding, and
+// return how many chars it took. `to` needs room for FIXED1_MAX chars.
+int format_fixed1(char *to, double value);
+
+// Write output formatted like "%0*d" and like "%.1f".
+void out_padded_int(int value, int width);
+void out_fixed1(double value);
+
+// Write output to file descriptor `fd` from now on (1 by default).
+// The buffer is flushed to the old file descriptor first.
+void out_set_fd(int fd);
+
+// A function that takes output instead of a file descriptor.
+typedef void (*out_sink_function)(const char *bytes, int length,
+    void *context);
+
+// Give output to `sink`, with `context`, from now on, or to the file
+// descriptor again if `sink` is NULL.
+// The buffer is flushed to the old destination first.
+void out_set_sink(out_sink_function sink, void *context);
+
+#endif // _OUTPUT_H_
@@ -7,9 +7,19 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <limits.h>
 
 #include "pokedex.h"
+#include "idindex.h"
+#include "columns.h"
+#include "trigram.h"
+#include "namematch.h"
+#include "output.h"
+#include "snapshot.h"
+#include "journal.h"
+#include "stats.h"
 
 #define MAX_STRING_LENGTH 256
 #define MAX_TYPE 19
@@ -18,6 +28,15 @@
 #define NONE_TYPE 0
 #define TURE 1
 #define FALSE 0
+#define MIN_COMPACT_ROWS 64
+// The most a line of print_pokemon has before the name:
+// "--> #", an id of up to 11 chars, and ": ".
+#define LINE_HEAD_MAX 18
+
+// Who owns the memory of a pokenode and its Pokemon.
+#define OWN_MEMORY 0
+#define VIEW_MEMORY 1
+#define SNAPSHOT_NAME 2
 
 struct pokedex {
     struct pokenode *head;
@@ -25,28 +44,170 @@ struct pokedex {
     struct pokenode *current;
     struct pokedata *data;
     struct pokedex *next;
+    IdIndex        index;
+    Pool           node_pool;
+    Pool           pokemon_pool;
+    struct pokenode *view_nodes;
+    Columns        columns;
+    TrigramIndex   trigrams;
+    Snapshot       snapshot;
+    Journal        journal;
+    struct family  *families;
+    int            families_used;
+    int            families_capacity;
+    int            dead_families;
+    unsigned int   graph_version;
 };
 
+// A Pokedex made by get_found_pokemon, search_pokemon or
+// get_pokemon_of_type is a view of the original Pokedex:
+// its nodes are one block (view_nodes) of borrowed nodes,
+// which point at the Pokemon of the original Pokedex
+// instead of cloning them.
+// A view creates its index and pools only once they are needed,
+// and must be destroyed before the original Pokedex changes.
+//
+// The scans over a Pokedex (y, x, F, S and T) run over its columns,
+// a packed copy of the Pokemon made the first time a scan needs it
+// and kept up to date from then on. Each node knows its row.
+// The trigram index over the names of those rows is made by the
+// first search for three or more characters, and is dropped and
+// rebuilt along with the columns.
+//
+// A Pokedex loaded by load_pokedex keeps its snapshot file mapped:
+// the names of the loaded Pokemon point straight into the mapping,
+// and their nodes are marked SNAPSHOT_NAME so the names are never
+// given back to the pool.
+//
+// A Pokedex with a journal (open_pokedex_journal) writes a record of
+// each Pokemon added, found or removed and each evolution added to
+// it, as it happens. Views never have one.
+//
+// Every node also lists the nodes that evolve into it (evolves_from,
+// linked through their next_from and prev_from), so removing a node
+// detaches each evolution into it in time proportional to their
+// number, and no evolve pointer is ever left pointing at a freed node.
+//
+// Evolutions never form a loop (add_pokemon_evolution rejects one),
+// so each family of Pokemon linked by evolutions is a tree, whose
+// root is the final form that every chain in it ends at.
+// - family is the node's entry in the union-find of the Pokedex
+//   (families), or -1 if it has never been linked to anything.
+//   Linking two families unions them, but unlinking never splits
+//   them, so two nodes with different union-find roots are in
+//   different families, while two with the same root only may be.
+// - root and depth (hops to the final form) are cached, and valid
+//   while stamp is the version of the node's union-find root, which
+//   changes with every evolution added or removed in it.
 struct pokenode {
     Pokemon pokemon;
     struct pokenode *next;
     struct pokenode *prev;
     struct pokenode *evolve;
+    struct pokenode *evolves_from;
+    struct pokenode *next_from;
+    struct pokenode *prev_from;
+    int             family;
+    struct pokenode *root;
+    int             depth;
+    unsigned int    stamp;
     int             status;
+    int             memory;
+    int             row;
+};
+
+// An entry in the union-find of families: its parent, and at a root
+// the number of entries under it and the version of their cached
+// roots and depths. Entries of removed nodes stay until there are
+// more of them than nodes, when the union-find is made again.
+struct family {
+    int          parent;
+    int          size;
+    unsigned int version;
+};
+
+// A growable array of pokenode pointers,
+// used to collect the nodes of a new view.
+struct node_list {
+    struct pokenode **nodes;
+    int             size;
+    int             capacity;
+};
+
+// A node with its pokemon_id, as sorted by sort_nodes_by_id.
+struct sort_entry {
+    unsigned int    id;
+    struct pokenode *node;
 };
 
 // This struct is used to store the data of pokedex
-// including total Pokemon number, found Pokemon number
-// and a type_record array in the pokedex. 
+// including total Pokemon number, found Pokemon number,
+// the numbers of Pokemon and found Pokemon of each type,
+// and a type_record array of the types in the pokedex. 
+//
+// type_record holds the types in the order they first appear,
+// ended by NONE_TYPE, and type_first the node each first appears in.
+// Both are kept up to date as Pokemon are added, except that removing
+// the first node of a type which is still present leaves them stale,
+// until show_types finds the first nodes again.
 struct pokedata {
-    int total;
-    int found_nums;
-    int type_record[MAX_TYPE];
+    int             total;
+    int             found_nums;
+    int             type_total[MAX_TYPE];
+    int             type_found[MAX_TYPE];
+    int             type_record[MAX_TYPE];
+    struct pokenode *type_first[MAX_TYPE];
+    int             types_stale;
 };
 
 
 // Creates a new pokenode struct and returns a pointer to it.
-static struct pokenode *new_pokenode(Pokemon pokemon);
+static struct pokenode *new_pokenode(Pokemon pokemon, Pokedex pokedex);
+
+// Free a pokenode and the Pokemon in it.
+static void destroy_pokenode(struct pokenode *node, Pokedex pokedex);
+
+// Add a Pokemon made in the pool of Pokedex to the end of Pokedex.
+static void append_pokemon(Pokedex pokedex, Pokemon pokemon);
+
+// Make sure the Pokedex has pools to hold Pokemon of its own.
+static void own_memory(Pokedex pokedex);
+
+// Return the id index of Pokedex, building it if needed.
+static IdIndex get_index(Pokedex pokedex);
+
+// Return the columns of Pokedex, building them if needed.
+static Columns get_columns(Pokedex pokedex);
+
+// Return the trigram index of Pokedex, building it if needed.
+static TrigramIndex get_trigrams(Pokedex pokedex);
+
+// Set node in Pokedex to be found.
+static void set_found(Pokedex pokedex, struct pokenode *node);
+
+// Create a Pokedex with an empty pokedata and nothing else.
+static Pokedex new_empty_pokedex(void);
+
+// Free every Pokemon in Pokedex, and everything built over them.
+static void free_contents(Pokedex pokedex);
+
+// Empty Pokedex, leaving it with its own pools but no index yet.
+static void clear_pokedex(Pokedex pokedex);
+
+// Create a view Pokedex over the nodes in list, in order,
+// and free the list.
+static Pokedex new_view(struct node_list *list);
+
+// Set list to be empty.
+static void init_node_list(struct node_list *list);
+
+// Add node to the end of list.
+static void push_node(struct node_list *list, struct pokenode *node);
+
+// Set list to the nodes of the rows of columns set in both `a` and `b`,
+// in row order. `b` may be NULL.
+static void collect_rows(struct node_list *list, Columns columns,
+    const uint64_t *a, const uint64_t *b);
 
 // Return the string length.
 static int get_string_length(char *string);
@@ -55,8 +216,14 @@ static int get_string_length(char *string);
 // for example #001:********
 static void print_unfound_name(int length);
 
-// Store type into array.
-static void type_record(int *array, int type);
+// Print the line of node in print_pokemon, marked if it is current.
+static void print_pokemon_line(struct pokenode *node, int current);
+
+// Return MAX_STRING_LENGTH asterisks, to print the names not found.
+static const char *mask_of_names(void);
+
+// Store the types with a key into array, in order of their keys.
+static void order_types(int *array, int *keys);
 
 // Set all element of array to 0.
 static void clean_array(int *array);
@@ -64,60 +231,438 @@ static void clean_array(int *array);
 // Print the type string in the type_array.
 static void print_type_array(int *array);
 
-// Return whether the type is stored before
-// if not, it will store current type into array.
-static int type_exploring(int *array, int type);
-
-// This function is used to debug.
-static void debug_array(int *array);
+// This function is used to debug, so it is not called anywhere.
+static void debug_array(int *array) __attribute__((unused));
 
 // Helper Function : return the node address, 
 // which has the parameter ID.
 static struct pokenode *set_evolution(Pokedex pokedex, int id);
 
-// Print the evolution of current Pokemon.
-static void print_evolution(struct pokenode *node);
+// Set the evolution fields of a new node, with no evolutions.
+static void init_evolutions(struct pokenode *node);
 
-// Insert new pokenode into the end of Pokedex.
-static void insert_end_node(struct pokenode *new_node, Pokedex pokedex);
+// Make from evolve into to (or into nothing, if to is NULL),
+// keeping the evolves_from lists and families up to date.
+static void link_evolution(Pokedex pokedex, struct pokenode *from,
+    struct pokenode *to);
 
-// Insert new pokenode into the head of Pokedex.
-static void insert_head_node(struct pokenode *new_node, Pokedex pokedex);
+// Take from off the evolves_from list of what it evolves into.
+static void unlink_evolution(struct pokenode *from);
 
-// Insert new pokenode before the node insert_after in current Pokedex.
-static void insert_between_node(struct pokenode *new_node, struct pokenode *insert_after, Pokedex pokedex);
+// Remove every evolution into or out of node.
+static void detach_evolutions(Pokedex pokedex, struct pokenode *node);
 
-// Helper function : clone pokemon and create a node, 
-// and add to subPokedex.
-static void transfer_pokemon(struct pokenode *node, Pokedex pokedex);
+// Return 1 if making from evolve into to would make a loop.
+static int makes_cycle(Pokedex pokedex, struct pokenode *from,
+    struct pokenode *to);
 
-// Insert pokenode in order.
-static void insert_order_pokemon(struct pokenode *node, Pokedex pokedex);
+// Return the union-find root of the family of node, or -1 if it has
+// never been linked to anything.
+static int find_family(Pokedex pokedex, struct pokenode *node);
 
-// Set all pokemons are found in current pokedex.
-static void set_all_found(Pokedex pokedex);
+// Give node an entry of its own in the union-find, if it has none.
+static void new_family(Pokedex pokedex, struct pokenode *node);
 
-// Helper function
-// Determine if the current name contains text.
-static int compare_name(char *text, char *curr_name);
+// Join the families of a and b.
+static void union_families(Pokedex pokedex, struct pokenode *a,
+    struct pokenode *b);
+
+// Drop the union-find entry of a node being removed.
+static void forget_family(Pokedex pokedex, struct pokenode *node);
 
-// Make uppercase character lowercase.
-static char to_lower_case(char text);
+// Make the union-find again from the evolutions in Pokedex.
+static void rebuild_families(Pokedex pokedex);
+
+// Return the final form of node, caching it (and the depth of node).
+static struct pokenode *evolution_root(Pokedex pokedex,
+    struct pokenode *node);
+
+// Mark the cached roots and depths of the family of node out of date.
+static void change_graph(Pokedex pokedex, struct pokenode *node);
+
+// Print the tree of Pokemon that evolve into root, root first,
+// each indented by its depth below root.
+static void print_family(Pokedex pokedex, struct pokenode *root);
+
+// Print the ID, name and types of a node, or ???? if not found.
+static void print_evolution_entry(struct pokenode *node);
+
+// Set the evolution fields of a new node: it evolves into nothing,
+// nothing evolves into it, and it is a family of its own.
+static void init_evolutions(struct pokenode *node) {
+    node->evolve = NULL;
+    node->evolves_from = NULL;
+    node->next_from = NULL;
+    node->prev_from = NULL;
+    node->family = -1;
+    node->root = node;
+    node->depth = 0;
+    node->stamp = 0;
+}
+
+// Make from evolve into to (or into nothing, if to is NULL).
+// Taking from out of its old family leaves the union-find as it was,
+// so only the cached roots and depths of that family go out of date.
+static void link_evolution(Pokedex pokedex, struct pokenode *from,
+    struct pokenode *to) {
+
+    if (from->evolve != NULL) {
+        unlink_evolution(from);
+        change_graph(pokedex, from);
+    }
+
+    if (to != NULL) {
+        from->evolve = to;
+        from->next_from = to->evolves_from;
+        if (to->evolves_from != NULL) {
+            to->evolves_from->prev_from = from;
+        }
+        to->evolves_from = from;
+        union_families(pokedex, from, to);
+    }
+}
+
+// Take from off the evolves_from list of what it evolves into,
+// leaving it evolving into nothing.
+static void unlink_evolution(struct pokenode *from) {
+    struct pokenode *old = from->evolve;
+    if (from->prev_from != NULL) {
+        from->prev_from->next_from = from->next_from;
+    } else {
+        old->evolves_from = from->next_from;
+    }
+    if (from->next_from != NULL) {
+        from->next_from->prev_from = from->prev_from;
+    }
+
+    from->evolve = NULL;
+    from->prev_from = NULL;
+    from->next_from = NULL;
+}
+
+// Remove every evolution into or out of node,
+// so nothing evolves into it once it is freed.
+// Each Pokemon that evolved into node becomes a final form,
+// in time proportional to their number.
+static void detach_evolutions(Pokedex pokedex, struct pokenode *node) {
+    link_evolution(pokedex, node, NULL);
+    if (node->evolves_from != NULL) {
+        change_graph(pokedex, node);
+        while (node->evolves_from != NULL) {
+            unlink_evolution(node->evolves_from);
+        }
+    }
+    forget_family(pokedex, node);
+}
+
+// Return 1 if making from evolve into to would make a loop,
+// which it does exactly when to already evolves, in some number of
+// steps, into from.
+// Pokemon in different families never can; otherwise to must be
+// further from the shared final form than from is.
+static int makes_cycle(Pokedex pokedex, struct pokenode *from,
+    struct pokenode *to) {
+
+    int family = find_family(pokedex, from);
+    if (family < 0 || family != find_family(pokedex, to)) {
+        return FALSE;
+    }
+    if (evolution_root(pokedex, from) != evolution_root(pokedex, to)
+            || from->depth >= to->depth) {
+        return FALSE;
+    }
+
+    struct pokenode *curr = to;
+    int steps = to->depth - from->depth;
+    while (steps > 0) {
+        curr = curr->evolve;
+        STATS_VISIT(1);
+        steps--;
+    }
+    return curr == from;
+}
+
+// Return the union-find root of the family of node, or -1 if it has
+// never been linked to anything, halving the path to it on the way.
+static int find_family(Pokedex pokedex, struct pokenode *node) {
+    int family = node->family;
+    if (family < 0) {
+        return -1;
+    }
+
+    struct family *families = pokedex->families;
+    while (families[family].parent != family) {
+        families[family].parent = families[families[family].parent].parent;
+        family = families[family].parent;
+    }
+    node->family = family;
+    return family;
+}
+
+// Give node an entry of its own in the union-find, if it has none.
+static void new_family(Pokedex pokedex, struct pokenode *node) {
+    if (node->family >= 0) {
+        return;
+    }
+
+    if (pokedex->families_used == pokedex->families_capacity) {
+        pokedex->families_capacity = pokedex->families_capacity == 0
+            ? 16 : pokedex->families_capacity * 2;
+        pokedex->families = realloc(pokedex->families,
+            pokedex->families_capacity * sizeof(struct family));
+        assert(pokedex->families != NULL);
+        STATS_ALLOC(pokedex->families_capacity * sizeof(struct family));
+    }
+
+    int family = pokedex->families_used;
+    pokedex->families[family].parent = family;
+    pokedex->families[family].size = 1;
+    pokedex->families[family].version = 0;
+    pokedex->families_used++;
+    node->family = family;
+}
+
+// Join the families of a and b, under the root of the larger one,
+// and mark the cached roots and depths of the joined family out of
+// date.
+static void union_families(Pokedex pokedex, struct pokenode *a,
+    struct pokenode *b) {
+
+    new_family(pokedex, a);
+    new_family(pokedex, b);
+    int x = find_family(pokedex, a);
+    int y = find_family(pokedex, b);
+    if (x != y) {
+        struct family *families = pokedex->families;
+        if (families[x].size < families[y].size) {
+            int swap = x;
+            x = y;
+            y = swap;
+        }
+        families[y].parent = x;
+        families[x].size += families[y].size;
+    }
+    change_graph(pokedex, a);
+}
+
+// Drop the union-find entry of a node being removed, which nothing
+// evolves into or out of any more. Other entries may still lead
+// through it, so it is only counted as dead, and once there are more
+// dead entries than nodes the union-find is made again, which takes
+// time proportional to the size of the Pokedex at most once for
+// every node removed after being linked.
+static void forget_family(Pokedex pokedex, struct pokenode *node) {
+    if (node->family < 0) {
+        return;
+    }
+
+    node->family = -1;
+    pokedex->dead_families++;
+    if (pokedex->dead_families > pokedex->data->total) {
+        rebuild_families(pokedex);
+    }
+}
+
+// Make the union-find again from the evolutions in Pokedex,
+// leaving out the entries of removed nodes, and splitting any
+// families that unlinking has left joined.
+static void rebuild_families(Pokedex pokedex) {
+    pokedex->families_used = 0;
+    pokedex->dead_families = 0;
+
+    struct pokenode *curr = pokedex->head;
+    while (curr != NULL) {
+        curr->family = -1;
+        curr = curr->next;
+    }
+
+    curr = pokedex->head;
+    while (curr != NULL) {
+        if (curr->evolve != NULL) {
+            union_families(pokedex, curr, curr->evolve);
+        }
+        STATS_VISIT(1);
+        curr = curr->next;
+    }
+}
+
+// Return the final form of node: where following its evolutions ends.
+// The root and depth found are cached in every node on the way, so
+// until the evolutions change each node is only walked over once.
+static struct pokenode *evolution_root(Pokedex pokedex,
+    struct pokenode *node) {
+
+    // Every node that node evolves into is in the same family.
+    int family = find_family(pokedex, node);
+    if (family < 0) {
+        node->root = node;
+        node->depth = 0;
+        return node;
+    }
+
+    unsigned int version = pokedex->families[family].version;
+    struct pokenode *curr = node;
+    int steps = 0;
+    while (curr->stamp != version && curr->evolve != NULL) {
+        curr = curr->evolve;
+        steps++;
+        STATS_VISIT(1);
+    }
+    if (curr->stamp != version) {
+        curr->root = curr;
+        curr->depth = 0;
+        curr->stamp = version;
+    }
+
+    struct pokenode *root = curr->root;
+    int depth = curr->depth + steps;
+    curr = node;
+    while (steps > 0) {
+        curr->root = root;
+        curr->depth = depth;
+        curr->stamp = version;
+        curr = curr->evolve;
+        depth--;
+        steps--;
+    }
+    return root;
+}
+
+// Mark the cached roots and depths of the family of node out of date,
+// by giving its union-find root the next graph_version.
+// If the version wraps around, every stamp is cleared and every
+// family version reset first, so an old stamp can never look current.
+static void change_graph(Pokedex pokedex, struct pokenode *node) {
+    int family = find_family(pokedex, node);
+    if (family < 0) {
+        return;
+    }
+
+    if (pokedex->graph_version == UINT_MAX) {
+        struct pokenode *curr = pokedex->head;
+        while (curr != NULL) {
+            curr->stamp = 0;
+            curr = curr->next;
+        }
+        int i = 0;
+        while (i < pokedex->families_used) {
+            pokedex->families[i].version = 1;
+            i++;
+        }
+        pokedex->graph_version = 1;
+    }
+    pokedex->graph_version++;
+    pokedex->families[family].version = pokedex->graph_version;
+}
+
+// Print root, then the tree of Pokemon that evolve into it,
+// each on its own line indented by its depth below root,
+// in a single pass over the tree.
+static void print_family(Pokedex pokedex, struct pokenode *root) {
+    struct node_list stack;
+    init_node_list(&stack);
+
+    int family = find_family(pokedex, root);
+
+    root->depth = 0;
+    push_node(&stack, root);
+    while (stack.size > 0) {
+        stack.size--;
+        struct pokenode *node = stack.nodes[stack.size];
+        STATS_VISIT(1);
+
+        int indent = 0;
+        while (indent < node->depth) {
+            out_printf("    ");
+            indent++;
+        }
+        if (node != root) {
+            out_printf("<-- ");
+        }
+        print_evolution_entry(node);
+        out_printf("\n");
+
+        // Caching as we go: every node here has the same root.
+        if (family >= 0) {
+            node->root = root;
+            node->stamp = pokedex->families[family].version;
+        }
+
+        struct pokenode *child = node->evolves_from;
+        while (child != NULL) {
+            child->depth = node->depth + 1;
+            push_node(&stack, child);
+            child = child->next_from;
+        }
+    }
+
+    free(stack.nodes);
+}
+
+// Record new_node in the id index of Pokedex.
+static void index_node(struct pokenode *new_node, Pokedex pokedex);
+
+// Print the evolution of current Pokemon.
+static void print_evolution(struct pokenode *node);
+
+// Insert new pokenode into the end of Pokedex.
+static void insert_end_node(struct pokenode *new_node, Pokedex pokedex);
+
+// Sort the nodes in list by pokemon_id.
+static void sort_nodes_by_id(struct node_list *list);
+
+// Helper function
+// Determine if the name in a row of the columns contains text.
+static int row_contains(Columns columns, int row, char *text, int text_length);
 
 // Search for Pokemon with this ID in pokedex.
 static void check_exist_pokemon(int id, Pokedex pokedex);
 
 // Helper function
 // When Pokemon is removed, 
-// This function will adjuest found numbers.
+// This function will adjuest found numbers and type counts.
 static void remove_count_number(Pokedex pokedex, struct pokenode *n);
 
+// Set every count of data to 0, with no types.
+static void clear_pokedata(struct pokedata *data);
+
+// Count the types of a node just put at the end of Pokedex,
+// and count them as found if it is.
+static void count_types(Pokedex pokedex, struct pokenode *node);
+
+// Count one more Pokemon of type, in node.
+static void add_type_count(struct pokedata *data, int type,
+    struct pokenode *node);
+
+// Count one less Pokemon of type, as node is removed.
+static void remove_type_count(struct pokedata *data, int type,
+    struct pokenode *node);
+
+// Count the types of node as found (or not, for a change of -1).
+static void count_found_types(Pokedex pokedex, struct pokenode *node,
+    int change);
+
+// When Pokemon is removed, 
+// this function will remove its row from the columns.
+static void remove_row(Pokedex pokedex, struct pokenode *n);
+
 // Creates a new Pokedex, and returns a pointer to it.
 Pokedex new_pokedex(void) {
+    Pokedex pokedex = new_empty_pokedex();
+    pokedex->index = new_id_index();
+    own_memory(pokedex);
+
+    return pokedex;
+}
+
+// Create a Pokedex with an empty pokedata,
+// but no index or pools yet.
+static Pokedex new_empty_pokedex(void) {
     // Malloc memory for a new Pokedex, and check that the memory
     // allocation succeeded.
     Pokedex pokedex = malloc(sizeof(struct pokedex));
     assert(pokedex != NULL);
+    STATS_ALLOC(sizeof(struct pokedex));
 
     // Set the head of the linked list to be NULL.
     // (i.e. set the Pokedex to be empty)
@@ -125,38 +670,443 @@ Pokedex new_pokedex(void) {
     pokedex->end = NULL;
     pokedex->current = NULL;
     pokedex->next = NULL;
+    pokedex->index = NULL;
+    pokedex->node_pool = NULL;
+    pokedex->pokemon_pool = NULL;
+    pokedex->view_nodes = NULL;
+    pokedex->columns = NULL;
+    pokedex->trigrams = NULL;
+    pokedex->snapshot = NULL;
+    pokedex->journal = NULL;
+    pokedex->families = NULL;
+    pokedex->families_used = 0;
+    pokedex->families_capacity = 0;
+    pokedex->dead_families = 0;
+    pokedex->graph_version = 1;
     
     struct pokedata *data = malloc(sizeof(struct pokedata));
     assert(data != NULL);
+    STATS_ALLOC(sizeof(struct pokedata));
     pokedex->data = data;
-    pokedex->data->total = 0;
-    pokedex->data->found_nums = 0;
-    clean_array(pokedex->data->type_record);
+    clear_pokedata(pokedex->data);
 
     return pokedex;
 }
 
-// Create a new pokenode struct and returns a pointer to it.
-static struct pokenode *new_pokenode(Pokemon pokemon) {
+// Create a new Pokedex holding a copy of every Pokemon in Pokedex,
+// with the same found status, evolutions and current Pokemon.
+// The copy does not borrow anything from Pokedex.
+Pokedex copy_pokedex(Pokedex pokedex) {
+    Pokedex copy = new_pokedex();
+
+    struct pokenode *curr = pokedex->head;
+    while (curr != NULL) {
+        append_pokemon(copy,
+            pool_clone_pokemon(copy->pokemon_pool, curr->pokemon));
+        if (curr->status == FOUND) {
+            set_found(copy, copy->end);
+        }
+        STATS_VISIT(1);
+        curr = curr->next;
+    }
 
-    struct pokenode *new = malloc(sizeof(struct pokenode));
-    assert(new != NULL);
+    // Evolutions can point forwards, so link them once every
+    // Pokemon has been copied.
+    curr = pokedex->head;
+    struct pokenode *copy_node = copy->head;
+    while (curr != NULL) {
+        if (curr->evolve != NULL) {
+            link_evolution(copy, copy_node, set_evolution(copy,
+                pokemon_id(curr->evolve->pokemon)));
+        }
+        if (curr == pokedex->current) {
+            copy->current = copy_node;
+        }
+        STATS_VISIT(1);
+        curr = curr->next;
+        copy_node = copy_node->next;
+    }
+
+    return copy;
+}
+
+// Save the Pokedex to a snapshot file at `path`.
+// Returns 1 if it was saved, or 0 (after printing why) if not.
+int save_pokedex(Pokedex pokedex, char *path) {
+    SnapshotWriter writer = new_snapshot_writer();
+
+    uint32_t current = NO_CURRENT_RECORD;
+    uint32_t position = 0;
+    struct pokenode *curr = pokedex->head;
+    while (curr != NULL) {
+        struct snapshot_record record;
+        record.id = pokemon_id(curr->pokemon);
+        record.type1 = pokemon_first_type(curr->pokemon);
+        record.type2 = pokemon_second_type(curr->pokemon);
+        record.height = pokemon_height(curr->pokemon);
+        record.weight = pokemon_weight(curr->pokemon);
+        snapshot_add_record(writer, record, pokemon_name(curr->pokemon),
+            curr->status == FOUND);
+        if (curr->evolve != NULL) {
+            snapshot_add_edge(writer, record.id,
+                pokemon_id(curr->evolve->pokemon));
+        }
+        if (curr == pokedex->current) {
+            current = position;
+        }
+        STATS_VISIT(1);
+        position++;
+        curr = curr->next;
+    }
+
+    return finish_snapshot(writer, path, current);
+}
+
+// Replace the contents of the Pokedex with the snapshot at `path`.
+// The file is mapped rather than read: the nodes are made straight
+// from its fixed-width records, and the names stay in the mapping
+// until the Pokedex is destroyed or loaded again.
+// map_snapshot has checked every record, so nothing below can fail,
+// and the ids are known to be distinct, so like a view
+// the Pokedex only builds its id index when it is first needed,
+// which is straight away if the snapshot has evolutions.
+// Returns 1 if it was loaded, or 0 (after printing why) if not,
+// in which case the Pokedex is unchanged.
+int load_pokedex(Pokedex pokedex, char *path) {
+    Snapshot snapshot = map_snapshot(path);
+    if (snapshot == NULL) {
+        return FALSE;
+    }
+
+    // The journal can only go on from a snapshot of what is loaded,
+    // which is this snapshot, so it is checkpointed with a copy of it
+    // before anything changes.
+    if (pokedex->journal != NULL) {
+        char checkpoint_path[JOURNAL_PATH_MAX];
+        journal_snapshot_path(pokedex->journal,
+            journal_generation(pokedex->journal) + 1, checkpoint_path);
+        if (!copy_snapshot(snapshot, checkpoint_path)
+                || !journal_restart(pokedex->journal)) {
+            unmap_snapshot(snapshot);
+            return FALSE;
+        }
+    }
+
+    clear_pokedex(pokedex);
+    pokedex->snapshot = snapshot;
+
+    const struct snapshot_header *header = snapshot->header;
+    uint32_t i = 0;
+    while (i < header->count) {
+        const struct snapshot_record *record = &snapshot->records[i];
+        struct pokenode *node = new_pokenode(pool_new_pokemon_borrowed_name(
+            pokedex->pokemon_pool, record->id,
+            (char *) &snapshot->names[record->name],
+            record->height, record->weight,
+            record->type1, record->type2), pokedex);
+        node->memory = SNAPSHOT_NAME;
+        if (column_bit(snapshot->found, i)) {
+            node->status = FOUND;
+            pokedex->data->found_nums++;
+        }
+        if (i == header->current) {
+            pokedex->current = node;
+        }
+
+        if (pokedex->end == NULL) {
+            pokedex->head = node;
+            pokedex->end = node;
+            pokedex->data->total++;
+        } else {
+            insert_end_node(node, pokedex);
+        }
+        count_types(pokedex, node);
+        STATS_VISIT(1);
+        i++;
+    }
+
+    i = 0;
+    while (i < header->edge_count) {
+        struct pokenode *from = set_evolution(pokedex, snapshot->edges[i].from);
+        struct pokenode *to = set_evolution(pokedex, snapshot->edges[i].to);
+        if (from != NULL && to != NULL && from != to
+                && !makes_cycle(pokedex, from, to)) {
+            link_evolution(pokedex, from, to);
+        }
+        i++;
+    }
+
+    return TURE;
+}
+
+// Recover the Pokedex from the snapshot of the journal's generation
+// and the records after it, then keep the journal up to date.
+// Replaying a removal moves the current Pokemon only if it is the
+// one removed, so recovery leaves it where the snapshot had it.
+int open_pokedex_journal(Pokedex pokedex, char *path, int commit_interval) {
+    Journal journal = open_journal(path, commit_interval);
+    if (journal == NULL) {
+        return FALSE;
+    }
+
+    if (journal_generation(journal) > 0) {
+        char snapshot_path[JOURNAL_PATH_MAX];
+        journal_snapshot_path(journal, journal_generation(journal),
+            snapshot_path);
+        if (!load_pokedex(pokedex, snapshot_path)) {
+            close_journal(journal);
+            return FALSE;
+        }
+    }
+
+    struct journal_record record;
+    while (next_journal_record(journal, &record)) {
+        if (record.kind == JOURNAL_ADD) {
+            add_new_pokemon(pokedex, record.pokemon_id, record.name,
+                record.height, record.weight, record.type1, record.type2);
+        } else if (record.kind == JOURNAL_EVOLVE) {
+            add_pokemon_evolution(pokedex, record.pokemon_id, record.to_id);
+        } else {
+            struct pokenode *node = set_evolution(pokedex, record.pokemon_id);
+            if (node != NULL && record.kind == JOURNAL_FIND) {
+                set_found(pokedex, node);
+            } else if (node != NULL && record.kind == JOURNAL_REMOVE) {
+                struct pokenode *current = pokedex->current;
+                pokedex->current = node;
+                remove_pokemon(pokedex);
+                if (current != node) {
+                    pokedex->current = current;
+                }
+            }
+        }
+        STATS_VISIT(1);
+    }
+
+    pokedex->journal = journal;
+    return TURE;
+}
+
+// Save a snapshot for the next generation of the journal,
+// and start that generation with an empty journal.
+int checkpoint_pokedex(Pokedex pokedex) {
+    if (pokedex->journal == NULL) {
+        fprintf(stderr, "This Pokedex has no journal\n");
+        return FALSE;
+    }
+
+    char path[JOURNAL_PATH_MAX];
+    journal_snapshot_path(pokedex->journal,
+        journal_generation(pokedex->journal) + 1, path);
+    return save_pokedex(pokedex, path) && journal_restart(pokedex->journal);
+}
+
+// Empty Pokedex, leaving it with its own pools but no index yet,
+// so the index is built from the list the first time it is needed.
+static void clear_pokedex(Pokedex pokedex) {
+    free_contents(pokedex);
+
+    pokedex->head = NULL;
+    pokedex->end = NULL;
+    pokedex->current = NULL;
+    pokedex->index = NULL;
+    pokedex->node_pool = NULL;
+    pokedex->pokemon_pool = NULL;
+    pokedex->view_nodes = NULL;
+    pokedex->columns = NULL;
+    pokedex->trigrams = NULL;
+    pokedex->snapshot = NULL;
+    pokedex->families = NULL;
+    pokedex->families_used = 0;
+    pokedex->families_capacity = 0;
+    pokedex->dead_families = 0;
+    clear_pokedata(pokedex->data);
+
+    own_memory(pokedex);
+}
+
+// Create a new pokenode struct in the node pool of Pokedex
+// and returns a pointer to it.
+static struct pokenode *new_pokenode(Pokemon pokemon, Pokedex pokedex) {
+
+    struct pokenode *new = pool_alloc(pokedex->node_pool);
     new->pokemon = pokemon;
     new->next = NULL;
     new->prev = NULL;
-    new->evolve = NULL;
+    init_evolutions(new);
     new->status = NOT_FOUND;
+    new->memory = OWN_MEMORY;
+    new->row = -1;
 
     return new;
 }
 
+// Give a pokenode and its Pokemon back to the pools of Pokedex.
+// A view node belongs to the view block,
+// and its Pokemon to the original Pokedex, so neither is freed here.
+// A SNAPSHOT_NAME Pokemon's name belongs to the snapshot mapping.
+static void destroy_pokenode(struct pokenode *node, Pokedex pokedex) {
+    if (node->memory == VIEW_MEMORY) {
+        return;
+    }
+    if (node->memory == SNAPSHOT_NAME) {
+        pool_destroy_pokemon_borrowed_name(pokedex->pokemon_pool,
+            node->pokemon);
+    } else {
+        pool_destroy_pokemon(pokedex->pokemon_pool, node->pokemon);
+    }
+    pool_release(pokedex->node_pool, node);
+}
+
+// Make sure the Pokedex has pools to hold Pokemon of its own.
+// A view only gets them when a Pokemon is first added to it.
+static void own_memory(Pokedex pokedex) {
+    if (pokedex->node_pool == NULL) {
+        pokedex->node_pool = new_pool(sizeof(struct pokenode));
+        pokedex->pokemon_pool = new_pokemon_pool();
+    }
+}
+
+// Return the id index of Pokedex.
+// A view, or a loaded Pokedex, builds its index from its list
+// the first time it is needed.
+static IdIndex get_index(Pokedex pokedex) {
+    if (pokedex->index == NULL) {
+        pokedex->index = new_id_index();
+        id_index_reserve(pokedex->index, pokedex->data->total);
+        struct pokenode *curr = pokedex->head;
+        while (curr != NULL) {
+            index_node(curr, pokedex);
+            STATS_VISIT(1);
+            curr = curr->next;
+        }
+    }
+    return pokedex->index;
+}
+
+// Return the columns of Pokedex.
+// They are built from the list the first time a scan needs them,
+// and again after removals have left too many dead rows.
+static Columns get_columns(Pokedex pokedex) {
+    if (pokedex->columns == NULL) {
+        pokedex->columns = new_columns();
+        struct pokenode *curr = pokedex->head;
+        while (curr != NULL) {
+            curr->row = columns_append(pokedex->columns, curr->pokemon,
+                curr->status == FOUND, curr);
+            STATS_VISIT(1);
+            curr = curr->next;
+        }
+    }
+    return pokedex->columns;
+}
+
+// Return the trigram index over the rows of the columns of Pokedex,
+// building it the first time it is needed.
+// Removed rows are left in the index; searches skip them.
+static TrigramIndex get_trigrams(Pokedex pokedex) {
+    Columns columns = get_columns(pokedex);
+    if (pokedex->trigrams == NULL) {
+        pokedex->trigrams = new_trigram_index();
+        int row = 0;
+        while (row < columns->rows) {
+            if (column_bit(columns->live, row)) {
+                trigram_index_add(pokedex->trigrams, row,
+                    columns_name(columns, row));
+            }
+            STATS_VISIT(1);
+            row++;
+        }
+    }
+    return pokedex->trigrams;
+}
+
+// Set node in Pokedex to be found,
+// updating the found count and columns.
+static void set_found(Pokedex pokedex, struct pokenode *node) {
+    if (node->status == NOT_FOUND) {
+        pokedex->data->found_nums++;
+        count_found_types(pokedex, node, 1);
+        if (pokedex->columns != NULL) {
+            columns_set_found(pokedex->columns, node->row);
+        }
+        if (pokedex->journal != NULL) {
+            journal_find(pokedex->journal, pokemon_id(node->pokemon));
+        }
+    }
+    node->status = FOUND;
+}
+
 // Add a new Pokemon to the Pokedex.
+// The Pokemon is moved into the memory of the Pokedex,
+// so `pokemon` itself is destroyed.
 void add_pokemon(Pokedex pokedex, Pokemon pokemon) {
 
+    own_memory(pokedex);
+    Pokemon moved = pool_clone_pokemon(pokedex->pokemon_pool, pokemon);
+    destroy_pokemon(pokemon);
+    append_pokemon(pokedex, moved);
+
+}
+
+// Create a new Pokemon in the memory of the Pokedex,
+// and add it to the Pokedex.
+void add_new_pokemon(Pokedex pokedex, int pokemon_id, char *name,
+    double height, double weight, pokemon_type type1, pokemon_type type2) {
+
+    own_memory(pokedex);
+    append_pokemon(pokedex, pool_new_pokemon(pokedex->pokemon_pool,
+        pokemon_id, name, height, weight, type1, type2));
+
+}
+
+// Add the rows of an import file to the end of the Pokedex.
+// They come out of the ImportFile in id order, so a duplicate is
+// always found in the index, either from before the import or from
+// the first row with its id.
+int import_pokemon(Pokedex pokedex, char *path, int threads,
+    struct import_report *report) {
+
+    ImportFile file = read_import_file(path, threads, report);
+    if (file == NULL) {
+        return FALSE;
+    }
+
+    own_memory(pokedex);
+    IdIndex index = get_index(pokedex);
+    id_index_reserve(index, id_index_size(index) + report->rows);
+
+    struct import_row row;
+    while (next_import_row(file, &row)) {
+        if (id_index_get(index, row.pokemon_id) != NULL) {
+            import_report_duplicate(report, &row);
+        } else {
+            append_pokemon(pokedex, pool_new_pokemon(pokedex->pokemon_pool,
+                row.pokemon_id, row.name, row.height, row.weight,
+                row.type1, row.type2));
+            report->added++;
+        }
+    }
+
+    close_import_file(file);
+    return TURE;
+}
+
+// Add a Pokemon made in the pool of Pokedex to the end of Pokedex.
+static void append_pokemon(Pokedex pokedex, Pokemon pokemon) {
+
     int add_id = pokemon_id(pokemon);
     check_exist_pokemon(add_id, pokedex);
 
-    struct pokenode *new_node = new_pokenode(pokemon);
+    struct pokenode *new_node = new_pokenode(pokemon, pokedex);
+    index_node(new_node, pokedex);
+    if (pokedex->columns != NULL) {
+        new_node->row = columns_append(pokedex->columns, pokemon,
+            FALSE, new_node);
+    }
+    if (pokedex->trigrams != NULL) {
+        trigram_index_add(pokedex->trigrams, new_node->row,
+            pokemon_name(pokemon));
+    }
 
     if (pokedex->end == NULL) {
         // pokenode is empty
@@ -172,6 +1122,13 @@ void add_pokemon(Pokedex pokedex, Pokemon pokemon) {
         insert_end_node(new_node, pokedex);
 
     }
+    count_types(pokedex, new_node);
+
+    if (pokedex->journal != NULL) {
+        journal_add(pokedex->journal, add_id, pokemon_name(pokemon),
+            pokemon_height(pokemon), pokemon_weight(pokemon),
+            pokemon_first_type(pokemon), pokemon_second_type(pokemon));
+    }
 
 }
 
@@ -184,19 +1141,22 @@ void detail_pokemon(Pokedex pokedex) {
     
     struct pokenode *curr= pokedex->current;
 
-    int name_length = get_string_length(pokemon_name(curr->pokemon));
-
-    printf("ID: %03d\n", pokemon_id(curr->pokemon));
+    out_write("ID: ", 4);
+    out_padded_int(pokemon_id(curr->pokemon), 3);
+    out_char('\n');
     if (curr->status == NOT_FOUND) {
-        printf("Name: ");
-        print_unfound_name(name_length);
-        printf("Height: --\n");
-        printf("Weight: --\n");
-        printf("Type: --\n");
+        out_write("Name: ", 6);
+        print_unfound_name(get_string_length(pokemon_name(curr->pokemon)));
+        out_write("Height: --\nWeight: --\nType: --\n", 31);
     } else {
-        printf("Name: %s\n", pokemon_name(curr->pokemon));
-        printf("Height: %.1lfm\n", pokemon_height(curr->pokemon));
-        printf("Weight: %.1lfkg\n", pokemon_weight(curr->pokemon));
+        char *name = pokemon_name(curr->pokemon);
+        out_write("Name: ", 6);
+        out_write(name, strlen(name));
+        out_write("\nHeight: ", 9);
+        out_fixed1(pokemon_height(curr->pokemon));
+        out_write("m\nWeight: ", 10);
+        out_fixed1(pokemon_weight(curr->pokemon));
+        out_write("kg\nType: ", 9);
 
         int type1 = pokemon_first_type(curr->pokemon);
         int type2 = pokemon_second_type(curr->pokemon);
@@ -204,13 +1164,12 @@ void detail_pokemon(Pokedex pokedex) {
         const char *type1_string = pokemon_type_to_string(type1);
         const char *type2_string = pokemon_type_to_string(type2);
 
-        printf("Type: %s ", type1_string);
-
+        out_write(type1_string, strlen(type1_string));
+        out_char(' ');
         if (type2 != 0) {
-            printf("%s\n", type2_string);
-        } else {
-            printf("\n");
+            out_write(type2_string, strlen(type2_string));
         }
+        out_char('\n');
 
     }
     
@@ -230,10 +1189,10 @@ Pokemon get_current_pokemon(Pokedex pokedex) {
 // Sets the currently selected Pokemon to be 'found'.
 void find_current_pokemon(Pokedex pokedex) {
 
-    if (pokedex->current->status == NOT_FOUND) {
-        pokedex->data->found_nums++;
+    if (pokedex->current == NULL) {
+        return;
     }
-    pokedex->current->status = FOUND;
+    set_found(pokedex, pokedex->current);
 
 }
 
@@ -241,35 +1200,88 @@ void find_current_pokemon(Pokedex pokedex) {
 void print_pokemon(Pokedex pokedex) {
 
     struct pokenode *curr = pokedex->head;
-    
-
     while (curr != NULL) {
-        int name_length = get_string_length(pokemon_name(curr->pokemon));
-        if (curr->pokemon == get_current_pokemon(pokedex)) {
-            printf("--> ");
-            printf("#%03d: ", pokemon_id(curr->pokemon));
-            if (curr->status == NOT_FOUND) {
-                print_unfound_name(name_length);
-            } else {
-                printf("%s\n", pokemon_name(curr->pokemon));
-            }
-        } else {
-            if (curr->status == NOT_FOUND) {
-                printf("    #%03d: ", pokemon_id(curr->pokemon));
-                print_unfound_name(name_length);
-            } else {
-                printf(
-                    "    #%03d: %s\n", 
-                    pokemon_id(curr->pokemon), 
-                    pokemon_name(curr->pokemon)
-                );
-            }
-        }
+        print_pokemon_line(curr, curr == pokedex->current);
+        STATS_VISIT(1);
+        curr = curr->next;
+    }
+
+}
+
+// Print at most `limit` Pokemon from the one at `position`.
+// The first is found through the positions of the columns,
+// and the rest by following the list.
+void print_pokemon_page(Pokedex pokedex, int position, int limit) {
+
+    if (position < 0 || limit <= 0 || position >= pokedex->data->total) {
+        return;
+    }
+
+    Columns columns = get_columns(pokedex);
+    struct pokenode *curr = columns->node[columns_row_at(columns, position)];
+    int printed = 0;
+    while (curr != NULL && printed < limit) {
+        print_pokemon_line(curr, curr == pokedex->current);
+        STATS_VISIT(1);
+        printed++;
+        curr = curr->next;
+    }
+
+}
+
+// Print the Pokemon from the one with ID from_id to the one with ID
+// to_id, in the order they were added.
+void print_pokemon_between(Pokedex pokedex, int from_id, int to_id) {
+
+    IdIndex index = get_index(pokedex);
+    struct pokenode *first = id_index_get(index, from_id);
+    struct pokenode *last = id_index_get(index, to_id);
+    if (first == NULL || last == NULL) {
+        return;
+    }
+
+    // Rows are in the order the Pokemon were added,
+    // once the columns have given every node one.
+    get_columns(pokedex);
+    if (first->row > last->row) {
+        struct pokenode *swap = first;
+        first = last;
+        last = swap;
+    }
+
+    struct pokenode *curr = first;
+    while (curr != last->next) {
+        print_pokemon_line(curr, curr == pokedex->current);
+        STATS_VISIT(1);
         curr = curr->next;
     }
 
 }
 
+// Change the currently selected Pokemon to the one at `position`.
+void change_current_position(Pokedex pokedex, int position) {
+
+    if (position < 0 || position >= pokedex->data->total) {
+        return;
+    }
+
+    Columns columns = get_columns(pokedex);
+    pokedex->current = columns->node[columns_row_at(columns, position)];
+
+}
+
+// Return the position of the currently selected Pokemon.
+int get_current_position(Pokedex pokedex) {
+
+    if (pokedex->current == NULL) {
+        return -1;
+    }
+
+    Columns columns = get_columns(pokedex);
+    return columns_position(columns, pokedex->current->row);
+
+}
+
 // Change the currently selected Pokemon to be the next Pokemon in the Pokedex.
 void next_pokemon(Pokedex pokedex) {
 
@@ -309,16 +1321,17 @@ void prev_pokemon(Pokedex pokedex) {
 // Change the currently selected Pokemon to be the Pokemon with the ID `id`.
 void change_current_pokemon(Pokedex pokedex, int id) {
 
-    struct pokenode *curr_node = pokedex->head;
-    while (curr_node != NULL) {
-        if (pokemon_id(curr_node->pokemon) == id) {
-            pokedex->current = curr_node;
-        }
-        curr_node = curr_node->next;
+    struct pokenode *curr_node = id_index_get(get_index(pokedex), id);
+    if (curr_node != NULL) {
+        pokedex->current = curr_node;
     }
     
 }
 
+int has_pokemon(Pokedex pokedex, int id) {
+    return id_index_get(get_index(pokedex), id) != NULL;
+}
+
 // Remove the currently selected Pokemon from the Pokedex.
 void remove_pokemon(Pokedex pokedex) {
 
@@ -329,12 +1342,17 @@ void remove_pokemon(Pokedex pokedex) {
 
     struct pokenode *remove_node = pokedex->current;
     struct pokenode *end_node = pokedex->end;
+    if (pokedex->journal != NULL) {
+        journal_remove(pokedex->journal, pokemon_id(remove_node->pokemon));
+    }
+    id_index_remove(get_index(pokedex), pokemon_id(remove_node->pokemon));
+    remove_row(pokedex, remove_node);
+    detach_evolutions(pokedex, remove_node);
 
     if (remove_node->next == NULL && remove_node->prev == NULL) {
         // pokendoe has only one node
         remove_count_number(pokedex, remove_node);
-        destroy_pokemon(remove_node->pokemon);
-        free(remove_node);
+        destroy_pokenode(remove_node, pokedex);
         pokedex->end = NULL;
         pokedex->head = NULL;
         pokedex->current = NULL;
@@ -366,78 +1384,115 @@ void remove_pokemon(Pokedex pokedex) {
 
     }
     remove_count_number(pokedex, remove_node);
-    destroy_pokemon(remove_node->pokemon);
-    free(remove_node);
+    destroy_pokenode(remove_node, pokedex);
     pokedex->data->total--;
 }
 
 // Destroy the given Pokedex and free all associated memory.
 void destroy_pokedex(Pokedex pokedex) {
 
-    struct pokenode *curr = pokedex->head;
-
-    while (curr != NULL) {
-
-        struct pokenode *remove = curr;
-        curr = curr->next;
-        destroy_pokemon(remove->pokemon);
-        free(remove);
-
+    if (pokedex->journal != NULL) {
+        close_journal(pokedex->journal);
     }
-
+    free_contents(pokedex);
     free(pokedex->data);
     free(pokedex);
     pokedex = NULL;
 
 }
 
-// Print out all of the different types of Pokemon in the Pokedex.
-void show_types(Pokedex pokedex) {
+// Free every Pokemon in Pokedex, and everything built over them.
+// Every node and Pokemon lives in the pools, or in the view block,
+// so they are freed in bulk with them.
+static void free_contents(Pokedex pokedex) {
 
-    struct pokenode *curr = pokedex->head;
-    
-    while (curr != NULL) {
+    if (pokedex->node_pool != NULL) {
+        destroy_pool(pokedex->node_pool);
+        destroy_pool(pokedex->pokemon_pool);
+    }
+    if (pokedex->index != NULL) {
+        destroy_id_index(pokedex->index);
+    }
+    if (pokedex->columns != NULL) {
+        destroy_columns(pokedex->columns);
+    }
+    if (pokedex->trigrams != NULL) {
+        destroy_trigram_index(pokedex->trigrams);
+    }
+    if (pokedex->snapshot != NULL) {
+        unmap_snapshot(pokedex->snapshot);
+    }
+    free(pokedex->view_nodes);
+    free(pokedex->families);
 
-        int type1 = pokemon_first_type(curr->pokemon);
-        int type2 = pokemon_second_type(curr->pokemon);
+}
+
+// Print out all of the different types of Pokemon in the Pokedex.
+// Types are printed in the order they first appear in the Pokedex,
+// which is kept as Pokemon are added and removed. If a removal has
+// left it stale, it is found again from the first row set in each
+// type's bitmap.
+void show_types(Pokedex pokedex) {
 
-        type_record(pokedex->data->type_record,type1);
-        type_record(pokedex->data->type_record,type2);
+    struct pokedata *data = pokedex->data;
+    if (data->types_stale) {
+        Columns columns = get_columns(pokedex);
+        int first_rows[MAX_TYPE];
+        columns_first_rows(columns, NULL, ALL_TYPES, first_rows);
+
+        int keys[MAX_TYPE];
+        keys[NONE_TYPE] = -1;
+        int type = NONE_TYPE + 1;
+        while (type < MAX_TYPE) {
+            int row = first_rows[type];
+            keys[type] = -1;
+            data->type_first[type] = NULL;
+            if (row >= 0) {
+                // A Pokemon's first type comes before its second type.
+                keys[type] = 2 * row + (columns->type1[row] != type);
+                data->type_first[type] = columns->node[row];
+            }
+            type++;
+        }
 
-        curr = curr->next;
+        clean_array(data->type_record);
+        order_types(data->type_record, keys);
+        data->types_stale = FALSE;
     }
-    print_type_array(pokedex->data->type_record);
-    clean_array(pokedex->data->type_record);
+    print_type_array(data->type_record);
 
 }
 
 // Set the first not-yet-found Pokemon of each type to be found.
+// Every first row is looked up before any is marked found,
+// since a Pokemon can be the first unfound of both its types.
+// Types whose Pokemon are all found are not scanned for, so once
+// every type is found this scans nothing.
 void go_exploring(Pokedex pokedex) {
 
-    struct pokenode *curr = pokedex->head;
-    struct pokenode *origin_current = pokedex->current;
-
-    while (curr != NULL) {
-        pokedex->current = curr;
-        if (curr->status == NOT_FOUND) {
-
-            int type1 = pokemon_first_type(curr->pokemon);
-            int type2 = pokemon_second_type(curr->pokemon);
-
-
-            int type1_exploring = type_exploring(pokedex->data->type_record, type1);
-            int type2_exploring = type_exploring(pokedex->data->type_record, type2);
+    unsigned int types = 0;
+    int type = NONE_TYPE + 1;
+    while (type < MAX_TYPE) {
+        if (pokedex->data->type_found[type] < pokedex->data->type_total[type]) {
+            types |= 1u << type;
+        }
+        type++;
+    }
+    if (types == 0) {
+        return;
+    }
 
-            if (type1_exploring == TURE || type2_exploring == TURE) {
-                find_current_pokemon(pokedex);
-            }
+    Columns columns = get_columns(pokedex);
+    int first_rows[MAX_TYPE];
+    columns_first_rows(columns, columns->found, types, first_rows);
 
+    type = NONE_TYPE + 1;
+    while (type < MAX_TYPE) {
+        if (first_rows[type] >= 0) {
+            set_found(pokedex, columns->node[first_rows[type]]);
         }
-
-        curr = curr->next;
+        type++;
     }
-    pokedex->current = origin_current;
-    clean_array(pokedex->data->type_record);
 
 }
 
@@ -457,16 +1512,29 @@ int count_found_pokemon(Pokedex pokedex) {
 
 // Add the information that the Pokemon with the ID `from_id` can
 // evolve into the Pokemon with the ID `to_id`.
+// An evolution that would make a loop is invalid, like one from a
+// Pokemon to itself.
 void add_pokemon_evolution(Pokedex pokedex, int from_id, int to_id) {
     struct pokenode *from = set_evolution(pokedex, from_id);
     struct pokenode *to = set_evolution(pokedex, to_id);
-    if (from == NULL || to == NULL || from == to) {
+    if (from == NULL || to == NULL || from == to
+            || makes_cycle(pokedex, from, to)) {
         fprintf(stderr, "Invalid Pokemon Evolution!\n");
         exit(1);
     }
 
-    from->evolve = to;
+    link_evolution(pokedex, from, to);
+    if (pokedex->journal != NULL) {
+        journal_evolve(pokedex->journal, from_id, to_id);
+    }
+
+}
 
+int can_add_evolution(Pokedex pokedex, int from_id, int to_id) {
+    struct pokenode *from = set_evolution(pokedex, from_id);
+    struct pokenode *to = set_evolution(pokedex, to_id);
+    return from != NULL && to != NULL && from != to
+        && !makes_cycle(pokedex, from, to);
 }
 
 // Show the evolutions of the currently selected Pokemon.
@@ -481,11 +1549,36 @@ void show_evolutions(Pokedex pokedex) {
     while (curr != NULL) {
 
         print_evolution(curr);
+        STATS_VISIT(1);
 
         curr = curr->evolve;
     }
-    printf("\n");
+    out_printf("\n");
+
+}
+
+// Show the family of the currently selected Pokemon: its final form,
+// then every Pokemon that evolves into it, indented by how many
+// evolutions they are from the final form.
+void show_family(Pokedex pokedex) {
+    if (pokedex->current == NULL) {
+        return;
+    }
 
+    print_family(pokedex, evolution_root(pokedex, pokedex->current));
+}
+
+// Show every family of two or more Pokemon, as show_family does,
+// in the order their final forms were added.
+void show_all_chains(Pokedex pokedex) {
+    struct pokenode *curr = pokedex->head;
+    while (curr != NULL) {
+        if (curr->evolve == NULL && curr->evolves_from != NULL) {
+            print_family(pokedex, curr);
+        }
+        STATS_VISIT(1);
+        curr = curr->next;
+    }
 }
 
 // Return the pokemon_id of the Pokemon that the currently selected
@@ -509,136 +1602,315 @@ int get_next_evolution(Pokedex pokedex) {
 
 // Create a new Pokedex which contains only the Pokemon of a specified
 // type from the original Pokedex.
+// The new Pokedex is a view: it borrows the Pokemon of Pokedex.
 Pokedex get_pokemon_of_type(Pokedex pokedex, pokemon_type type) {
-    Pokedex type_pokedex = new_pokedex();
-    pokedex->next = type_pokedex;
+    struct node_list matches;
+    init_node_list(&matches);
+
+    // The type counts say when there is nothing to scan for.
+    if (pokedex->data->type_found[type] > 0) {
+        Columns columns = get_columns(pokedex);
+        collect_rows(&matches, columns, columns->type_bits[type],
+            columns->found);
+        STATS_VISIT(matches.size);
+    }
 
-    struct pokenode *curr = pokedex->head;
+    pokedex->next = new_view(&matches);
+    return pokedex->next;
 
-    while (curr != NULL) {
+}
 
-        if (curr->status == FOUND) {
+// Create a new Pokedex which contains only the Pokemon that have
+// previously been 'found' from the original Pokedex,
+// in order of pokemon_id.
+// The new Pokedex is a view: it borrows the Pokemon of Pokedex.
+Pokedex get_found_pokemon(Pokedex pokedex) {
+    struct node_list matches;
+    init_node_list(&matches);
+
+    if (pokedex->data->found_nums > 0) {
+        Columns columns = get_columns(pokedex);
+        collect_rows(&matches, columns, columns->live, columns->found);
+        STATS_VISIT(matches.size);
+    }
 
-            int type1 = pokemon_first_type(curr->pokemon);
-            int type2 = pokemon_second_type(curr->pokemon);
+    sort_nodes_by_id(&matches);
 
-            if (type1 == type || type2 == type) {
-                
-                transfer_pokemon(curr, pokedex);
+    pokedex->next = new_view(&matches);
+    return pokedex->next;
 
+}
+
+// Create a new Pokedex containing only the Pokemon from the original
+// Pokedex which have the given string appearing in its name.
+// The new Pokedex is a view: it borrows the Pokemon of Pokedex.
+// Texts of three or more characters only check the names holding
+// every trigram of the text; shorter texts check every found name.
+Pokedex search_pokemon(Pokedex pokedex, char *text) {
+    struct node_list matches;
+    init_node_list(&matches);
+
+    Columns columns = get_columns(pokedex);
+    int text_length = strlen(text);
+
+    if (text_length >= TRIGRAM_LENGTH) {
+        int *rows = NULL;
+        int size = trigram_index_candidates(get_trigrams(pokedex), text, &rows);
+
+        int i = 0;
+        while (i < size) {
+            int row = rows[i];
+            STATS_VISIT(1);
+            if (column_bit(columns->found, row)
+                    && row_contains(columns, row, text, text_length)) {
+                push_node(&matches, columns->node[row]);
             }
+            i++;
         }
 
-        curr = curr->next;
+        free(rows);
+        pokedex->next = new_view(&matches);
+        return pokedex->next;
     }
 
-    pokedex = pokedex->next;
-    pokedex->current = pokedex->head;
+    // Short texts match every name into a bitset on the scan threads.
+    int words = column_words(columns) + 1;
+    uint64_t *matched = malloc(words * sizeof(uint64_t));
+    assert(matched != NULL);
+    STATS_ALLOC(words * sizeof(uint64_t));
 
-    return pokedex;
+    int checked = columns_match_names(columns, columns->live,
+        columns->found, text, text_length, matched);
+    STATS_VISIT(checked);
+    collect_rows(&matches, columns, matched, NULL);
+    free(matched);
+
+    pokedex->next = new_view(&matches);
+    return pokedex->next;
 
 }
 
-// Create a new Pokedex which contains only the Pokemon that have
-// previously been 'found' from the original Pokedex.
-Pokedex get_found_pokemon(Pokedex pokedex) {
-    Pokedex found_pokedex = new_pokedex();
-    pokedex->next = found_pokedex;
+// Create a view Pokedex over the nodes in list, in order.
+// All of its nodes are made in a single block,
+// each borrowing the Pokemon of a node in list, and marked found.
+// The list is freed.
+static Pokedex new_view(struct node_list *list) {
+    Pokedex view = new_empty_pokedex();
+
+    if (list->size > 0) {
+        view->view_nodes = malloc(list->size * sizeof(struct pokenode));
+        assert(view->view_nodes != NULL);
+        STATS_ALLOC(list->size * sizeof(struct pokenode));
+    }
 
-    struct pokenode *curr = pokedex->head;
+    int i = 0;
+    while (i < list->size) {
+        struct pokenode *node = &view->view_nodes[i];
+        node->pokemon = list->nodes[i]->pokemon;
+        node->prev = i > 0 ? &view->view_nodes[i - 1] : NULL;
+        node->next = i + 1 < list->size ? &view->view_nodes[i + 1] : NULL;
+        init_evolutions(node);
+        node->status = FOUND;
+        node->memory = VIEW_MEMORY;
+        count_types(view, node);
+        STATS_VISIT(1);
+        i++;
+    }
 
-    while (curr != NULL) {
+    if (list->size > 0) {
+        view->head = &view->view_nodes[0];
+        view->end = &view->view_nodes[list->size - 1];
+    }
+    view->current = view->head;
+    view->data->total = list->size;
+    view->data->found_nums = list->size;
 
-        if (curr->status == FOUND) {
-            insert_order_pokemon(curr, pokedex->next);
-        }
+    free(list->nodes);
+    return view;
+}
 
-        curr = curr->next;
-    }
+// Set list to be empty.
+static void init_node_list(struct node_list *list) {
+    list->nodes = NULL;
+    list->size = 0;
+    list->capacity = 0;
+}
 
-    pokedex = pokedex->next;
-    set_all_found(pokedex);
-    pokedex->current = pokedex->head;
+// Add node to the end of list, growing it if it is full.
+static void push_node(struct node_list *list, struct pokenode *node) {
+    if (list->size == list->capacity) {
+        list->capacity = list->capacity == 0 ? 16 : list->capacity * 2;
+        list->nodes = realloc(list->nodes,
+            list->capacity * sizeof(struct pokenode *));
+        assert(list->nodes != NULL);
+        STATS_ALLOC(list->capacity * sizeof(struct pokenode *));
+    }
+    list->nodes[list->size] = node;
+    list->size++;
+}
 
-    return pokedex;
+// Set list to the nodes of the rows set in both `a` and `b`.
+// The rows are collected on the scan threads.
+static void collect_rows(struct node_list *list, Columns columns,
+    const uint64_t *a, const uint64_t *b) {
 
+    void **nodes = NULL;
+    list->size = columns_collect(columns, a, b, &nodes);
+    list->capacity = list->size;
+    list->nodes = (struct pokenode **) nodes;
 }
 
-// Create a new Pokedex containing only the Pokemon from the original
-// Pokedex which have the given string appearing in its name.
-Pokedex search_pokemon(Pokedex pokedex, char *text) {
-    Pokedex search_pokedex = new_pokedex();
-    pokedex->next = search_pokedex;
+// Sort the nodes in list by pokemon_id with an LSD radix sort.
+// Ids are non-negative ints, so they are sorted a byte at a time,
+// making only as many passes as the largest id needs.
+static void sort_nodes_by_id(struct node_list *list) {
+    int size = list->size;
+    if (size < 2) {
+        return;
+    }
 
-    struct pokenode *curr = pokedex->head;
+    struct sort_entry *entries = malloc(2 * size * sizeof(struct sort_entry));
+    assert(entries != NULL);
+    STATS_ALLOC(2 * size * sizeof(struct sort_entry));
+    struct sort_entry *from = entries;
+    struct sort_entry *to = entries + size;
 
-    while (curr != NULL) {
-        char *curr_name = pokemon_name(curr->pokemon);
-        
-        if ((compare_name(text, curr_name) == TURE) && curr->status == FOUND) {
-            transfer_pokemon(curr, pokedex);
+    unsigned int max_id = 0;
+    int i = 0;
+    while (i < size) {
+        from[i].id = pokemon_id(list->nodes[i]->pokemon);
+        from[i].node = list->nodes[i];
+        if (from[i].id > max_id) {
+            max_id = from[i].id;
         }
-
-        curr = curr->next;
+        i++;
     }
 
+    int shift = 0;
+    while (shift < 32 && (max_id >> shift) != 0) {
+        int count[257] = {0};
 
-    pokedex = pokedex->next;
-    pokedex->current = pokedex->head;
-    return pokedex;
+        i = 0;
+        while (i < size) {
+            count[((from[i].id >> shift) & 0xFF) + 1]++;
+            i++;
+        }
+
+        // A pass where every id has the same byte changes nothing.
+        if (count[((from[0].id >> shift) & 0xFF) + 1] != size) {
+            int digit = 0;
+            while (digit < 256) {
+                count[digit + 1] += count[digit];
+                digit++;
+            }
+
+            i = 0;
+            while (i < size) {
+                to[count[(from[i].id >> shift) & 0xFF]++] = from[i];
+                i++;
+            }
 
+            struct sort_entry *swap = from;
+            from = to;
+            to = swap;
+        }
+
+        shift += 8;
+    }
+
+    i = 0;
+    while (i < size) {
+        list->nodes[i] = from[i].node;
+        i++;
+    }
+
+    free(entries);
 }
 
 // Return the current string length, 
-// excluding '\0' characters
+// excluding '\0' characters.
+// A string of MAX_STRING_LENGTH or more characters counts as 0.
 static int get_string_length(char *string) {
-    int i = 0;
-    int counter = 0;
-    while (i < MAX_STRING_LENGTH) {
-        if (string[i] != '\0') {
-            counter++;
-        } else {
-            return counter;
-        }
-        i++;
+    int length = strnlen(string, MAX_STRING_LENGTH);
+    if (length == MAX_STRING_LENGTH) {
+        return 0;
     }
-    return 0;
+    return length;
 }
 
-// Print the '*' of the length of the Pokemon name
+// Print the '*' of the length of the Pokemon name,
+// which is less than MAX_STRING_LENGTH.
 static void print_unfound_name(int length) {
-    int i = 0;
-    while (i < length) {
-        printf("*");
-        i++;
-    }
-    printf("\n");
+    out_write(mask_of_names(), length);
+    out_char('\n');
 }
 
-// This function checks if the current array has this type, 
-// and if it does, it returns. 
-// If it does not exist, 
-// this type will be recorded the type into the array.
-static void type_record(int *array, int type) {
-    if (type == 0) {
+// Print the line of node in print_pokemon, like
+// "--> #001: Bulbasaur" for the current node or "    #001: ********".
+// The line is formatted straight into the output buffer, unless the
+// name is too long to fit in what out_reserve can give.
+static void print_pokemon_line(struct pokenode *node, int current) {
+    char *name = pokemon_name(node->pokemon);
+    int length = 0;
+    if (node->status == FOUND) {
+        length = strlen(name);
+    } else {
+        length = get_string_length(name);
+        name = (char *) mask_of_names();
+    }
+
+    if (length > OUT_RESERVE_MAX - LINE_HEAD_MAX - 1) {
+        out_write(current ? "--> #" : "    #", 5);
+        out_padded_int(pokemon_id(node->pokemon), 3);
+        out_write(": ", 2);
+        out_write(name, length);
+        out_char('\n');
         return;
     }
 
-    int i = 0;
-    while (i < MAX_TYPE) {
-        if (type == array[i]) {
-            return;
-        }
-        i++;
+    char *line = out_reserve(LINE_HEAD_MAX + length + 1);
+    memcpy(line, current ? "--> #" : "    #", 5);
+    int size = 5 + format_padded_int(line + 5, pokemon_id(node->pokemon), 3);
+    line[size] = ':';
+    line[size + 1] = ' ';
+    memcpy(line + size + 2, name, length);
+    size += 2 + length;
+    line[size] = '\n';
+    out_commit(size + 1);
+}
+
+// Return MAX_STRING_LENGTH asterisks, made the first time they are
+// needed, to print the names that are not found.
+static const char *mask_of_names(void) {
+    static char mask[MAX_STRING_LENGTH];
+    if (mask[0] != '*') {
+        memset(mask, '*', MAX_STRING_LENGTH);
     }
+    return mask;
+}
 
+// This function will fill array with every type that has a key
+// (keys[type] >= 0), smallest key first.
+// The rest of array is left as NONE_TYPE.
+static void order_types(int *array, int *keys) {
     int j = 0;
-    while (j < MAX_TYPE && array[j] != NONE_TYPE) {
+    while (j < MAX_TYPE) {
+        int best = NONE_TYPE;
+        int type = NONE_TYPE + 1;
+        while (type < MAX_TYPE) {
+            if (keys[type] >= 0
+                    && (best == NONE_TYPE || keys[type] < keys[best])) {
+                best = type;
+            }
+            type++;
+        }
+        if (best == NONE_TYPE) {
+            return;
+        }
+        array[j] = best;
+        keys[best] = -1;
         j++;
     }
-
-    array[j] = type;
-
 }
 
 // This function will change all elements 
@@ -659,62 +1931,36 @@ static void print_type_array(int *array) {
 
         if (array[i] != NONE_TYPE) {
             const char *type_string = pokemon_type_to_string(array[i]);
-            printf("%s\n", type_string);
+            out_printf("%s\n", type_string);
         }
 
         i++;
     }
 }
 
-// This function checks if the current array has this type, 
-// and if it does, it return TURE. 
-// If it does not exist, 
-// this type will be recorded the type into the array
-// and return FLASE.
-static int type_exploring(int *array, int type) {
-    
-    int i = 0;
-    while (i < MAX_TYPE) {
-        if (type == array[i]) {
-            return FALSE;
-        }
-        i++;
-    }
-
-    int j = 0;
-    while (j < MAX_TYPE && array[j] != NONE_TYPE) {
-        j++;
-    }
-
-    array[j] = type;
-
-    return TURE;
-    
-}
-
 // This function is used to debug array
 static void debug_array(int *array) {
     int i = 0;
     while (i < MAX_TYPE) {
-        printf("%d ", array[i]);
+        out_printf("%d ", array[i]);
         i++;
     }
-    printf("\n");
+    out_printf("\n");
 }
 
 // This function will return a pokenode address with the same id,
 // if the same ID does not exist it will return a null address.
 static struct pokenode *set_evolution(Pokedex pokedex, int id) {
-    struct pokenode *curr = pokedex->head;
-
-    while (curr != NULL) {
-        if (pokemon_id(curr->pokemon) == id)
-            return curr;
+    return id_index_get(get_index(pokedex), id);
+}
 
-        curr = curr->next;
+// Record new_node in the id index of Pokedex,
+// so it can be looked up by its pokemon_id.
+// A view without an index yet picks up new_node when it is built.
+static void index_node(struct pokenode *new_node, Pokedex pokedex) {
+    if (pokedex->index != NULL) {
+        id_index_put(pokedex->index, pokemon_id(new_node->pokemon), new_node);
     }
-
-    return NULL;
 }
 
 // Traverse the evolution of Pokemon and print it out.
@@ -722,10 +1968,21 @@ static struct pokenode *set_evolution(Pokedex pokedex, int id) {
 // it will print Pokemon id, name and type,
 // otherwise, it only print #ID ???? [????]
 static void print_evolution(struct pokenode *node) {
-    printf("#%03d ",pokemon_id(node->pokemon));
+    print_evolution_entry(node);
+
+    if (node->evolve != NULL) {
+        out_printf("--> ");
+    }
+
+}
+
+// Print the ID, name and types of the Pokemon in node,
+// or ???? for the name and types if it has not been found.
+static void print_evolution_entry(struct pokenode *node) {
+    out_printf("#%03d ",pokemon_id(node->pokemon));
     if (node->status == FOUND) {
 
-        printf("%s ", pokemon_name(node->pokemon));
+        out_printf("%s ", pokemon_name(node->pokemon));
 
         int type1 = pokemon_first_type(node->pokemon);
         int type2 = pokemon_second_type(node->pokemon);
@@ -733,22 +1990,18 @@ static void print_evolution(struct pokenode *node) {
         const char *type1_string = pokemon_type_to_string(type1);
         const char *type2_string = pokemon_type_to_string(type2);
 
-        printf("[%s", type1_string);
+        out_printf("[%s", type1_string);
 
         if (type2 != 0) {
-            printf(" %s] ", type2_string);
+            out_printf(" %s] ", type2_string);
         } else {
-            printf("] ");
+            out_printf("] ");
         }
     } else {
-        printf("???? [????] ");
+        out_printf("???? [????] ");
         
     }
 
-    if (node->evolve != NULL) {
-        printf("--> ");
-    }
-
 }
 
 // Insert new_node in the end of Pokedex.
@@ -760,167 +2013,153 @@ static void insert_end_node(struct pokenode *new_node, Pokedex pokedex) {
 
 }
 
-// Insert new_node in the head of Pokedex.
-static void insert_head_node(struct pokenode *new_node, Pokedex pokedex) {
-    pokedex->head->prev = new_node;
-    new_node->next = pokedex->head;
-    pokedex->head = new_node;
-    pokedex->data->total++;
-
+// Determine if the name in a row of the columns contains text,
+// ignoring case.
+// if the name include the text
+// it will return TURE;
+// ortherwise it will return FALSE.
+static int row_contains(Columns columns, int row, char *text, int text_length) {
+    return name_contains(columns_name(columns, row),
+        columns_name_length(columns, row), text, text_length);
 }
 
-// Insert new_node before the node insert_after.
-static void insert_between_node(
-    struct pokenode *new_node, 
-    struct pokenode *insert_after, 
-    Pokedex pokedex
-) {
+// Search for Pokemon with this ID in pokedex.
+// if the Pokemond will this id is exist,
+// it will print the error information 
+// and exit the program
+static void check_exist_pokemon(int id, Pokedex pokedex) {
+    if (id_index_get(get_index(pokedex), id) != NULL) {
+        fprintf(
+            stderr, 
+            "%s: There's already a Pokemon with pokemon_id %d!\n", 
+            __FILE__, id
+        );
+        exit(1);
+    }
+}
 
-    new_node->prev = insert_after->prev;
-    new_node->next = insert_after;
-    insert_after->prev->next = new_node;
-    insert_after->prev = new_node;
-    pokedex->data->total++;
+// When Pokemon is removed, 
+// This function will adjuest found numbers and type counts.
+static void remove_count_number(Pokedex pokedex, struct pokenode *n) {
+    if (n->status == FOUND) {
+        pokedex->data->found_nums--;
+        count_found_types(pokedex, n, -1);
+    }
 
+    int type1 = pokemon_first_type(n->pokemon);
+    int type2 = pokemon_second_type(n->pokemon);
+    remove_type_count(pokedex->data, type1, n);
+    if (type2 != NONE_TYPE) {
+        remove_type_count(pokedex->data, type2, n);
+    }
 }
 
-// Clone pokemon and create a node, 
-// and add to subPokedex.
-static void transfer_pokemon(struct pokenode *node, Pokedex pokedex) {
-    Pokemon copy_pokemon = node->pokemon;
-    add_pokemon(pokedex->next,clone_pokemon(copy_pokemon));
-    pokedex->next->end->status = FOUND;
-    pokedex->next->data->found_nums++;
+// Set every count of data to 0, with no types.
+static void clear_pokedata(struct pokedata *data) {
+    data->total = 0;
+    data->found_nums = 0;
+    clean_array(data->type_record);
+
+    int type = 0;
+    while (type < MAX_TYPE) {
+        data->type_total[type] = 0;
+        data->type_found[type] = 0;
+        data->type_first[type] = NULL;
+        type++;
+    }
+    data->types_stale = FALSE;
 }
 
-// Insert pokenode in order.
-// If Pokedex is empty, it will insert on the head.
-// If Pokedex is not empty, 
-// it will determine the order of the ID 
-// to decide whether to 
-// insert it in front of or behind the current node.
-static void insert_order_pokemon(struct pokenode *node, Pokedex pokedex) {
+// Count the types of a node just put at the end of Pokedex.
+static void count_types(Pokedex pokedex, struct pokenode *node) {
+    int type1 = pokemon_first_type(node->pokemon);
+    int type2 = pokemon_second_type(node->pokemon);
+    add_type_count(pokedex->data, type1, node);
+    if (type2 != NONE_TYPE) {
+        add_type_count(pokedex->data, type2, node);
+    }
 
-    if (pokedex->head == NULL) {
-        add_pokemon(pokedex, clone_pokemon(node->pokemon));
-        return;
+    if (node->status == FOUND) {
+        count_found_types(pokedex, node, 1);
     }
+}
 
-    struct pokenode *new_node = new_pokenode(clone_pokemon(node->pokemon));
-    int insert_id = pokemon_id(new_node->pokemon);
+// Count one more Pokemon of type, in node.
+// Nodes are only ever added at the end, so a type not in the Pokedex
+// yet first appears after every other type, and goes last.
+static void add_type_count(struct pokedata *data, int type,
+    struct pokenode *node) {
 
-    if (pokedex->data->total == 1) {
-        if (insert_id > pokemon_id(pokedex->head->pokemon)) {
-            insert_end_node(new_node, pokedex);
-        } else {
-            insert_head_node(new_node, pokedex);
-        }
+    data->type_total[type]++;
+    if (data->type_total[type] > 1) {
         return;
     }
 
-    if (pokedex->data->total > 1) {
-        struct pokenode *insert = pokedex->head;
-        while (insert != NULL && insert_id > pokemon_id(insert->pokemon)) {
-
-            insert = insert->next;
-        }
-        if (insert == NULL) {
-            insert_end_node(new_node, pokedex);
-            return;
-        } else if (insert->prev == NULL) {
-            insert_head_node(new_node, pokedex);
-            return;
-        }
-
-        insert_between_node(new_node, insert, pokedex);
-
+    data->type_first[type] = node;
+    int i = 0;
+    while (data->type_record[i] != NONE_TYPE) {
+        i++;
     }
-
+    data->type_record[i] = type;
 }
 
-// Set all pokemons are found in current pokedex.
-static void set_all_found(Pokedex pokedex) {
-    struct pokenode *curr = pokedex->head;
-    struct pokenode *origin_curr = pokedex->current;
-    while (curr != NULL) {
-        pokedex->current = curr;
-        find_current_pokemon(pokedex);
-        curr = curr->next;
+// Count one less Pokemon of type, as node is removed.
+// The last one takes the type out of the order; the first one (of
+// several) makes the order stale, as the type now first appears
+// at some later node.
+static void remove_type_count(struct pokedata *data, int type,
+    struct pokenode *node) {
+
+    data->type_total[type]--;
+    if (data->type_total[type] > 0) {
+        if (data->type_first[type] == node) {
+            data->types_stale = TURE;
+        }
+        return;
     }
-    pokedex->current = origin_curr;
-}
-
-// Determine if the current name contains text.
-// if curr_name include the text
-// it will return TURE;
-// ortherwise it will return FALSE.
-static int compare_name(char *text, char *curr_name) {
-
-    int text_length = get_string_length(text);
-    int curr_name_length = get_string_length(curr_name);
 
+    data->type_first[type] = NULL;
     int i = 0;
-    int j = 0;
-    while (i < curr_name_length) {
-        char lower_curr_name = to_lower_case(curr_name[i]);
-        char lower_text = to_lower_case(text[j]);
-
-        if (lower_curr_name == lower_text) {
-            j++;
-
-            if (j >= text_length) {
-                return TURE;
-            }
-
-        } else {
-
-            j = 0;
-            if (to_lower_case(text[j]) == to_lower_case(curr_name[i])) {
-                j++;
-            }
-
-        }
-
+    while (data->type_record[i] != type) {
         i++;
     }
-
-    return FALSE;
+    while (i + 1 < MAX_TYPE) {
+        data->type_record[i] = data->type_record[i + 1];
+        i++;
+    }
+    data->type_record[MAX_TYPE - 1] = NONE_TYPE;
 }
 
-// Make uppercase character lowercase.
-static char to_lower_case(char text) {
+// Count the types of node as found (or not, for a change of -1).
+static void count_found_types(Pokedex pokedex, struct pokenode *node,
+    int change) {
 
-    if (text >= 'A' && text <= 'Z') {
-        return text + 'a' -'A';
+    int type1 = pokemon_first_type(node->pokemon);
+    int type2 = pokemon_second_type(node->pokemon);
+    pokedex->data->type_found[type1] += change;
+    if (type2 != NONE_TYPE) {
+        pokedex->data->type_found[type2] += change;
     }
-    return text;
-    
 }
 
-// Search for Pokemon with this ID in pokedex.
-// if the Pokemond will this id is exist,
-// it will print the error information 
-// and exit the program
-static void check_exist_pokemon(int id, Pokedex pokedex) {
-    struct pokenode *curr = pokedex->head;
-    while (curr != NULL) {
-        if (id == pokemon_id(curr->pokemon)) {
-            fprintf(
-                stderr, 
-                "%s: There's already a Pokemon with pokemon_id %d!\n", 
-                __FILE__, id
-            );
-            exit(1);
-        }
-        curr = curr->next;
+// When Pokemon is removed, 
+// this function will remove its row from the columns.
+// Once at least half of the rows are dead, 
+// the columns are dropped, to be rebuilt by the next scan.
+static void remove_row(Pokedex pokedex, struct pokenode *n) {
+    Columns columns = pokedex->columns;
+    if (columns == NULL) {
+        return;
     }
-}
 
-// When Pokemon is removed, 
-// This function will adjuest found numbers.
-static void remove_count_number(Pokedex pokedex, struct pokenode *n) {
-    if (n->status == FOUND) {
-        pokedex->data->found_nums--;
+    columns_remove(columns, n->row);
+    if (columns->rows >= MIN_COMPACT_ROWS
+            && 2 * columns->removed >= columns->rows) {
+        destroy_columns(columns);
+        pokedex->columns = NULL;
+        if (pokedex->trigrams != NULL) {
+            destroy_trigram_index(pokedex->trigrams);
+            pokedex->trigrams = NULL;
+        }
     }
 }
-
@@ -5,8 +5,19 @@
 // 
 // Version 2.0.0: Release
 // Version 2.0.1: Fix detail_pokemon comment to have 1 dp for height.
+// Version 2.1.0: Add add_new_pokemon; Pokemon live in pools of the Pokedex.
+// Version 2.2.0: F, S and T return views; add copy_pokedex.
+// Version 2.3.0: Add save_pokedex and load_pokedex.
+// Version 2.4.0: Add import_pokemon.
+// Version 2.5.0: Reject evolution loops; add show_family and show_all_chains.
+// Version 2.6.0: Declare show_types.
+// Version 2.7.0: Add print_pokemon_page, print_pokemon_between and
+//                positions of Pokemon.
+// Version 2.8.0: Add open_pokedex_journal and checkpoint_pokedex.
+// Version 2.9.0: Add has_pokemon and can_add_evolution.
 
 #include "pokemon.h"
+#include "importer.h"
 
 #ifndef _POKEDEX_H_
 #define _POKEDEX_H_
@@ -18,8 +29,27 @@ typedef struct pokedex *Pokedex;
 // Create a new Pokedex and return a pointer to it.
 Pokedex new_pokedex(void);
 
+// Add a Pokemon to the Pokedex.
+// The Pokemon is moved into the memory of the Pokedex,
+// so `pokemon` must not be used or destroyed afterwards.
 void add_pokemon(Pokedex pokedex, Pokemon pokemon);
 
+// Add every valid row of the CSV or TSV file at `path` (described in
+// importer.h) to the end of the Pokedex, in order of pokemon_id,
+// parsing the file with `threads` threads.
+// Invalid rows, and rows whose pokemon_id is already in the Pokedex
+// or on an earlier line, are skipped and counted in report.
+// Returns 1, or prints why to stderr and returns 0 (adding nothing)
+// if the file cannot be read.
+int import_pokemon(Pokedex pokedex, char *path, int threads,
+    struct import_report *report);
+
+// Create a new Pokemon directly in the memory of the Pokedex,
+// and add it to the Pokedex.
+// This avoids the separate allocations made by new_pokemon.
+void add_new_pokemon(Pokedex pokedex, int pokemon_id, char *name,
+    double height, double weight, pokemon_type type1, pokemon_type type2);
+
 void detail_pokemon(Pokedex pokedex);
 
 Pokemon get_current_pokemon(Pokedex pokedex);
@@ -28,6 +58,28 @@ void find_current_pokemon(Pokedex pokedex);
 
 void print_pokemon(Pokedex pokedex);
 
+// The position of a Pokemon is how many Pokemon were added to the
+// Pokedex before it (and are still in it), so the first is at 0.
+// Finding a Pokemon by position, or the position of a Pokemon, takes
+// O(log n).
+
+// Print at most `limit` Pokemon, like print_pokemon, starting from the
+// one at `position`.
+void print_pokemon_page(Pokedex pokedex, int position, int limit);
+
+// Print the Pokemon from the one with ID `from_id` to the one with ID
+// `to_id`, like print_pokemon, whichever of them comes first.
+// If either ID is not in the Pokedex, this function prints nothing.
+void print_pokemon_between(Pokedex pokedex, int from_id, int to_id);
+
+// Change the currently selected Pokemon to the one at `position`.
+// If there is no Pokemon at `position`, this function does nothing.
+void change_current_position(Pokedex pokedex, int position);
+
+// Return the position of the currently selected Pokemon,
+// or -1 if the Pokedex is empty.
+int get_current_position(Pokedex pokedex);
+
 void next_pokemon(Pokedex pokedex);
 
 void prev_pokemon(Pokedex pokedex);
@@ -39,6 +91,11 @@ void prev_pokemon(Pokedex pokedex);
 // nothing.
 void change_current_pokemon(Pokedex pokedex, int id);
 
+// Return 1 if there is a Pokemon with the ID `id` in the Pokedex,
+// or 0 if there is not.
+int has_pokemon(Pokedex pokedex, int id);
+
+// Any evolutions into or out of the removed Pokemon are removed too.
 // If there are no Pokemon in the Pokedex, this function does nothing.
 void remove_pokemon(Pokedex pokedex);
 
@@ -47,6 +104,10 @@ void destroy_pokedex(Pokedex pokedex);
 
 void go_exploring(Pokedex pokedex);
 
+// Print each type of the Pokemon in the Pokedex, one per line,
+// in the order the types first appear in the Pokedex.
+void show_types(Pokedex pokedex);
+
 // Return the total number of Pokemon in the Pokedex, whether or not
 // they have been found.
 int count_total_pokemon(Pokedex pokedex);
@@ -54,16 +115,71 @@ int count_total_pokemon(Pokedex pokedex);
 // Return the number of Pokemon in the Pokedex that have been found.
 int count_found_pokemon(Pokedex pokedex);
 
+// Exits with an error if either Pokemon is not in the Pokedex, or if
+// the evolution would make a loop (to_id already evolves into from_id).
 void add_pokemon_evolution(Pokedex pokedex, int from_id, int to_id);
 
+// Return 1 if add_pokemon_evolution would add this evolution, or 0 if
+// it would exit with an error.
+int can_add_evolution(Pokedex pokedex, int from_id, int to_id);
+
 void show_evolutions(Pokedex pokedex);
 
 int get_next_evolution(Pokedex pokedex);
 
+// Show the family of the currently selected Pokemon: every Pokemon
+// linked to it by evolutions. The final form they all evolve into
+// comes first; each Pokemon that evolves into one above is shown
+// below it, one level further indented, after "<-- ".
+void show_family(Pokedex pokedex);
+
+// Show every family of two or more Pokemon, as show_family does.
+void show_all_chains(Pokedex pokedex);
+
+// The Pokedex returned by get_pokemon_of_type, get_found_pokemon and
+// search_pokemon is a view: it borrows the Pokemon of the original
+// Pokedex instead of copying them.
+// It must be destroyed before the original Pokedex is changed or
+// destroyed. Use copy_pokedex to keep a Pokedex that outlives it.
 Pokedex get_pokemon_of_type(Pokedex pokedex, pokemon_type type);
 
 Pokedex get_found_pokemon(Pokedex pokedex);
 
 Pokedex search_pokemon(Pokedex pokedex, char *text);
 
+// Create a new Pokedex holding its own copy of every Pokemon in the
+// given Pokedex, with the same found status, evolutions and
+// currently selected Pokemon.
+Pokedex copy_pokedex(Pokedex pokedex);
+
+// Save the Pokemon, found status, evolutions and currently selected
+// Pokemon of the Pokedex to a binary snapshot file at `path`.
+// Returns 1 on success, or prints why to stderr and returns 0.
+int save_pokedex(Pokedex pokedex, char *path);
+
+// Replace the contents of the Pokedex with the snapshot at `path`,
+// which is memory-mapped and must not be truncated while the
+// Pokedex uses it (save_pokedex replaces files, so it is safe).
+// If the Pokedex has a journal, the snapshot is first checkpointed
+// for it, as checkpoint_pokedex would once it was loaded.
+// Returns 1 on success, or prints why to stderr and returns 0,
+// leaving the Pokedex and its journal unchanged.
+int load_pokedex(Pokedex pokedex, char *path);
+
+// Recover the new, empty Pokedex from the journal at `path` (described
+// in journal.h), creating the journal if there is none, and from then
+// on record every Pokemon added, found or removed and every evolution
+// added in it. Records are committed at most `commit_interval`
+// milliseconds after they are made, so that is all a crash can lose.
+// The currently selected Pokemon is not journaled.
+// Returns 1 on success, or prints why to stderr and returns 0.
+int open_pokedex_journal(Pokedex pokedex, char *path, int commit_interval);
+
+// Save a snapshot of the Pokedex for its journal, and start the
+// journal again empty, so recovery loads that snapshot and replays
+// only what comes after it.
+// Returns 1 on success, or prints why to stderr and returns 0,
+// leaving the journal as it was.
+int checkpoint_pokedex(Pokedex pokedex);
+
 #endif //  _POKEDEX_H_
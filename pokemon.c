@@ -11,6 +11,7 @@
 #include <assert.h>
 
 #include "pokemon.h"
+#include "stats.h"
 
 const static char *types[] = {
     [NONE_TYPE]     = "None",
@@ -36,18 +37,16 @@ const static char *types[] = {
 
 #define POKEMON_MAGIC_NUMBER 0xDEADBEEF
 
-struct pokemon {
-    int          magic_number;
-    int          pokemon_id;
-    char         *name;
-    double       height;
-    double       weight;
-    pokemon_type type1;
-    pokemon_type type2;
-};
+// The slot of a type name in pokemon_type_from_string, from its length
+// and its first two letters in lower case.
+#define TYPE_HASH(length, c0, c1) ((18 * (c0) + 17 * (c1) + (length)) & 31)
 
 static int valid_character(int c);
 static int valid_pokemon_type(pokemon_type type);
+static void check_new_pokemon(int pokemon_id, pokemon_type type1,
+    pokemon_type type2, char *function_name);
+static void init_pokemon(Pokemon pokemon, int pokemon_id, char *name,
+    double height, double weight, pokemon_type type1, pokemon_type type2);
 static void check_valid_pokemon(Pokemon pokemon, char *function_name);
 static void die(char *function_name, char *message);
 static char *check_address_is_heap_pointer(void *p, size_t size);
@@ -55,37 +54,33 @@ static char *check_address_is_heap_pointer(void *p, size_t size);
 Pokemon new_pokemon(int pokemon_id, char *name, double height,
     double weight, pokemon_type type1, pokemon_type type2) {
 
-    if (pokemon_id < 0) {
-        die("new_pokemon", "invalid pokemon_id");
-    }
+    check_new_pokemon(pokemon_id, type1, type2, "new_pokemon");
 
-    if (!valid_pokemon_type(type1)) {
-        die("new_pokemon", "type1 is invalid");
-    }
+    Pokemon new_pokemon = malloc(sizeof(struct pokemon));
+    assert(new_pokemon != NULL);
 
-    if (!valid_pokemon_type(type2)) {
-        die("new_pokemon", "type2 is invalid");
-    }
+    init_pokemon(new_pokemon, pokemon_id, strdup(name),
+        height, weight, type1, type2);
+    assert(new_pokemon->name != NULL);
+    STATS_ALLOC(sizeof(struct pokemon));
+    STATS_ALLOC(strlen(name) + 1);
+    return new_pokemon;
+}
 
-    if (type1 == NONE_TYPE) {
-        die("new_pokemon", "type1 is NONE_TYPE");
-    }
+// Create a new Pool for Pokemon.
+Pool new_pokemon_pool(void) {
+    return new_pool(sizeof(struct pokemon));
+}
 
-    if (type1 == type2) {
-        die("new_pokemon", "type1 and type2 must be different");
-    }
+// Create a new Pokemon, and its name, in the memory of `pool`.
+Pokemon pool_new_pokemon(Pool pool, int pokemon_id, char *name,
+    double height, double weight, pokemon_type type1, pokemon_type type2) {
 
-    Pokemon new_pokemon = malloc(sizeof(struct pokemon));
-    assert(new_pokemon != NULL);
+    check_new_pokemon(pokemon_id, type1, type2, "pool_new_pokemon");
 
-    new_pokemon->magic_number = POKEMON_MAGIC_NUMBER;
-    new_pokemon->pokemon_id = pokemon_id;
-    new_pokemon->name = strdup(name);
-    assert(name != NULL);
-    new_pokemon->height = height;
-    new_pokemon->weight = weight;
-    new_pokemon->type1 = type1;
-    new_pokemon->type2 = type2;
+    Pokemon new_pokemon = pool_alloc(pool);
+    init_pokemon(new_pokemon, pokemon_id, pool_strdup(pool, name),
+        height, weight, type1, type2);
     return new_pokemon;
 }
 
@@ -96,6 +91,39 @@ void destroy_pokemon(Pokemon pokemon) {
     free(pokemon);
 }
 
+// Destroy the specified `pokemon`, which was made in `pool`.
+// The magic number is cleared so stale pointers are caught.
+void pool_destroy_pokemon(Pool pool, Pokemon pokemon) {
+    check_valid_pokemon(pokemon, "pool_destroy_pokemon");
+    pokemon->magic_number = 0;
+    pool_release_string(pool, pokemon->name);
+    pool_release(pool, pokemon);
+}
+
+// Create a new Pokemon in the memory of `pool`, using `name` itself.
+Pokemon pool_new_pokemon_borrowed_name(Pool pool, int pokemon_id,
+    char *name, double height, double weight,
+    pokemon_type type1, pokemon_type type2) {
+
+    check_new_pokemon(pokemon_id, type1, type2,
+        "pool_new_pokemon_borrowed_name");
+
+    Pokemon new_pokemon = pool_alloc(pool);
+    init_pokemon(new_pokemon, pokemon_id, name,
+        height, weight, type1, type2);
+    return new_pokemon;
+}
+
+// Destroy the specified `pokemon`, which was made in `pool`,
+// without releasing its borrowed name.
+void pool_destroy_pokemon_borrowed_name(Pool pool, Pokemon pokemon) {
+    check_valid_pokemon(pokemon, "pool_destroy_pokemon_borrowed_name");
+    pokemon->magic_number = 0;
+    pool_release(pool, pokemon);
+}
+
+#ifndef POKEMON_RELEASE
+
 // Return the pokemon_id of the specified `pokemon`.
 int pokemon_id(Pokemon pokemon) {
     check_valid_pokemon(pokemon, "pokemon_id");
@@ -132,6 +160,8 @@ pokemon_type pokemon_second_type(Pokemon pokemon) {
     return pokemon->type2;
 }
 
+#endif // POKEMON_RELEASE
+
 // Return a clone of the specified `pokemon`.
 Pokemon clone_pokemon(Pokemon pokemon) {
     check_valid_pokemon(pokemon, "clone_pokemon");
@@ -145,6 +175,20 @@ Pokemon clone_pokemon(Pokemon pokemon) {
     );
 }
 
+// Return a clone of the specified `pokemon`, made in `pool`.
+Pokemon pool_clone_pokemon(Pool pool, Pokemon pokemon) {
+    check_valid_pokemon(pokemon, "pool_clone_pokemon");
+    return pool_new_pokemon(
+        pool,
+        pokemon->pokemon_id,
+        pokemon->name,
+        pokemon->height,
+        pokemon->weight,
+        pokemon->type1,
+        pokemon->type2
+    );
+}
+
 // Check whether `name` is a valid name for a Pokemon.
 // Valid names consist of letters, spaces, and dashes.
 int pokemon_valid_name(char *name) {
@@ -165,14 +209,46 @@ static int valid_character(int c) {
     );
 }
 
+// Convert a string into a pokemon_type, ignoring case.
+// TYPE_HASH gives every type name a different slot, so the switch
+// is a perfect hash table built by the compiler (two names sharing
+// a slot would be a duplicate case label), and only one strcasecmp
+// is needed to check the name.
 pokemon_type pokemon_type_from_string(char *str) {
-    for (int i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
-        if (strcasecmp(types[i], str) == 0) {
-            return (pokemon_type) i;
-        }
+    size_t length = strlen(str);
+    if (length < 2) {
+        return INVALID_TYPE;
+    }
+
+    pokemon_type type;
+    switch (TYPE_HASH(length, str[0] | 0x20, str[1] | 0x20)) {
+    case TYPE_HASH(4, 'n', 'o'): type = NONE_TYPE;     break;
+    case TYPE_HASH(6, 'n', 'o'): type = NORMAL_TYPE;   break;
+    case TYPE_HASH(4, 'f', 'i'): type = FIRE_TYPE;     break;
+    case TYPE_HASH(8, 'f', 'i'): type = FIGHTING_TYPE; break;
+    case TYPE_HASH(5, 'w', 'a'): type = WATER_TYPE;    break;
+    case TYPE_HASH(6, 'f', 'l'): type = FLYING_TYPE;   break;
+    case TYPE_HASH(5, 'g', 'r'): type = GRASS_TYPE;    break;
+    case TYPE_HASH(6, 'p', 'o'): type = POISON_TYPE;   break;
+    case TYPE_HASH(8, 'e', 'l'): type = ELECTRIC_TYPE; break;
+    case TYPE_HASH(6, 'g', 'r'): type = GROUND_TYPE;   break;
+    case TYPE_HASH(7, 'p', 's'): type = PSYCHIC_TYPE;  break;
+    case TYPE_HASH(4, 'r', 'o'): type = ROCK_TYPE;     break;
+    case TYPE_HASH(3, 'i', 'c'): type = ICE_TYPE;      break;
+    case TYPE_HASH(3, 'b', 'u'): type = BUG_TYPE;      break;
+    case TYPE_HASH(6, 'd', 'r'): type = DRAGON_TYPE;   break;
+    case TYPE_HASH(5, 'g', 'h'): type = GHOST_TYPE;    break;
+    case TYPE_HASH(4, 'd', 'a'): type = DARK_TYPE;     break;
+    case TYPE_HASH(5, 's', 't'): type = STEEL_TYPE;    break;
+    case TYPE_HASH(5, 'f', 'a'): type = FAIRY_TYPE;    break;
+    default:
+        return INVALID_TYPE;
+    }
 
+    if (strcasecmp(types[type], str) != 0) {
+        return INVALID_TYPE;
     }
-    return INVALID_TYPE;
+    return type;
 }
 
 // Convert a pokemon_type into its corresponding string.
@@ -182,6 +258,45 @@ const char *pokemon_type_to_string(pokemon_type type) {
     return types[type];
 }
 
+// Check the arguments for a new Pokemon,
+// and exit the program if any of them are invalid.
+static void check_new_pokemon(int pokemon_id, pokemon_type type1,
+    pokemon_type type2, char *function_name) {
+
+    if (pokemon_id < 0) {
+        die(function_name, "invalid pokemon_id");
+    }
+
+    if (!valid_pokemon_type(type1)) {
+        die(function_name, "type1 is invalid");
+    }
+
+    if (!valid_pokemon_type(type2)) {
+        die(function_name, "type2 is invalid");
+    }
+
+    if (type1 == NONE_TYPE) {
+        die(function_name, "type1 is NONE_TYPE");
+    }
+
+    if (type1 == type2) {
+        die(function_name, "type1 and type2 must be different");
+    }
+}
+
+// Fill in the fields of a newly allocated Pokemon.
+static void init_pokemon(Pokemon pokemon, int pokemon_id, char *name,
+    double height, double weight, pokemon_type type1, pokemon_type type2) {
+
+    pokemon->magic_number = POKEMON_MAGIC_NUMBER;
+    pokemon->pokemon_id = pokemon_id;
+    pokemon->name = name;
+    pokemon->height = height;
+    pokemon->weight = weight;
+    pokemon->type1 = type1;
+    pokemon->type2 = type2;
+}
+
 // Check whether `type` is a valid pokemon_type.
 static int valid_pokemon_type(pokemon_type type) {
     return type > INVALID_TYPE && type < MAX_TYPE;
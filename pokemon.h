@@ -8,6 +8,8 @@
 #ifndef _POKEMON_H_
 #define _POKEMON_H_
 
+#include "pool.h"
+
 typedef enum pokemon_type {
     INVALID_TYPE = -1,
     NONE_TYPE,
@@ -34,6 +36,18 @@ typedef enum pokemon_type {
 
 typedef struct pokemon *Pokemon;
 
+// The fields of a Pokemon are only for pokemon.c, and for the
+// accessors below when they are built inline.
+struct pokemon {
+    int          magic_number;
+    int          pokemon_id;
+    char         *name;
+    double       height;
+    double       weight;
+    pokemon_type type1;
+    pokemon_type type2;
+};
+
 
 Pokemon new_pokemon(int pokemon_id, char *name, double height,
     double weight, pokemon_type type1, pokemon_type type2);
@@ -44,6 +58,37 @@ void destroy_pokemon(Pokemon pokemon);
 // Create a clone of the input Pokemon.
 Pokemon clone_pokemon(Pokemon pokemon);
 
+// Create a new Pool to hold Pokemon made by pool_new_pokemon.
+Pool new_pokemon_pool(void);
+
+// Create a new Pokemon, and a copy of its name, in the memory of `pool`.
+// The arguments are checked exactly as new_pokemon checks them.
+Pokemon pool_new_pokemon(Pool pool, int pokemon_id, char *name,
+    double height, double weight, pokemon_type type1, pokemon_type type2);
+
+// Create a clone of the input Pokemon in the memory of `pool`.
+Pokemon pool_clone_pokemon(Pool pool, Pokemon pokemon);
+
+// Give the memory of a Pokemon made by pool_new_pokemon
+// back to its pool.
+void pool_destroy_pokemon(Pool pool, Pokemon pokemon);
+
+// Create a new Pokemon in the memory of `pool` which uses `name`
+// itself instead of a copy, so `name` must outlive the Pokemon.
+// The arguments are checked exactly as new_pokemon checks them.
+Pokemon pool_new_pokemon_borrowed_name(Pool pool, int pokemon_id,
+    char *name, double height, double weight,
+    pokemon_type type1, pokemon_type type2);
+
+// Give the memory of a Pokemon made by pool_new_pokemon_borrowed_name
+// back to its pool. Its name is left alone.
+void pool_destroy_pokemon_borrowed_name(Pool pool, Pokemon pokemon);
+
+// Built with POKEMON_RELEASE defined, the accessors below are inline
+// and do not check that `pokemon` is valid. Otherwise every call
+// checks it, and exits if it is NULL, freed or not a Pokemon.
+#ifndef POKEMON_RELEASE
+
 // Return the pokemon_id of a given Pokemon.
 int pokemon_id(Pokemon pokemon);
 
@@ -63,6 +108,34 @@ pokemon_type pokemon_first_type(Pokemon pokemon);
 // If the Pokemon only has one type, returns NONE_TYPE.
 pokemon_type pokemon_second_type(Pokemon pokemon);
 
+#else
+
+static inline int pokemon_id(Pokemon pokemon) {
+    return pokemon->pokemon_id;
+}
+
+static inline char *pokemon_name(Pokemon pokemon) {
+    return pokemon->name;
+}
+
+static inline double pokemon_height(Pokemon pokemon) {
+    return pokemon->height;
+}
+
+static inline double pokemon_weight(Pokemon pokemon) {
+    return pokemon->weight;
+}
+
+static inline pokemon_type pokemon_first_type(Pokemon pokemon) {
+    return pokemon->type1;
+}
+
+static inline pokemon_type pokemon_second_type(Pokemon pokemon) {
+    return pokemon->type2;
+}
+
+#endif // POKEMON_RELEASE
+
 // Check whether the specified "name" is a valid name for a Pokemon.
 // Returns 1 if all the characters are valid Pokemon name characters.
 // Returns 0 if not.
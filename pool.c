@@ -0,0 +1,196 @@
+// pool.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "pool.h"
+#include "stats.h"
+
+#define ITEMS_PER_CHUNK 1024
+#define STRING_CHUNK_SIZE 65536
+#define GRANULE 16
+#define MAX_STRING_CLASS 64
+
+struct pool {
+    size_t             item_size;
+    struct pool_chunk  *chunks;
+    char               *next_item;
+    char               *item_end;
+    struct free_block  *free_items;
+    char               *next_byte;
+    char               *byte_end;
+    struct free_block  *free_strings[MAX_STRING_CLASS + 1];
+};
+
+// Every chunk taken from the system, kept so destroy_pool can free them.
+struct pool_chunk {
+    struct pool_chunk *next;
+    max_align_t       data[];
+};
+
+// A released item or string, threaded onto a free list.
+struct free_block {
+    struct free_block *next;
+};
+
+#ifdef __has_feature
+#if __has_feature(address_sanitizer)
+#define HAVE_ASAN
+#endif
+#endif
+
+#ifdef __SANITIZE_ADDRESS__
+#define HAVE_ASAN
+#endif
+
+// Released memory is poisoned so the sanitizer catches stale pointers.
+#ifdef HAVE_ASAN
+#include <sanitizer/asan_interface.h>
+#define POISON(p, size) ASAN_POISON_MEMORY_REGION(p, size)
+#define UNPOISON(p, size) ASAN_UNPOISON_MEMORY_REGION(p, size)
+#else
+#define POISON(p, size) ((void) (p), (void) (size))
+#define UNPOISON(p, size) ((void) (p), (void) (size))
+#endif
+
+// Take a chunk with `size` bytes of data from the system.
+static char *new_chunk(Pool pool, size_t size);
+
+// Return the number of granules needed to store `length` bytes.
+static size_t granules(size_t length);
+
+// Creates a new Pool, and returns a pointer to it.
+Pool new_pool(size_t item_size) {
+    Pool pool = malloc(sizeof(struct pool));
+    assert(pool != NULL);
+    STATS_ALLOC(sizeof(struct pool));
+
+    // Items are rounded up so every item stays pointer aligned,
+    // and is big enough to hold a free list link once released.
+    if (item_size < sizeof(struct free_block)) {
+        item_size = sizeof(struct free_block);
+    }
+    pool->item_size = (item_size + sizeof(void *) - 1)
+        & ~(sizeof(void *) - 1);
+
+    pool->chunks = NULL;
+    pool->next_item = NULL;
+    pool->item_end = NULL;
+    pool->free_items = NULL;
+    pool->next_byte = NULL;
+    pool->byte_end = NULL;
+
+    int i = 0;
+    while (i <= MAX_STRING_CLASS) {
+        pool->free_strings[i] = NULL;
+        i++;
+    }
+
+    return pool;
+}
+
+// Destroy the given Pool, freeing every item and string in it.
+void destroy_pool(Pool pool) {
+    struct pool_chunk *curr = pool->chunks;
+    while (curr != NULL) {
+        struct pool_chunk *remove = curr;
+        curr = curr->next;
+        free(remove);
+    }
+    free(pool);
+}
+
+// Return memory for one item, reusing a released item if possible.
+void *pool_alloc(Pool pool) {
+    if (pool->free_items != NULL) {
+        struct free_block *item = pool->free_items;
+        UNPOISON(item, pool->item_size);
+        pool->free_items = item->next;
+        return item;
+    }
+
+    if (pool->next_item == pool->item_end) {
+        size_t size = pool->item_size * ITEMS_PER_CHUNK;
+        pool->next_item = new_chunk(pool, size);
+        pool->item_end = pool->next_item + size;
+    }
+
+    void *item = pool->next_item;
+    pool->next_item += pool->item_size;
+    return item;
+}
+
+// Put the item on the free list.
+void pool_release(Pool pool, void *item) {
+    struct free_block *block = item;
+    block->next = pool->free_items;
+    pool->free_items = block;
+    POISON(item, pool->item_size);
+}
+
+// Copy the string into the arena.
+// Strings are stored in whole granules, and a released string's
+// granules are reused by the next string of the same size class.
+// Strings longer than the largest class get a chunk of their own,
+// which is only freed with the pool.
+char *pool_strdup(Pool pool, const char *string) {
+    size_t length = strlen(string) + 1;
+    size_t count = granules(length);
+    char *copy = NULL;
+
+    if (count <= MAX_STRING_CLASS && pool->free_strings[count] != NULL) {
+        struct free_block *block = pool->free_strings[count];
+        UNPOISON(block, count * GRANULE);
+        pool->free_strings[count] = block->next;
+        copy = (char *) block;
+    } else if (count > MAX_STRING_CLASS) {
+        copy = new_chunk(pool, count * GRANULE);
+    } else {
+        if (pool->byte_end - pool->next_byte < (long) (count * GRANULE)) {
+            pool->next_byte = new_chunk(pool, STRING_CHUNK_SIZE);
+            pool->byte_end = pool->next_byte + STRING_CHUNK_SIZE;
+        }
+        copy = pool->next_byte;
+        pool->next_byte += count * GRANULE;
+    }
+
+    memcpy(copy, string, length);
+    return copy;
+}
+
+// Put the string's granules on the free list of its size class.
+void pool_release_string(Pool pool, char *string) {
+    size_t count = granules(strlen(string) + 1);
+    if (count > MAX_STRING_CLASS) {
+        return;
+    }
+
+    struct free_block *block = (struct free_block *) string;
+    block->next = pool->free_strings[count];
+    pool->free_strings[count] = block;
+    POISON(string, count * GRANULE);
+}
+
+// Take a chunk with `size` bytes of data from the system,
+// and remember it so it is freed with the pool.
+static char *new_chunk(Pool pool, size_t size) {
+    struct pool_chunk *chunk = malloc(sizeof(struct pool_chunk) + size);
+    assert(chunk != NULL);
+    STATS_ALLOC(sizeof(struct pool_chunk) + size);
+
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+
+    return (char *) chunk->data;
+}
+
+// Return the number of granules needed to store `length` bytes.
+static size_t granules(size_t length) {
+    return (length + GRANULE - 1) / GRANULE;
+}
@@ -0,0 +1,37 @@
+// pool.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include <stddef.h>
+
+// A slab pool of fixed-size items plus an arena for strings.
+// Memory is taken from the system in large chunks;
+// released items and strings are kept on free lists for reuse,
+// and everything is returned to the system by destroy_pool.
+typedef struct pool *Pool;
+
+// Create a new Pool handing out items of `item_size` bytes.
+Pool new_pool(size_t item_size);
+
+// Destroy the given Pool, freeing every item and string in it.
+void destroy_pool(Pool pool);
+
+// Return memory for one item from the pool.
+void *pool_alloc(Pool pool);
+
+// Give an item back to the pool so it can be reused.
+void pool_release(Pool pool, void *item);
+
+// Return a copy of `string` stored in the pool's string arena.
+char *pool_strdup(Pool pool, const char *string);
+
+// Give a string returned by pool_strdup back to the pool.
+void pool_release_string(Pool pool, char *string);
+
+#endif // _POOL_H_
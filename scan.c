@@ -0,0 +1,175 @@
+// scan.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "scan.h"
+
+// The scan being run. The calling thread and `helpers` workers take
+// its chunks, in order, from next_chunk; `running` counts the
+// workers that have not yet finished with it.
+struct scan_job {
+    scan_function work;
+    void          *context;
+    int           words;
+    int           chunks;
+    int           next_chunk;
+    int           helpers;
+    int           running;
+    unsigned int  generation;
+};
+
+// Workers are started the first time a scan needs them, and then
+// wait for every later scan.
+// There is one job, so scans that use the workers hold scan_lock from
+// start to end and run one at a time; `lock` guards the job itself.
+static pthread_mutex_t scan_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t job_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t job_done = PTHREAD_COND_INITIALIZER;
+static struct scan_job job;
+// What each worker is started with: its number, to know which jobs
+// want it, and the generation of the last job before it started,
+// which it must not run.
+static struct worker_start {
+    int          number;
+    unsigned int generation;
+} starts[MAX_SCAN_THREADS];
+static int num_workers = 0;
+static int scan_threads = 0;
+
+// Make sure at least `count` workers are running.
+static void start_workers(int count);
+
+// Wait for each scan, and help run it if it wants this worker.
+static void *scan_worker(void *arg);
+
+// Take chunks of the job and scan them until there are none left.
+static void take_chunks(void);
+
+void set_scan_threads(int threads) {
+    if (threads < 1) {
+        threads = 1;
+    } else if (threads > MAX_SCAN_THREADS) {
+        threads = MAX_SCAN_THREADS;
+    }
+    scan_threads = threads;
+}
+
+int get_scan_threads(void) {
+    if (scan_threads == 0) {
+        set_scan_threads((int) sysconf(_SC_NPROCESSORS_ONLN));
+    }
+    return scan_threads;
+}
+
+int scan_chunks(int words) {
+    return (words + SCAN_CHUNK_WORDS - 1) / SCAN_CHUNK_WORDS;
+}
+
+void run_scan(int words, scan_function work, void *context) {
+    int chunks = scan_chunks(words);
+    int threads = get_scan_threads();
+    if (threads > chunks) {
+        threads = chunks;
+    }
+
+    if (threads <= 1) {
+        int chunk = 0;
+        while (chunk < chunks) {
+            int first_word = chunk * SCAN_CHUNK_WORDS;
+            int end_word = first_word + SCAN_CHUNK_WORDS;
+            work(context, chunk, first_word,
+                end_word < words ? end_word : words);
+            chunk++;
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&scan_lock);
+    start_workers(threads - 1);
+
+    pthread_mutex_lock(&lock);
+    job.work = work;
+    job.context = context;
+    job.words = words;
+    job.chunks = chunks;
+    job.next_chunk = 0;
+    job.helpers = threads - 1;
+    job.running = threads - 1;
+    job.generation++;
+    pthread_cond_broadcast(&job_ready);
+    pthread_mutex_unlock(&lock);
+
+    take_chunks();
+
+    pthread_mutex_lock(&lock);
+    while (job.running > 0) {
+        pthread_cond_wait(&job_done, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+    pthread_mutex_unlock(&scan_lock);
+}
+
+static void start_workers(int count) {
+    while (num_workers < count) {
+        pthread_t worker;
+        starts[num_workers].number = num_workers;
+        starts[num_workers].generation = job.generation;
+        if (pthread_create(&worker, NULL, scan_worker,
+                &starts[num_workers]) != 0) {
+            fprintf(stderr, "Could not start a scan thread\n");
+            exit(1);
+        }
+        pthread_detach(worker);
+        num_workers++;
+    }
+}
+
+static void *scan_worker(void *arg) {
+    struct worker_start *start = arg;
+    int number = start->number;
+    unsigned int seen = start->generation;
+
+    pthread_mutex_lock(&lock);
+    while (1) {
+        while (job.generation == seen) {
+            pthread_cond_wait(&job_ready, &lock);
+        }
+        seen = job.generation;
+        if (number >= job.helpers) {
+            continue;
+        }
+
+        pthread_mutex_unlock(&lock);
+        take_chunks();
+        pthread_mutex_lock(&lock);
+
+        job.running--;
+        if (job.running == 0) {
+            pthread_cond_signal(&job_done);
+        }
+    }
+    return NULL;
+}
+
+static void take_chunks(void) {
+    while (1) {
+        int chunk = __atomic_fetch_add(&job.next_chunk, 1, __ATOMIC_RELAXED);
+        if (chunk >= job.chunks) {
+            return;
+        }
+
+        int first_word = chunk * SCAN_CHUNK_WORDS;
+        int end_word = first_word + SCAN_CHUNK_WORDS;
+        job.work(job.context, chunk, first_word,
+            end_word < job.words ? end_word : job.words);
+    }
+}
@@ -0,0 +1,40 @@
+// scan.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _SCAN_H_
+#define _SCAN_H_
+
+// Scans over the bitsets of a Columns are split into chunks of
+// SCAN_CHUNK_WORDS words (64 rows each), which a pool of threads
+// takes in order. A scan of a single chunk, or with one thread,
+// runs on the calling thread alone.
+#define SCAN_CHUNK_WORDS 1024
+#define MAX_SCAN_THREADS 32
+
+// Scan words [first_word, end_word), which are chunk number `chunk`.
+// Different chunks may be scanned at the same time on different
+// threads, so a chunk must only write to what it alone owns.
+typedef void (*scan_function)(void *context, int chunk,
+    int first_word, int end_word);
+
+// Set how many threads (1 to MAX_SCAN_THREADS) a scan may use.
+// By default there is one per CPU.
+void set_scan_threads(int threads);
+
+// Return how many threads a scan may use.
+int get_scan_threads(void);
+
+// Return the number of chunks a scan of `words` words is split into.
+int scan_chunks(int words);
+
+// Call work on every chunk of `words` words, and return once every
+// call has returned.
+// Scans may be run from several threads, but those that use the pool
+// run one at a time, so work must not run a scan itself.
+void run_scan(int words, scan_function work, void *context);
+
+#endif // _SCAN_H_
@@ -0,0 +1,467 @@
+// server.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <assert.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "server.h"
+#include "output.h"
+#include "stats.h"
+
+#define MAX_EVENTS 256
+#define INPUT_SIZE 65536
+#define MIN_OUTPUT_SIZE 4096
+// Commands are not run for a connection while more than this much of
+// its output is waiting to be sent, and it is not read from, so a
+// client that sends commands but does not read their output only
+// holds up itself.
+#define OUTPUT_HIGH_WATER (1 << 20)
+
+// The input holds what has been read but not yet run; the output is
+// sent from output_start to output_length.
+// A connection is closed once it is `closing` (its session said so,
+// or the client will send no more) and all its output is sent.
+struct connection {
+    int               fd;
+    void              *session;
+    char              input[INPUT_SIZE];
+    int               input_length;
+    char              *output;
+    int               output_start;
+    int               output_length;
+    int               output_capacity;
+    int               end_of_input;
+    int               closing;
+    unsigned int      events;
+    struct connection *prev;
+    struct connection *next;
+};
+
+struct server {
+    int                    listen_fd;
+    int                    epoll_fd;
+    struct server_handlers *handlers;
+    struct connection      *connections;
+};
+
+static volatile sig_atomic_t stop_serving = 0;
+
+// Make the listening socket at path, or return -1.
+static int listen_on(char *path);
+
+// Set stop_serving, for SIGINT and SIGTERM.
+static void handle_stop_signal(int signal);
+
+// Accept every connection waiting on the listening socket.
+static void accept_connections(struct server *server);
+
+// Read, run commands and send output for a connection that epoll
+// says is ready, and close it if it is finished.
+static void serve_connection(struct server *server,
+    struct connection *connection, unsigned int events);
+
+// Read what the client has sent, up to the room in the input.
+// Returns 0 if the connection has failed.
+static int read_input(struct connection *connection);
+
+// Run each whole line of the input, until the connection is closing
+// or has too much output waiting. Returns 1 if there may be more lines
+// to run once output has been sent.
+static int run_lines(struct server *server, struct connection *connection);
+
+// Append output to a connection (an out_sink_function).
+static void append_output(const char *bytes, int length, void *context);
+
+// Send as much output as the socket will take.
+// Returns 0 if the connection has failed.
+static int send_output(struct connection *connection);
+
+// Return how many bytes of output are waiting to be sent.
+static int waiting_output(struct connection *connection);
+
+// Ask epoll for the events the connection now needs.
+static void watch_connection(struct server *server,
+    struct connection *connection);
+
+static void close_connection(struct server *server,
+    struct connection *connection);
+
+// Raise the limit on open files as far as it goes, for many
+// connections.
+static void raise_file_limit(void);
+
+// Serve until SIGINT or SIGTERM.
+// The signals are blocked except while waiting in epoll_pwait, so one
+// arriving between checks cannot be missed.
+int serve(char *path, struct server_handlers *handlers) {
+    raise_file_limit();
+
+    struct server server;
+    server.listen_fd = listen_on(path);
+    if (server.listen_fd < 0) {
+        return 0;
+    }
+    server.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (server.epoll_fd < 0) {
+        perror("epoll_create1");
+        close(server.listen_fd);
+        unlink(path);
+        return 0;
+    }
+    server.handlers = handlers;
+    server.connections = NULL;
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.listen_fd, &event);
+
+    sigset_t stop_signals, old_mask;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &stop_signals, &old_mask);
+    struct sigaction action, old_int, old_term;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &old_int);
+    sigaction(SIGTERM, &action, &old_term);
+
+    stop_serving = 0;
+    struct epoll_event events[MAX_EVENTS];
+    while (!stop_serving) {
+        int ready = epoll_pwait(server.epoll_fd, events, MAX_EVENTS, -1,
+            &old_mask);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                perror("epoll_pwait");
+                stop_serving = 1;
+            }
+            ready = 0;
+        }
+
+        int i = 0;
+        while (i < ready) {
+            if (events[i].data.ptr == NULL) {
+                accept_connections(&server);
+            } else {
+                serve_connection(&server, events[i].data.ptr,
+                    events[i].events);
+            }
+            i++;
+        }
+    }
+
+    while (server.connections != NULL) {
+        close_connection(&server, server.connections);
+    }
+    close(server.epoll_fd);
+    close(server.listen_fd);
+    unlink(path);
+
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+    return 1;
+}
+
+// A socket left at path by a server that did not stop cleanly is
+// replaced; anything else there is an error.
+static int listen_on(char *path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "%s: socket path is too long\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    struct stat status;
+    if (lstat(path, &status) == 0 && S_ISSOCK(status.st_mode)) {
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr *) &address, sizeof(address)) < 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    if (listen(fd, SOMAXCONN) < 0) {
+        perror("listen");
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+    return fd;
+}
+
+static void handle_stop_signal(int signal) {
+    (void) signal;
+    stop_serving = 1;
+}
+
+static void accept_connections(struct server *server) {
+    while (1) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("accept");
+            }
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+        struct connection *connection = malloc(sizeof(struct connection));
+        assert(connection != NULL);
+        STATS_ALLOC(sizeof(struct connection));
+        connection->fd = fd;
+        connection->session = server->handlers->open(server->handlers->context);
+        connection->input_length = 0;
+        connection->output = NULL;
+        connection->output_start = 0;
+        connection->output_length = 0;
+        connection->output_capacity = 0;
+        connection->end_of_input = 0;
+        connection->closing = 0;
+        connection->events = EPOLLIN;
+
+        connection->prev = NULL;
+        connection->next = server->connections;
+        if (server->connections != NULL) {
+            server->connections->prev = connection;
+        }
+        server->connections = connection;
+
+        struct epoll_event event;
+        event.events = connection->events;
+        event.data.ptr = connection;
+        epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+// Lines are run while output can be sent straight away, so a client
+// that pipelines more than fits in the input is kept going in one
+// wakeup.
+static void serve_connection(struct server *server,
+    struct connection *connection, unsigned int events) {
+
+    if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            && !read_input(connection)) {
+        close_connection(server, connection);
+        return;
+    }
+
+    int more = 1;
+    while (more) {
+        more = run_lines(server, connection);
+        if (!send_output(connection)) {
+            close_connection(server, connection);
+            return;
+        }
+        more = more && waiting_output(connection) <= OUTPUT_HIGH_WATER;
+    }
+
+    if (connection->end_of_input && connection->input_length == 0) {
+        connection->closing = 1;
+    }
+    if (connection->closing && waiting_output(connection) == 0) {
+        close_connection(server, connection);
+        return;
+    }
+    watch_connection(server, connection);
+}
+
+static int read_input(struct connection *connection) {
+    int room = INPUT_SIZE - connection->input_length;
+    if (room == 0 || connection->end_of_input) {
+        return 1;
+    }
+
+    ssize_t length = read(connection->fd,
+        &connection->input[connection->input_length], room);
+    if (length < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    if (length == 0) {
+        connection->end_of_input = 1;
+    }
+    connection->input_length += length;
+    return 1;
+}
+
+// A line is whatever comes before a newline, or SERVER_LINE_MAX - 1
+// bytes with no newline, or whatever is left at the end of input.
+static int run_lines(struct server *server, struct connection *connection) {
+    out_set_sink(append_output, connection);
+
+    int start = 0;
+    int more = 0;
+    while (!connection->closing) {
+        if (waiting_output(connection) > OUTPUT_HIGH_WATER) {
+            more = 1;
+            break;
+        }
+
+        int left = connection->input_length - start;
+        int scan = left < SERVER_LINE_MAX - 1 ? left : SERVER_LINE_MAX - 1;
+        char *newline = memchr(&connection->input[start], '\n', scan);
+        int length = scan;
+        int used = scan;
+        if (newline != NULL) {
+            length = newline - &connection->input[start];
+            used = length + 1;
+        } else if (left < SERVER_LINE_MAX - 1
+                && !(connection->end_of_input && left > 0)) {
+            break;
+        }
+
+        char line[SERVER_LINE_MAX];
+        memcpy(line, &connection->input[start], length);
+        line[length] = '\0';
+        start += used;
+
+        if (!server->handlers->command(connection->session, line)) {
+            connection->closing = 1;
+        }
+        out_char(SERVER_END_OF_OUTPUT);
+        out_flush();
+    }
+
+    out_set_sink(NULL, NULL);
+    memmove(connection->input, &connection->input[start],
+        connection->input_length - start);
+    connection->input_length -= start;
+    if (connection->closing) {
+        connection->input_length = 0;
+    }
+    return more;
+}
+
+// Sent output is dropped from the front before the buffer grows.
+static void append_output(const char *bytes, int length, void *context) {
+    struct connection *connection = context;
+
+    if (connection->output_length + length > connection->output_capacity
+            && connection->output_start > 0) {
+        memmove(connection->output,
+            &connection->output[connection->output_start],
+            connection->output_length - connection->output_start);
+        connection->output_length -= connection->output_start;
+        connection->output_start = 0;
+    }
+    if (connection->output_length + length > connection->output_capacity) {
+        int capacity = connection->output_capacity;
+        if (capacity < MIN_OUTPUT_SIZE) {
+            capacity = MIN_OUTPUT_SIZE;
+        }
+        while (capacity < connection->output_length + length) {
+            capacity *= 2;
+        }
+        connection->output = realloc(connection->output, capacity);
+        assert(connection->output != NULL);
+        STATS_ALLOC(capacity - connection->output_capacity);
+        connection->output_capacity = capacity;
+    }
+
+    memcpy(&connection->output[connection->output_length], bytes, length);
+    connection->output_length += length;
+}
+
+static int send_output(struct connection *connection) {
+    while (connection->output_start < connection->output_length) {
+        ssize_t sent = send(connection->fd,
+            &connection->output[connection->output_start],
+            connection->output_length - connection->output_start,
+            MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        connection->output_start += sent;
+    }
+
+    connection->output_start = 0;
+    connection->output_length = 0;
+    return 1;
+}
+
+static int waiting_output(struct connection *connection) {
+    return connection->output_length - connection->output_start;
+}
+
+// Input is read while there is room for it and output is not backed
+// up; output is waited for while any is left to send.
+static void watch_connection(struct server *server,
+    struct connection *connection) {
+
+    unsigned int events = 0;
+    if (!connection->closing && !connection->end_of_input
+            && connection->input_length < INPUT_SIZE
+            && waiting_output(connection) <= OUTPUT_HIGH_WATER) {
+        events |= EPOLLIN;
+    }
+    if (waiting_output(connection) > 0) {
+        events |= EPOLLOUT;
+    }
+
+    if (events != connection->events) {
+        struct epoll_event event;
+        event.events = events;
+        event.data.ptr = connection;
+        epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, connection->fd, &event);
+        connection->events = events;
+    }
+}
+
+static void close_connection(struct server *server,
+    struct connection *connection) {
+
+    server->handlers->close(connection->session);
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, connection->fd, NULL);
+    close(connection->fd);
+
+    if (connection->prev != NULL) {
+        connection->prev->next = connection->next;
+    } else {
+        server->connections = connection->next;
+    }
+    if (connection->next != NULL) {
+        connection->next->prev = connection->prev;
+    }
+    free(connection->output);
+    free(connection);
+}
+
+static void raise_file_limit(void) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0
+            && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
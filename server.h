@@ -0,0 +1,44 @@
+// server.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+// A server accepts connections on a Unix domain socket and runs the
+// commands sent on them, one per line, in one thread with a
+// non-blocking epoll loop.
+//
+// Clients may send many commands without waiting for their output
+// (pipelining): the commands of each connection are run in order, and
+// the output of each is sent back followed by one SERVER_END_OF_OUTPUT
+// byte, so a client can tell where each command's output ends.
+#define SERVER_END_OF_OUTPUT '\0'
+
+// Lines longer than SERVER_LINE_MAX - 1 bytes are split, as fgets
+// splits them.
+#define SERVER_LINE_MAX 1024
+
+// What the server calls for each connection: `open` when it connects,
+// returning the connection's session; `command` to run one line (with
+// its newline removed) for the session, with all output (see
+// output.h) going to the connection, returning 0 if the connection
+// should be closed once its output is sent; and `close` to destroy the
+// session once it is.
+struct server_handlers {
+    void *(*open)(void *context);
+    int  (*command)(void *session, char *line);
+    void (*close)(void *session);
+    void *context;
+};
+
+// Serve connections on a socket at `path` until the process gets
+// SIGINT or SIGTERM, then close them and remove the socket.
+// Returns 1, or prints why to stderr and returns 0 if the socket
+// cannot be made.
+int serve(char *path, struct server_handlers *handlers);
+
+#endif // _SERVER_H_
@@ -0,0 +1,624 @@
+// sharedpokedex.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "sharedpokedex.h"
+#include "namematch.h"
+#include "epoch.h"
+#include "stats.h"
+
+#define TURE 1
+#define FALSE 0
+#define CHUNK_SLOTS 4096
+#define MIN_CHUNKS 16
+#define MIN_INDEX_CAPACITY 64
+#define EMPTY_ENTRY 0
+#define TOMBSTONE (-1)
+#define SLOT_FOUND 1
+#define SLOT_REMOVED 2
+
+// Which names free_table frees along with a table's chunks.
+#define NO_NAMES 0
+#define REMOVED_NAMES 1
+#define ALL_NAMES 2
+
+// A Pokemon in the SharedPokedex. Everything but state is written
+// once, before the slot is published, and never changed.
+// seq is the number of Pokemon added before it, so slots are always
+// in order of seq, and a Session can find where a removed Pokemon
+// was.
+struct shared_slot {
+    uint64_t seq;
+    char     *name;
+    int      name_length;
+    int      pokemon_id;
+    double   height;
+    double   weight;
+    int      type1;
+    int      type2;
+    int      state;
+};
+
+struct slot_chunk {
+    struct shared_slot slots[CHUNK_SLOTS];
+};
+
+// The Pokemon of the SharedPokedex, in order, in chunks of slots,
+// with an open-addressing index from pokemon_id to slot position
+// (plus one, so an empty entry is 0; a removed one is TOMBSTONE).
+//
+// The writer appends slots past count, then publishes them by
+// storing count; removing marks the slot SLOT_REMOVED and its index
+// entry TOMBSTONE. Anything more (a larger index, more chunks, or
+// leaving out removed slots) is done by building a new table and
+// publishing it in place of the old one, which is retired.
+// A table made without leaving slots out shares its chunks with the
+// one it replaces; the chunks are freed with the table that leaves
+// their slots out.
+struct shared_table {
+    struct slot_chunk **chunks;
+    int               chunk_capacity;
+    int               count;
+    int               *index;
+    int               index_capacity;
+    int               index_used;
+    int               names_to_free;
+};
+
+// live and removed are the numbers of live and removed slots in the
+// current table, and are only used by the writer.
+struct shared_pokedex {
+    struct shared_table *table;
+    Epochs              epochs;
+    uint64_t            next_seq;
+    int                 live;
+    int                 removed;
+    int                 total;
+    int                 found;
+};
+
+// A Session remembers its current Pokemon by pokemon_id and seq,
+// so it can be found again in whatever table is current.
+struct session {
+    SharedPokedex shared;
+    int           participant;
+    int           has_current;
+    int           current_id;
+    uint64_t      current_seq;
+};
+
+// Create a table with room for chunk_capacity chunks and an index of
+// index_capacity entries, with no slots.
+static struct shared_table *new_table(int chunk_capacity,
+    int index_capacity);
+
+// Free a table, and its chunks and names as names_to_free says.
+static void free_table(void *object);
+
+// Return the slot at `position` in table.
+static struct shared_slot *slot_at(struct shared_table *table,
+    int position);
+
+// Return the first index entry to look at for `pokemon_id`.
+static int home_entry(int pokemon_id, int capacity);
+
+// Return the position of the slot holding pokemon_id, or -1 if there
+// is none (or it has been removed).
+static int find_position(struct shared_table *table, int pokemon_id);
+
+// Add an index entry for the slot at `position`. Only the writer
+// calls this, on a table with room in its index.
+static void index_slot(struct shared_table *table, int position);
+
+// Publish a new table in place of the current one, leaving out the
+// removed slots if `compact`, and retire the old one.
+static void replace_table(SharedPokedex shared, int compact);
+
+// Return the first position from `position`, moving by `step`, of a
+// slot that has not been removed, or -1 if there is none.
+static int find_live(struct shared_table *table, int count, int position,
+    int step);
+
+// Return the position of the first slot whose seq is after `seq`.
+static int first_after(struct shared_table *table, int count, uint64_t seq);
+
+// Return the position of the Session's current Pokemon in table,
+// moving it on if it has been removed, or -1 if there are no Pokemon.
+static int current_position(Session session, struct shared_table *table);
+
+// Make the slot at `position` the Session's current Pokemon.
+static void select_slot(Session session, struct shared_table *table,
+    int position);
+
+// Copy the slot into the end of pokedex, found.
+static void copy_slot(Pokedex pokedex, struct shared_slot *slot);
+
+// Return the current table, for a reader inside its epoch.
+static struct shared_table *read_table(Session session);
+
+// Creates a new SharedPokedex, and returns a pointer to it.
+SharedPokedex new_shared_pokedex(void) {
+    SharedPokedex shared = malloc(sizeof(struct shared_pokedex));
+    assert(shared != NULL);
+    STATS_ALLOC(sizeof(struct shared_pokedex));
+
+    shared->table = new_table(MIN_CHUNKS, MIN_INDEX_CAPACITY);
+    shared->epochs = new_epochs();
+    shared->next_seq = 0;
+    shared->live = 0;
+    shared->removed = 0;
+    shared->total = 0;
+    shared->found = 0;
+
+    return shared;
+}
+
+// Destroy the given SharedPokedex and free all associated memory.
+void destroy_shared_pokedex(SharedPokedex shared) {
+    destroy_epochs(shared->epochs);
+    shared->table->names_to_free = ALL_NAMES;
+    free_table(shared->table);
+    free(shared);
+}
+
+void shared_add_pokemon(SharedPokedex shared, Pokemon pokemon) {
+    shared_add_new_pokemon(shared, pokemon_id(pokemon),
+        pokemon_name(pokemon), pokemon_height(pokemon),
+        pokemon_weight(pokemon), pokemon_first_type(pokemon),
+        pokemon_second_type(pokemon));
+    destroy_pokemon(pokemon);
+}
+
+// Fill in the slot after the last, then index it and publish it.
+// The name is followed by NAME_MATCH_PADDING bytes for name_contains.
+void shared_add_new_pokemon(SharedPokedex shared, int pokemon_id,
+    char *name, double height, double weight, pokemon_type type1,
+    pokemon_type type2) {
+
+    epoch_reclaim(shared->epochs);
+    struct shared_table *table = shared->table;
+    if (find_position(table, pokemon_id) >= 0) {
+        fprintf(stderr,
+            "%s: There's already a Pokemon with pokemon_id %d!\n",
+            __FILE__, pokemon_id);
+        exit(1);
+    }
+
+    if (table->count == table->chunk_capacity * CHUNK_SLOTS
+            || 2 * (table->index_used + 1) > table->index_capacity) {
+        replace_table(shared, FALSE);
+        table = shared->table;
+    }
+
+    int position = table->count;
+    if (position % CHUNK_SLOTS == 0) {
+        table->chunks[position / CHUNK_SLOTS] =
+            malloc(sizeof(struct slot_chunk));
+        assert(table->chunks[position / CHUNK_SLOTS] != NULL);
+        STATS_ALLOC(sizeof(struct slot_chunk));
+    }
+
+    struct shared_slot *slot = slot_at(table, position);
+    slot->seq = shared->next_seq;
+    slot->name_length = strlen(name);
+    slot->name = calloc(slot->name_length + 1 + NAME_MATCH_PADDING, 1);
+    assert(slot->name != NULL);
+    STATS_ALLOC(slot->name_length + 1 + NAME_MATCH_PADDING);
+    memcpy(slot->name, name, slot->name_length);
+    slot->pokemon_id = pokemon_id;
+    slot->height = height;
+    slot->weight = weight;
+    slot->type1 = type1;
+    slot->type2 = type2;
+    slot->state = 0;
+
+    shared->next_seq++;
+    shared->live++;
+    __atomic_store_n(&table->count, position + 1, __ATOMIC_RELEASE);
+    index_slot(table, position);
+    __atomic_store_n(&shared->total, shared->live, __ATOMIC_RELAXED);
+}
+
+void shared_find_pokemon(SharedPokedex shared, int pokemon_id) {
+    epoch_reclaim(shared->epochs);
+    struct shared_table *table = shared->table;
+    int position = find_position(table, pokemon_id);
+    if (position < 0) {
+        return;
+    }
+
+    struct shared_slot *slot = slot_at(table, position);
+    if (!(slot->state & SLOT_FOUND)) {
+        __atomic_store_n(&slot->state, slot->state | SLOT_FOUND,
+            __ATOMIC_RELEASE);
+        __atomic_store_n(&shared->found, shared->found + 1,
+            __ATOMIC_RELAXED);
+    }
+}
+
+// Once more slots are removed than live (and at least a chunk of
+// them), the table is rebuilt without them.
+void shared_remove_pokemon(SharedPokedex shared, int pokemon_id) {
+    epoch_reclaim(shared->epochs);
+    struct shared_table *table = shared->table;
+    int position = find_position(table, pokemon_id);
+    if (position < 0) {
+        return;
+    }
+
+    struct shared_slot *slot = slot_at(table, position);
+    if (slot->state & SLOT_FOUND) {
+        __atomic_store_n(&shared->found, shared->found - 1,
+            __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&slot->state, slot->state | SLOT_REMOVED,
+        __ATOMIC_RELEASE);
+
+    int mask = table->index_capacity - 1;
+    int entry = home_entry(pokemon_id, table->index_capacity);
+    while (table->index[entry] != position + 1) {
+        entry = (entry + 1) & mask;
+    }
+    __atomic_store_n(&table->index[entry], TOMBSTONE, __ATOMIC_RELEASE);
+
+    shared->live--;
+    shared->removed++;
+    __atomic_store_n(&shared->total, shared->live, __ATOMIC_RELAXED);
+
+    if (shared->removed >= CHUNK_SLOTS && shared->removed > shared->live) {
+        replace_table(shared, TURE);
+    }
+}
+
+// Opens a new Session on the SharedPokedex, and returns a pointer
+// to it.
+Session open_session(SharedPokedex shared) {
+    Session session = malloc(sizeof(struct session));
+    assert(session != NULL);
+    STATS_ALLOC(sizeof(struct session));
+
+    session->shared = shared;
+    session->participant = epoch_register(shared->epochs);
+    session->has_current = FALSE;
+    session->current_id = 0;
+    session->current_seq = 0;
+
+    return session;
+}
+
+void close_session(Session session) {
+    epoch_unregister(session->shared->epochs, session->participant);
+    free(session);
+}
+
+int session_count_total(Session session) {
+    return __atomic_load_n(&session->shared->total, __ATOMIC_RELAXED);
+}
+
+int session_count_found(Session session) {
+    return __atomic_load_n(&session->shared->found, __ATOMIC_RELAXED);
+}
+
+// Copy every found slot whose name holds text into a new Pokedex.
+Pokedex session_search_pokemon(Session session, char *text) {
+    Pokedex result = new_pokedex();
+    int text_length = strlen(text);
+
+    struct shared_table *table = read_table(session);
+    int count = __atomic_load_n(&table->count, __ATOMIC_ACQUIRE);
+    int position = 0;
+    while (position < count) {
+        struct shared_slot *slot = slot_at(table, position);
+        int state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+        if (state == SLOT_FOUND && name_contains(slot->name,
+                slot->name_length, text, text_length)) {
+            copy_slot(result, slot);
+        }
+        position++;
+    }
+    epoch_exit(session->shared->epochs, session->participant);
+
+    return result;
+}
+
+// Copy every found slot of the type into a new Pokedex.
+Pokedex session_get_pokemon_of_type(Session session, pokemon_type type) {
+    Pokedex result = new_pokedex();
+
+    struct shared_table *table = read_table(session);
+    int count = __atomic_load_n(&table->count, __ATOMIC_ACQUIRE);
+    int position = 0;
+    while (position < count) {
+        struct shared_slot *slot = slot_at(table, position);
+        int state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+        if (state == SLOT_FOUND
+                && (slot->type1 == type || slot->type2 == type)) {
+            copy_slot(result, slot);
+        }
+        position++;
+    }
+    epoch_exit(session->shared->epochs, session->participant);
+
+    return result;
+}
+
+Pokemon session_current_pokemon(Session session) {
+    struct shared_table *table = read_table(session);
+    int position = current_position(session, table);
+    Pokemon pokemon = NULL;
+    if (position >= 0) {
+        struct shared_slot *slot = slot_at(table, position);
+        pokemon = new_pokemon(slot->pokemon_id, slot->name, slot->height,
+            slot->weight, slot->type1, slot->type2);
+    }
+    epoch_exit(session->shared->epochs, session->participant);
+
+    return pokemon;
+}
+
+void session_change_current(Session session, int pokemon_id) {
+    struct shared_table *table = read_table(session);
+    int position = find_position(table, pokemon_id);
+    if (position >= 0) {
+        select_slot(session, table, position);
+    }
+    epoch_exit(session->shared->epochs, session->participant);
+}
+
+void session_next(Session session) {
+    struct shared_table *table = read_table(session);
+    int count = __atomic_load_n(&table->count, __ATOMIC_ACQUIRE);
+    int position = current_position(session, table);
+    if (position >= 0) {
+        int next = find_live(table, count, position + 1, 1);
+        if (next >= 0) {
+            select_slot(session, table, next);
+        }
+    }
+    epoch_exit(session->shared->epochs, session->participant);
+}
+
+void session_prev(Session session) {
+    struct shared_table *table = read_table(session);
+    int count = __atomic_load_n(&table->count, __ATOMIC_ACQUIRE);
+    int position = current_position(session, table);
+    if (position >= 0) {
+        int prev = find_live(table, count, position - 1, -1);
+        if (prev >= 0) {
+            select_slot(session, table, prev);
+        }
+    }
+    epoch_exit(session->shared->epochs, session->participant);
+}
+
+static struct shared_table *new_table(int chunk_capacity,
+    int index_capacity) {
+    struct shared_table *table = malloc(sizeof(struct shared_table));
+    assert(table != NULL);
+    STATS_ALLOC(sizeof(struct shared_table));
+
+    table->chunks = calloc(chunk_capacity, sizeof(struct slot_chunk *));
+    assert(table->chunks != NULL);
+    STATS_ALLOC(chunk_capacity * sizeof(struct slot_chunk *));
+    table->chunk_capacity = chunk_capacity;
+    table->count = 0;
+    table->index = calloc(index_capacity, sizeof(int));
+    assert(table->index != NULL);
+    STATS_ALLOC(index_capacity * sizeof(int));
+    table->index_capacity = index_capacity;
+    table->index_used = 0;
+    table->names_to_free = NO_NAMES;
+
+    return table;
+}
+
+static void free_table(void *object) {
+    struct shared_table *table = object;
+    if (table->names_to_free != NO_NAMES) {
+        int position = 0;
+        while (position < table->count) {
+            struct shared_slot *slot = slot_at(table, position);
+            if (table->names_to_free == ALL_NAMES
+                    || (slot->state & SLOT_REMOVED)) {
+                free(slot->name);
+            }
+            position++;
+        }
+
+        int chunk = 0;
+        while (chunk < table->chunk_capacity) {
+            free(table->chunks[chunk]);
+            chunk++;
+        }
+    }
+
+    free(table->chunks);
+    free(table->index);
+    free(table);
+}
+
+static struct shared_slot *slot_at(struct shared_table *table,
+    int position) {
+    return &table->chunks[position / CHUNK_SLOTS]->slots[position % CHUNK_SLOTS];
+}
+
+// Fibonacci hashing, as in idindex.c.
+static int home_entry(int pokemon_id, int capacity) {
+    uint32_t hash = (uint32_t) pokemon_id * 2654435769u;
+    return (int) ((((uint64_t) hash) * (uint32_t) capacity) >> 32);
+}
+
+// Entries are loaded with acquire, so the slot an entry names is
+// seen as it was published.
+static int find_position(struct shared_table *table, int pokemon_id) {
+    int mask = table->index_capacity - 1;
+    int entry = home_entry(pokemon_id, table->index_capacity);
+
+    int value = __atomic_load_n(&table->index[entry], __ATOMIC_ACQUIRE);
+    while (value != EMPTY_ENTRY) {
+        if (value != TOMBSTONE) {
+            struct shared_slot *slot = slot_at(table, value - 1);
+            if (slot->pokemon_id == pokemon_id
+                    && !(__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE)
+                        & SLOT_REMOVED)) {
+                return value - 1;
+            }
+        }
+        entry = (entry + 1) & mask;
+        value = __atomic_load_n(&table->index[entry], __ATOMIC_ACQUIRE);
+    }
+
+    return -1;
+}
+
+// A TOMBSTONE can be reused: the id is known not to be in the index.
+static void index_slot(struct shared_table *table, int position) {
+    int mask = table->index_capacity - 1;
+    int entry = home_entry(slot_at(table, position)->pokemon_id,
+        table->index_capacity);
+    while (table->index[entry] != EMPTY_ENTRY
+            && table->index[entry] != TOMBSTONE) {
+        entry = (entry + 1) & mask;
+    }
+    if (table->index[entry] == EMPTY_ENTRY) {
+        table->index_used++;
+    }
+    __atomic_store_n(&table->index[entry], position + 1, __ATOMIC_RELEASE);
+}
+
+// The new index is at most a quarter full, and new chunk pointers
+// are only made for a compacted table.
+static void replace_table(SharedPokedex shared, int compact) {
+    struct shared_table *old = shared->table;
+
+    int index_capacity = MIN_INDEX_CAPACITY;
+    while (index_capacity < 4 * (shared->live + 1)) {
+        index_capacity *= 2;
+    }
+    int slots = compact ? shared->live : old->count;
+    int chunk_capacity = old->chunk_capacity;
+    while (chunk_capacity > MIN_CHUNKS
+            && 4 * slots < chunk_capacity * CHUNK_SLOTS) {
+        chunk_capacity /= 2;
+    }
+    while (slots + 1 > chunk_capacity * CHUNK_SLOTS) {
+        chunk_capacity *= 2;
+    }
+    struct shared_table *table = new_table(chunk_capacity, index_capacity);
+
+    int position = 0;
+    if (compact) {
+        while (position < old->count) {
+            struct shared_slot *slot = slot_at(old, position);
+            if (!(slot->state & SLOT_REMOVED)) {
+                if (table->count % CHUNK_SLOTS == 0) {
+                    table->chunks[table->count / CHUNK_SLOTS] =
+                        malloc(sizeof(struct slot_chunk));
+                    assert(table->chunks[table->count / CHUNK_SLOTS] != NULL);
+                    STATS_ALLOC(sizeof(struct slot_chunk));
+                }
+                *slot_at(table, table->count) = *slot;
+                index_slot(table, table->count);
+                table->count++;
+            }
+            position++;
+        }
+        old->names_to_free = REMOVED_NAMES;
+        shared->removed = 0;
+    } else {
+        int chunks = (old->count + CHUNK_SLOTS - 1) / CHUNK_SLOTS;
+        memcpy(table->chunks, old->chunks, chunks * sizeof(struct slot_chunk *));
+        table->count = old->count;
+        while (position < old->count) {
+            if (!(slot_at(old, position)->state & SLOT_REMOVED)) {
+                index_slot(table, position);
+            }
+            position++;
+        }
+    }
+
+    __atomic_store_n(&shared->table, table, __ATOMIC_RELEASE);
+    epoch_retire(shared->epochs, old, free_table);
+}
+
+static int find_live(struct shared_table *table, int count, int position,
+    int step) {
+    while (position >= 0 && position < count) {
+        struct shared_slot *slot = slot_at(table, position);
+        if (!(__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) & SLOT_REMOVED)) {
+            return position;
+        }
+        position += step;
+    }
+    return -1;
+}
+
+static int first_after(struct shared_table *table, int count, uint64_t seq) {
+    int low = 0;
+    int high = count;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (slot_at(table, middle)->seq <= seq) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// A removed current Pokemon moves on to the next live one after it,
+// or the last one before it, like remove_pokemon.
+static int current_position(Session session, struct shared_table *table) {
+    int count = __atomic_load_n(&table->count, __ATOMIC_ACQUIRE);
+    int position = -1;
+    if (!session->has_current) {
+        position = find_live(table, count, 0, 1);
+    } else {
+        position = find_position(table, session->current_id);
+        if (position < 0
+                || slot_at(table, position)->seq != session->current_seq) {
+            int after = first_after(table, count, session->current_seq);
+            position = find_live(table, count, after, 1);
+            if (position < 0) {
+                position = find_live(table, count, after - 1, -1);
+            }
+        }
+    }
+
+    if (position >= 0) {
+        select_slot(session, table, position);
+    }
+    return position;
+}
+
+static void select_slot(Session session, struct shared_table *table,
+    int position) {
+    struct shared_slot *slot = slot_at(table, position);
+    session->has_current = TURE;
+    session->current_id = slot->pokemon_id;
+    session->current_seq = slot->seq;
+}
+
+static void copy_slot(Pokedex pokedex, struct shared_slot *slot) {
+    add_new_pokemon(pokedex, slot->pokemon_id, slot->name, slot->height,
+        slot->weight, slot->type1, slot->type2);
+    change_current_pokemon(pokedex, slot->pokemon_id);
+    find_current_pokemon(pokedex);
+}
+
+// Enter the epoch before loading the table, so it cannot be freed
+// until epoch_exit.
+static struct shared_table *read_table(Session session) {
+    epoch_enter(session->shared->epochs, session->participant);
+    return __atomic_load_n(&session->shared->table, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,106 @@
+// sharedpokedex.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _SHAREDPOKEDEX_H_
+#define _SHAREDPOKEDEX_H_
+
+#include "pokemon.h"
+#include "pokedex.h"
+
+// A SharedPokedex is a Pokedex for one writing thread, which adds,
+// finds and removes Pokemon, and many reading threads, which query
+// it at the same time through Sessions.
+//
+// Readers never take a lock or wait for the writer: each query sees
+// the Pokedex as it was at some moment during the query. Memory the
+// writer replaces is freed through epoch-based reclamation (epoch.h)
+// once no query can still be reading it.
+typedef struct shared_pokedex *SharedPokedex;
+
+// A reading thread's view of a SharedPokedex, with its own currently
+// selected Pokemon. A Session must only be used by one thread at a
+// time, and there can be at most MAX_EPOCH_PARTICIPANTS at once.
+typedef struct session *Session;
+
+// Create a new, empty SharedPokedex and return a pointer to it.
+SharedPokedex new_shared_pokedex(void);
+
+// Destroy the given SharedPokedex and free all associated memory.
+// Every Session of it must have been closed.
+void destroy_shared_pokedex(SharedPokedex shared);
+
+// The functions below change the SharedPokedex, and must only be
+// called by one thread at a time.
+
+// Add a Pokemon to the end of the SharedPokedex.
+// The Pokemon is copied into the SharedPokedex, and destroyed.
+// Exits with an error if its pokemon_id is already in it.
+void shared_add_pokemon(SharedPokedex shared, Pokemon pokemon);
+
+// Add a new Pokemon to the end of the SharedPokedex, as
+// add_new_pokemon does.
+void shared_add_new_pokemon(SharedPokedex shared, int pokemon_id,
+    char *name, double height, double weight, pokemon_type type1,
+    pokemon_type type2);
+
+// Set the Pokemon with the ID `pokemon_id` to be found.
+// If there is no such Pokemon, this function does nothing.
+void shared_find_pokemon(SharedPokedex shared, int pokemon_id);
+
+// Remove the Pokemon with the ID `pokemon_id`.
+// If there is no such Pokemon, this function does nothing.
+void shared_remove_pokemon(SharedPokedex shared, int pokemon_id);
+
+// The functions below read the SharedPokedex through a Session, and
+// can be called by any number of threads at once, each with its own
+// Session, while the SharedPokedex is being changed.
+
+// Open a new Session on the SharedPokedex. Its currently selected
+// Pokemon is the first Pokemon.
+Session open_session(SharedPokedex shared);
+
+// Close the given Session and free all associated memory.
+void close_session(Session session);
+
+// Return the number of Pokemon in the SharedPokedex.
+int session_count_total(Session session);
+
+// Return the number of Pokemon in the SharedPokedex that have been
+// found.
+int session_count_found(Session session);
+
+// Return a new Pokedex holding a copy of every found Pokemon with
+// `text` in its name, as search_pokemon does.
+// The new Pokedex belongs to the caller, who must destroy it.
+Pokedex session_search_pokemon(Session session, char *text);
+
+// Return a new Pokedex holding a copy of every found Pokemon of
+// `type`, as get_pokemon_of_type does.
+// The new Pokedex belongs to the caller, who must destroy it.
+Pokedex session_get_pokemon_of_type(Session session, pokemon_type type);
+
+// Return a new copy of the Session's currently selected Pokemon,
+// which the caller must destroy, or NULL if the SharedPokedex is
+// empty.
+// If the selected Pokemon has been removed since it was selected,
+// the Pokemon after it (or before it, if it was the last) is
+// selected instead, as remove_pokemon does.
+Pokemon session_current_pokemon(Session session);
+
+// Change the Session's currently selected Pokemon to the one with
+// the ID `pokemon_id`. If there is none, this function does nothing.
+void session_change_current(Session session, int pokemon_id);
+
+// Move the Session's currently selected Pokemon to the next one.
+// If it is the last, this function does nothing.
+void session_next(Session session);
+
+// Move the Session's currently selected Pokemon to the previous one.
+// If it is the first, this function does nothing.
+void session_prev(Session session);
+
+#endif // _SHAREDPOKEDEX_H_
@@ -0,0 +1,405 @@
+// snapshot.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <assert.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "snapshot.h"
+#include "pokemon.h"
+#include "stats.h"
+
+#define SNAPSHOT_MAGIC "PKDXSNAP"
+#define MAX_PATH 4096
+
+struct snapshot_writer {
+    struct snapshot_record *records;
+    uint64_t               *found;
+    struct snapshot_edge   *edges;
+    char                   *names;
+    uint32_t               count;
+    uint32_t               record_capacity;
+    uint32_t               edge_count;
+    uint32_t               edge_capacity;
+    uint64_t               names_size;
+    uint64_t               names_capacity;
+};
+
+// The sizes of the sections of a snapshot.
+struct section_sizes {
+    uint64_t records;
+    uint64_t found;
+    uint64_t edges;
+    uint64_t names;
+};
+
+// Work out the sizes of the sections described by a header.
+static struct section_sizes section_sizes(const struct snapshot_header *header);
+
+// Return why the records of a snapshot cannot be loaded, or NULL.
+static char *check_records(Snapshot snapshot, uint64_t names_size);
+
+// Compare two ids for qsort.
+static int compare_ids(const void *a, const void *b);
+
+// Round size up to a multiple of 8 bytes.
+static uint64_t align_8(uint64_t size);
+
+// Return a 64-bit FNV-1a checksum of the sections, taken 8 bytes at a time.
+static uint64_t checksum(const void *data, uint64_t size, uint64_t hash);
+
+// Return the checksum of the fields of a header that describe the
+// sections, from version to names_size, to continue over the sections.
+static uint64_t header_checksum(const struct snapshot_header *header);
+
+// Write size bytes, then zero padding up to an 8-byte boundary.
+static int write_section(FILE *file, const void *data, uint64_t size);
+
+// Return p resized to count elements of size bytes.
+static void *resize(void *p, uint64_t count, uint64_t size);
+
+// Creates a new SnapshotWriter, and returns a pointer to it.
+SnapshotWriter new_snapshot_writer(void) {
+    SnapshotWriter writer = calloc(1, sizeof(struct snapshot_writer));
+    assert(writer != NULL);
+    STATS_ALLOC(sizeof(struct snapshot_writer));
+    return writer;
+}
+
+// Add a record, with its name and found status, to the snapshot.
+void snapshot_add_record(SnapshotWriter writer,
+    struct snapshot_record record, const char *name, int found) {
+
+    if (writer->count == writer->record_capacity) {
+        uint32_t old_words = (writer->record_capacity + 63) / 64;
+        writer->record_capacity = writer->record_capacity == 0
+            ? 1024 : writer->record_capacity * 2;
+        uint32_t words = (writer->record_capacity + 63) / 64;
+
+        writer->records = resize(writer->records, writer->record_capacity,
+            sizeof(struct snapshot_record));
+        writer->found = resize(writer->found, words, sizeof(uint64_t));
+        memset(writer->found + old_words, 0,
+            (words - old_words) * sizeof(uint64_t));
+    }
+
+    uint64_t length = strlen(name) + 1;
+    while (writer->names_size + length > writer->names_capacity) {
+        writer->names_capacity = writer->names_capacity == 0
+            ? 65536 : writer->names_capacity * 2;
+        writer->names = resize(writer->names, writer->names_capacity, 1);
+    }
+
+    record.name = writer->names_size;
+    record.unused = 0;
+    memcpy(writer->names + writer->names_size, name, length);
+    writer->names_size += length;
+
+    if (found) {
+        writer->found[writer->count >> 6] |= (uint64_t) 1 << (writer->count & 63);
+    }
+    writer->records[writer->count] = record;
+    writer->count++;
+}
+
+// Add an evolution to the snapshot.
+void snapshot_add_edge(SnapshotWriter writer, int from_id, int to_id) {
+    if (writer->edge_count == writer->edge_capacity) {
+        writer->edge_capacity = writer->edge_capacity == 0
+            ? 256 : writer->edge_capacity * 2;
+        writer->edges = resize(writer->edges, writer->edge_capacity,
+            sizeof(struct snapshot_edge));
+    }
+
+    writer->edges[writer->edge_count].from = from_id;
+    writer->edges[writer->edge_count].to = to_id;
+    writer->edge_count++;
+}
+
+// Write the snapshot to a temporary file next to `path`, sync it,
+// then rename it over `path`, and destroy the writer.
+int finish_snapshot(SnapshotWriter writer, const char *path,
+    uint32_t current) {
+    struct snapshot_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.count = writer->count;
+    header.edge_count = writer->edge_count;
+    header.current = current;
+    header.names_size = writer->names_size;
+
+    struct section_sizes sizes = section_sizes(&header);
+    uint64_t hash = checksum(writer->records, sizes.records,
+        header_checksum(&header));
+    hash = checksum(writer->found, sizes.found, hash);
+    hash = checksum(writer->edges, sizes.edges, hash);
+    hash = checksum(writer->names, sizes.names, hash);
+    header.checksum = hash;
+
+    char temp_path[MAX_PATH];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    int ok = 0;
+    FILE *file = fopen(temp_path, "wb");
+    if (file != NULL) {
+        ok = fwrite(&header, sizeof(header), 1, file) == 1
+            && write_section(file, writer->records, sizes.records)
+            && write_section(file, writer->found, sizes.found)
+            && write_section(file, writer->edges, sizes.edges)
+            && write_section(file, writer->names, sizes.names);
+        ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+        ok = fclose(file) == 0 && ok;
+        ok = ok && rename(temp_path, path) == 0;
+        if (!ok) {
+            unlink(temp_path);
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    }
+
+    free(writer->records);
+    free(writer->found);
+    free(writer->edges);
+    free(writer->names);
+    free(writer);
+    return ok;
+}
+
+// Map the snapshot at `path` into memory,
+// and check its header, size, checksum and records.
+Snapshot map_snapshot(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || info.st_size < (off_t) sizeof(struct snapshot_header)) {
+        fprintf(stderr, "%s: not a Pokedex snapshot\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    Snapshot snapshot = malloc(sizeof(struct snapshot));
+    assert(snapshot != NULL);
+    STATS_ALLOC(sizeof(struct snapshot));
+    snapshot->map = map;
+    snapshot->map_size = info.st_size;
+    snapshot->header = map;
+
+    const struct snapshot_header *header = snapshot->header;
+    char *problem = NULL;
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) {
+        problem = "not a Pokedex snapshot";
+    } else if (header->version != SNAPSHOT_VERSION) {
+        problem = "unsupported snapshot version";
+    }
+
+    struct section_sizes sizes = section_sizes(header);
+    uint64_t body = align_8(sizes.records) + align_8(sizes.found)
+        + align_8(sizes.edges) + align_8(sizes.names);
+    if (problem == NULL && sizeof(*header) + body != snapshot->map_size) {
+        problem = "snapshot is truncated";
+    }
+
+    if (problem == NULL) {
+        const char *section = (const char *) map + sizeof(*header);
+        snapshot->records = (const struct snapshot_record *) section;
+        section += align_8(sizes.records);
+        snapshot->found = (const uint64_t *) section;
+        section += align_8(sizes.found);
+        snapshot->edges = (const struct snapshot_edge *) section;
+        section += align_8(sizes.edges);
+        snapshot->names = section;
+
+        uint64_t hash = checksum(snapshot->records, sizes.records,
+            header_checksum(header));
+        hash = checksum(snapshot->found, sizes.found, hash);
+        hash = checksum(snapshot->edges, sizes.edges, hash);
+        hash = checksum(snapshot->names, sizes.names, hash);
+        if (hash != header->checksum) {
+            problem = "snapshot checksum does not match";
+        } else if (sizes.names > 0 && snapshot->names[sizes.names - 1] != '\0') {
+            problem = "snapshot names are not terminated";
+        } else if (header->count > 0 ? header->current >= header->count
+                : header->current != NO_CURRENT_RECORD) {
+            problem = "snapshot current record is out of range";
+        }
+        if (problem == NULL) {
+            problem = check_records(snapshot, sizes.names);
+        }
+    }
+
+    if (problem != NULL) {
+        fprintf(stderr, "%s: %s\n", path, problem);
+        unmap_snapshot(snapshot);
+        return NULL;
+    }
+
+    return snapshot;
+}
+
+// Write the mapped file to a temporary file next to `path`, sync it,
+// then rename it over `path`.
+int copy_snapshot(Snapshot snapshot, const char *path) {
+    char temp_path[MAX_PATH];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    int ok = 0;
+    FILE *file = fopen(temp_path, "wb");
+    if (file != NULL) {
+        ok = fwrite(snapshot->map, 1, snapshot->map_size, file)
+            == snapshot->map_size;
+        ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+        ok = fclose(file) == 0 && ok;
+        ok = ok && rename(temp_path, path) == 0;
+        if (!ok) {
+            unlink(temp_path);
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    }
+
+    return ok;
+}
+
+// Unmap a snapshot returned by map_snapshot.
+void unmap_snapshot(Snapshot snapshot) {
+    munmap(snapshot->map, snapshot->map_size);
+    free(snapshot);
+}
+
+// Check every record before the snapshot is used, so that loading it
+// cannot fail half way: each name must be in the names section, each
+// id must be valid and distinct, and the types must be ones a Pokemon
+// can be made with.
+static char *check_records(Snapshot snapshot, uint64_t names_size) {
+    uint32_t count = snapshot->header->count;
+    int32_t *ids = malloc(((uint64_t) count + 1) * sizeof(int32_t));
+    assert(ids != NULL);
+    STATS_ALLOC(((uint64_t) count + 1) * sizeof(int32_t));
+
+    char *problem = NULL;
+    uint32_t i = 0;
+    while (problem == NULL && i < count) {
+        const struct snapshot_record *record = &snapshot->records[i];
+        if (record->name >= names_size) {
+            problem = "snapshot name is out of range";
+        } else if (record->id < 0) {
+            problem = "snapshot has an invalid pokemon_id";
+        } else if (record->type1 == NONE_TYPE || record->type1 >= MAX_TYPE
+                || record->type2 >= MAX_TYPE
+                || record->type1 == record->type2) {
+            problem = "snapshot has an invalid type";
+        }
+        ids[i] = record->id;
+        i++;
+    }
+
+    if (problem == NULL) {
+        qsort(ids, count, sizeof(int32_t), compare_ids);
+        i = 1;
+        while (problem == NULL && i < count) {
+            if (ids[i] == ids[i - 1]) {
+                problem = "snapshot has a duplicate pokemon_id";
+            }
+            i++;
+        }
+    }
+
+    free(ids);
+    return problem;
+}
+
+// Compare two ids for qsort.
+static int compare_ids(const void *a, const void *b) {
+    int32_t x = *(const int32_t *) a;
+    int32_t y = *(const int32_t *) b;
+    return (x > y) - (x < y);
+}
+
+// Work out the sizes of the sections described by a header.
+static struct section_sizes section_sizes(const struct snapshot_header *header) {
+    struct section_sizes sizes;
+    sizes.records = (uint64_t) header->count * sizeof(struct snapshot_record);
+    sizes.found = (uint64_t) (header->count + 63) / 64 * sizeof(uint64_t);
+    sizes.edges = (uint64_t) header->edge_count * sizeof(struct snapshot_edge);
+    sizes.names = header->names_size;
+    return sizes;
+}
+
+// Round size up to a multiple of 8 bytes.
+static uint64_t align_8(uint64_t size) {
+    return (size + 7) & ~(uint64_t) 7;
+}
+
+// Return a 64-bit FNV-1a checksum of data, continuing from hash
+// (0 to start), taken 8 bytes at a time so it keeps up with mmap.
+static uint64_t checksum(const void *data, uint64_t size, uint64_t hash) {
+    if (hash == 0) {
+        hash = 14695981039346656037ull;
+    }
+
+    const unsigned char *bytes = data;
+    uint64_t i = 0;
+    while (i + 8 <= size) {
+        uint64_t word;
+        memcpy(&word, &bytes[i], sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+        i += 8;
+    }
+    while (i < size) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+        i++;
+    }
+
+    return hash;
+}
+
+// Return the checksum of the fields of a header that describe the
+// sections, which lie together from version to names_size.
+static uint64_t header_checksum(const struct snapshot_header *header) {
+    return checksum(&header->version,
+        offsetof(struct snapshot_header, checksum)
+        - offsetof(struct snapshot_header, version), 0);
+}
+
+// Write size bytes, then zero padding up to an 8-byte boundary.
+static int write_section(FILE *file, const void *data, uint64_t size) {
+    static const char padding[8] = {0};
+    if (size > 0 && fwrite(data, 1, size, file) != size) {
+        return 0;
+    }
+    uint64_t extra = align_8(size) - size;
+    return extra == 0 || fwrite(padding, 1, extra, file) == extra;
+}
+
+// Return p resized to count elements of size bytes.
+static void *resize(void *p, uint64_t count, uint64_t size) {
+    p = realloc(p, count * size);
+    assert(p != NULL);
+    STATS_ALLOC(count * size);
+    return p;
+}
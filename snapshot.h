@@ -0,0 +1,103 @@
+// snapshot.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include <stdint.h>
+
+// A snapshot file holds a whole Pokedex in native byte order:
+//
+//   header      struct snapshot_header
+//   records     struct snapshot_record[count], in Pokedex order
+//   found       uint64_t[(count + 63) / 64], bit i set if record i is found
+//   edges       struct snapshot_edge[edge_count]
+//   names       names_size bytes of '\0'-terminated names
+//
+// current is the record of the currently selected Pokemon,
+// or NO_CURRENT_RECORD if (and only if) the Pokedex is empty.
+// The checksum covers the header from version to names_size, then
+// everything after the header.
+// Sections start on 8-byte boundaries, so a mapped file can be read
+// in place.
+
+#define SNAPSHOT_VERSION 2
+#define NO_CURRENT_RECORD UINT32_MAX
+
+struct snapshot_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint32_t edge_count;
+    uint32_t current;
+    uint64_t names_size;
+    uint64_t checksum;
+};
+
+struct snapshot_record {
+    int32_t  id;
+    uint8_t  type1;
+    uint8_t  type2;
+    uint16_t unused;
+    uint32_t name;
+    double   height;
+    double   weight;
+};
+
+// An evolution from the Pokemon with id `from` to the one with id `to`.
+struct snapshot_edge {
+    int32_t from;
+    int32_t to;
+};
+
+// A snapshot file mapped into memory.
+struct snapshot {
+    void                         *map;
+    uint64_t                     map_size;
+    const struct snapshot_header *header;
+    const struct snapshot_record *records;
+    const uint64_t               *found;
+    const struct snapshot_edge   *edges;
+    const char                   *names;
+};
+
+typedef struct snapshot *Snapshot;
+
+// Collects the contents of a snapshot before it is written.
+typedef struct snapshot_writer *SnapshotWriter;
+
+// Create a new, empty SnapshotWriter.
+SnapshotWriter new_snapshot_writer(void);
+
+// Add a record, with its name and found status, to the snapshot.
+void snapshot_add_record(SnapshotWriter writer,
+    struct snapshot_record record, const char *name, int found);
+
+// Add an evolution to the snapshot.
+void snapshot_add_edge(SnapshotWriter writer, int from_id, int to_id);
+
+// Write the snapshot to `path`, and destroy the writer.
+// The file is written and synced next to `path` and renamed into
+// place, so a snapshot being read from `path` is never overwritten.
+// Returns 1 on success, or prints why and returns 0.
+int finish_snapshot(SnapshotWriter writer, const char *path,
+    uint32_t current);
+
+// Map the snapshot at `path` into memory and check it, including
+// that its records have valid, distinct ids and valid types.
+// Returns NULL, after printing why, if it cannot be used.
+Snapshot map_snapshot(const char *path);
+
+// Write a copy of a mapped snapshot to `path`, replacing it as
+// finish_snapshot does.
+// Returns 1 on success, or prints why and returns 0.
+int copy_snapshot(Snapshot snapshot, const char *path);
+
+// Unmap a snapshot returned by map_snapshot.
+void unmap_snapshot(Snapshot snapshot);
+
+#endif // _SNAPSHOT_H_
@@ -0,0 +1,235 @@
+// stats.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifdef POKEDEX_STATS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <assert.h>
+
+#include "stats.h"
+#include "output.h"
+
+#define MAX_COMMANDS 128
+// Commands nested deeper than this (views of views of ...) are
+// charged to the deepest one recorded.
+#define MAX_DEPTH 64
+
+// Latencies go in HDR-style log-linear buckets: below 2 * SUB_BUCKETS
+// nanoseconds every value has its own bucket, and above that each
+// power of two is split into SUB_BUCKETS buckets, so a bucket is
+// within 1 / SUB_BUCKETS (6.25%) of the values in it.
+#define SUB_BUCKET_BITS 4
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+// Latencies of 2^MAX_MAGNITUDE ns (about 18 minutes) or more
+// go in the last bucket.
+#define MAX_MAGNITUDE 40
+#define NUM_BUCKETS ((MAX_MAGNITUDE - SUB_BUCKET_BITS + 1) * SUB_BUCKETS)
+
+struct command_stats {
+    long long             calls;
+    struct stats_counters counters;
+    long long             total_ns;
+    long long             max_ns;
+    long long             *histogram;
+};
+
+// A command that is running.
+// Time and counters while it is paused are not charged to it.
+struct frame {
+    int                   command;
+    long long             start_ns;
+    struct stats_counters start;
+    long long             paused_ns;
+    struct stats_counters paused;
+    long long             pause_start_ns;
+    struct stats_counters pause_start;
+};
+
+struct stats_counters stats_counters;
+
+static struct command_stats commands[MAX_COMMANDS];
+static struct frame frames[MAX_DEPTH];
+static int depth = 0;
+
+// Return a monotonic timestamp in nanoseconds.
+static long long now_ns(void);
+
+// Return the histogram bucket of a latency of `ns` nanoseconds.
+static int bucket_of(long long ns);
+
+// Return the largest latency that goes in `bucket`.
+static long long bucket_max(int bucket);
+
+// Return the latency below which `percent` of the calls of a command
+// fall, to within its bucket.
+static long long percentile(struct command_stats *stats, double percent);
+
+// Return `a` - `b`, counter by counter.
+static struct stats_counters counters_minus(struct stats_counters a,
+    struct stats_counters b);
+
+void stats_begin_command(int command) {
+    if (depth < MAX_DEPTH) {
+        struct frame *frame = &frames[depth];
+        frame->command = command;
+        frame->paused_ns = 0;
+        frame->paused = (struct stats_counters) {0};
+        frame->start = stats_counters;
+        frame->start_ns = now_ns();
+    }
+    depth++;
+}
+
+void stats_end_command(void) {
+    long long end_ns = now_ns();
+    depth--;
+    if (depth >= MAX_DEPTH) {
+        return;
+    }
+
+    struct frame *frame = &frames[depth];
+    if (frame->command <= 0 || frame->command >= MAX_COMMANDS) {
+        return;
+    }
+
+    struct command_stats *stats = &commands[frame->command];
+    if (stats->histogram == NULL) {
+        stats->histogram = calloc(NUM_BUCKETS, sizeof(long long));
+        assert(stats->histogram != NULL);
+    }
+
+    long long ns = end_ns - frame->start_ns - frame->paused_ns;
+    struct stats_counters used = counters_minus(
+        counters_minus(stats_counters, frame->start), frame->paused);
+
+    stats->calls++;
+    stats->counters.visited += used.visited;
+    stats->counters.allocs += used.allocs;
+    stats->counters.bytes += used.bytes;
+    stats->total_ns += ns;
+    if (ns > stats->max_ns) {
+        stats->max_ns = ns;
+    }
+    stats->histogram[bucket_of(ns)]++;
+}
+
+void stats_pause(void) {
+    if (depth == 0 || depth > MAX_DEPTH) {
+        return;
+    }
+
+    struct frame *frame = &frames[depth - 1];
+    frame->pause_start = stats_counters;
+    frame->pause_start_ns = now_ns();
+}
+
+void stats_resume(void) {
+    if (depth == 0 || depth > MAX_DEPTH) {
+        return;
+    }
+
+    struct frame *frame = &frames[depth - 1];
+    frame->paused_ns += now_ns() - frame->pause_start_ns;
+    struct stats_counters used = counters_minus(stats_counters,
+        frame->pause_start);
+    frame->paused.visited += used.visited;
+    frame->paused.allocs += used.allocs;
+    frame->paused.bytes += used.bytes;
+}
+
+void stats_print(void) {
+    out_printf(""
+        "===========================[ Stats ]============================\n"
+    );
+    out_printf("%3s %9s %11s %9s %11s %9s %9s %9s %9s\n", "cmd", "calls",
+        "visited", "allocs", "bytes", "mean ns", "p50 ns", "p99 ns",
+        "max ns");
+
+    int command = 1;
+    while (command < MAX_COMMANDS) {
+        struct command_stats *stats = &commands[command];
+        if (stats->calls > 0) {
+            out_printf("%3c %9lld %11lld %9lld %11lld %9lld %9lld %9lld "
+                "%9lld\n", command, stats->calls, stats->counters.visited,
+                stats->counters.allocs, stats->counters.bytes,
+                stats->total_ns / stats->calls, percentile(stats, 50),
+                percentile(stats, 99), stats->max_ns);
+        }
+        command++;
+    }
+
+    out_printf("Total: %lld visited, %lld allocations, %lld bytes\n",
+        stats_counters.visited, stats_counters.allocs, stats_counters.bytes);
+}
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int bucket_of(long long ns) {
+    if (ns < 2 * SUB_BUCKETS) {
+        return ns < 0 ? 0 : (int) ns;
+    }
+    if (ns >= (1LL << MAX_MAGNITUDE)) {
+        return NUM_BUCKETS - 1;
+    }
+
+    int magnitude = 63 - __builtin_clzll((unsigned long long) ns);
+    int shift = magnitude - SUB_BUCKET_BITS;
+    int top = (int) (ns >> shift);
+    return (shift + 1) * SUB_BUCKETS + (top - SUB_BUCKETS);
+}
+
+static long long bucket_max(int bucket) {
+    if (bucket < 2 * SUB_BUCKETS) {
+        return bucket;
+    }
+
+    int shift = bucket / SUB_BUCKETS - 1;
+    long long top = SUB_BUCKETS + bucket % SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+static long long percentile(struct command_stats *stats, double percent) {
+    double exact = stats->calls * percent / 100;
+    long long wanted = (long long) exact;
+    if (wanted < exact) {
+        wanted++;
+    }
+    if (wanted < 1) {
+        wanted = 1;
+    }
+
+    long long seen = 0;
+    int bucket = 0;
+    while (bucket < NUM_BUCKETS) {
+        seen += stats->histogram[bucket];
+        if (seen >= wanted) {
+            long long value = bucket_max(bucket);
+            return value < stats->max_ns ? value : stats->max_ns;
+        }
+        bucket++;
+    }
+    return stats->max_ns;
+}
+
+static struct stats_counters counters_minus(struct stats_counters a,
+    struct stats_counters b) {
+
+    struct stats_counters result = {
+        a.visited - b.visited,
+        a.allocs - b.allocs,
+        a.bytes - b.bytes
+    };
+    return result;
+}
+
+#endif // POKEDEX_STATS
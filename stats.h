@@ -0,0 +1,60 @@
+// stats.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _STATS_H_
+#define _STATS_H_
+
+// Counters and latency histograms for each command, to see where the
+// time of a slow command went.
+// They are only compiled in when POKEDEX_STATS is defined; otherwise
+// the STATS_ macros are empty and nothing here exists.
+
+#ifdef POKEDEX_STATS
+
+struct stats_counters {
+    long long visited;
+    long long allocs;
+    long long bytes;
+};
+
+// Everything counted since the program started.
+// Each command is charged with what it adds to these.
+extern struct stats_counters stats_counters;
+
+// Count `count` Pokemon nodes (or rows) looked at.
+#define STATS_VISIT(count) (stats_counters.visited += (count))
+
+// Count an allocation of `size` bytes.
+#define STATS_ALLOC(size) \
+    (stats_counters.allocs++, stats_counters.bytes += (size))
+
+// Start charging time and counters to `command` (a command letter).
+// Commands may run inside other commands (in a view's Pokedex);
+// the inner command is charged, not the outer one.
+void stats_begin_command(int command);
+
+// Stop charging the command started last, and record it.
+void stats_end_command(void);
+
+// Stop charging the running command while a view's Pokedex is
+// explored, and start again.
+void stats_pause(void);
+void stats_resume(void);
+
+// Print the calls, counters and latency percentiles of each command.
+void stats_print(void);
+
+#else
+
+// The arguments are still evaluated (for nothing), so what is only
+// computed to be counted is not left unused.
+#define STATS_VISIT(count) ((void) (count))
+#define STATS_ALLOC(size) ((void) (size))
+
+#endif // POKEDEX_STATS
+
+#endif // _STATS_H_
@@ -0,0 +1,161 @@
+// accessors.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+//
+// Prints what the Pokemon accessors return for Pokemon made in every
+// way the library makes them. `make test` builds it with the inline
+// accessors (release) and the checked ones (debug), and both must
+// print tests/accessors.out.
+
+#include <stdio.h>
+
+#include "pokemon.h"
+#include "pokedex.h"
+#include "pool.h"
+
+// Print every accessor of pokemon on one line, after `label`.
+static void print_accessors(char *label, Pokemon pokemon);
+
+// Print the accessors of every Pokemon in Pokedex, in order.
+static void print_pokedex(char *label, Pokedex pokedex);
+
+// Add the Pokemon the Pokedex tests run over.
+static void add_test_pokemon(Pokedex pokedex);
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s snapshot-path\n", argv[0]);
+        return 1;
+    }
+
+    // Made on their own.
+    Pokemon pokemon = new_pokemon(25, "Pikachu", 0.4, 6.0,
+        ELECTRIC_TYPE, NONE_TYPE);
+    print_accessors("new", pokemon);
+    Pokemon clone = clone_pokemon(pokemon);
+    print_accessors("clone", clone);
+    destroy_pokemon(pokemon);
+    destroy_pokemon(clone);
+
+    // Made in a pool.
+    Pool pool = new_pokemon_pool();
+    pokemon = pool_new_pokemon(pool, 6, "Charizard", 1.7, 90.5,
+        FIRE_TYPE, FLYING_TYPE);
+    print_accessors("pool", pokemon);
+    clone = pool_clone_pokemon(pool, pokemon);
+    print_accessors("pool clone", clone);
+    char name[] = "Mr Mime";
+    Pokemon borrowed = pool_new_pokemon_borrowed_name(pool, 122, name,
+        1.3, 54.5, PSYCHIC_TYPE, FAIRY_TYPE);
+    print_accessors("borrowed", borrowed);
+    pool_destroy_pokemon(pool, pokemon);
+    pool_destroy_pokemon(pool, clone);
+    pool_destroy_pokemon_borrowed_name(pool, borrowed);
+    destroy_pool(pool);
+
+    // Made by a Pokedex, and by each way of making a Pokedex from one.
+    Pokedex pokedex = new_pokedex();
+    add_test_pokemon(pokedex);
+    print_pokedex("pokedex", pokedex);
+
+    Pokedex copy = copy_pokedex(pokedex);
+    print_pokedex("copy", copy);
+    destroy_pokedex(copy);
+
+    Pokedex view = get_pokemon_of_type(pokedex, WATER_TYPE);
+    print_pokedex("type view", view);
+    destroy_pokedex(view);
+
+    view = search_pokemon(pokedex, "sa");
+    print_pokedex("search view", view);
+    destroy_pokedex(view);
+
+    if (!save_pokedex(pokedex, argv[1])) {
+        return 1;
+    }
+    Pokedex loaded = new_pokedex();
+    if (!load_pokedex(loaded, argv[1])) {
+        return 1;
+    }
+    print_pokedex("loaded", loaded);
+    destroy_pokedex(loaded);
+    destroy_pokedex(pokedex);
+
+    // Types by name, and names by type.
+    char *type_names[] = {
+        "Fire", "fire", "FIRE", "None", "Fairy", "Dragon", "", "Fir",
+        NULL
+    };
+    int i = 0;
+    while (type_names[i] != NULL) {
+        printf("type \"%s\": %d\n", type_names[i],
+            pokemon_type_from_string(type_names[i]));
+        i++;
+    }
+    pokemon_type type = NONE_TYPE;
+    while (type < MAX_TYPE) {
+        printf("type %d: %s\n", type, pokemon_type_to_string(type));
+        type++;
+    }
+
+    // Names.
+    char *names[] = {
+        "Pikachu", "Mr Mime", "Ho-Oh", "", "Pika2", "Pika_", NULL
+    };
+    i = 0;
+    while (names[i] != NULL) {
+        printf("name \"%s\": %d\n", names[i], pokemon_valid_name(names[i]));
+        i++;
+    }
+
+    return 0;
+}
+
+// Print every accessor of pokemon on one line, after `label`.
+// Heights and weights are printed exactly.
+static void print_accessors(char *label, Pokemon pokemon) {
+    printf("%s: %d %s %a %a %s %s\n", label, pokemon_id(pokemon),
+        pokemon_name(pokemon), pokemon_height(pokemon),
+        pokemon_weight(pokemon),
+        pokemon_type_to_string(pokemon_first_type(pokemon)),
+        pokemon_type_to_string(pokemon_second_type(pokemon)));
+}
+
+// Print the accessors of every Pokemon in Pokedex, in order.
+static void print_pokedex(char *label, Pokedex pokedex) {
+    int total = count_total_pokemon(pokedex);
+    change_current_position(pokedex, 0);
+    int i = 0;
+    while (i < total) {
+        print_accessors(label, get_current_pokemon(pokedex));
+        next_pokemon(pokedex);
+        i++;
+    }
+}
+
+// Add the Pokemon the Pokedex tests run over.
+static void add_test_pokemon(Pokedex pokedex) {
+    add_new_pokemon(pokedex, 7, "Squirtle", 0.5, 9.0,
+        WATER_TYPE, NONE_TYPE);
+    add_new_pokemon(pokedex, 1, "Bulbasaur", 0.7, 6.9,
+        GRASS_TYPE, POISON_TYPE);
+    add_new_pokemon(pokedex, 130, "Gyarados", 6.5, 235.0,
+        WATER_TYPE, FLYING_TYPE);
+    add_new_pokemon(pokedex, 0, "Missingno", 3.3, 1590.8,
+        NORMAL_TYPE, NONE_TYPE);
+    add_new_pokemon(pokedex, 2147483647, "Last", 1e-3, 1e30,
+        DRAGON_TYPE, STEEL_TYPE);
+    add_pokemon_evolution(pokedex, 1, 7);
+
+    // Views only hold Pokemon that have been found.
+    int found[] = {7, 1, 130};
+    int i = 0;
+    while (i < 3) {
+        change_current_pokemon(pokedex, found[i]);
+        find_current_pokemon(pokedex);
+        i++;
+    }
+}
@@ -0,0 +1,101 @@
+// client.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+//
+// Sends the commands on stdin, one per line, to the Pokedex server
+// (pokedex -s socket) and prints the output of each, waiting for it
+// before sending the next. Stops at the end of stdin, or when the
+// server closes the connection.
+// Usage: ./client socket < commands
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "server.h"
+
+// Connect to the server at path. Returns the socket, or -1.
+static int connect_to(char *path);
+
+// Send length bytes to fd. Returns 1, or 0 if they could not be sent.
+static int send_all(int fd, char *bytes, int length);
+
+// Print the output of one command from fd, up to the
+// SERVER_END_OF_OUTPUT byte after it.
+// Returns 1, or 0 if the connection closed first.
+static int print_output(int fd);
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s socket < commands\n", argv[0]);
+        return 1;
+    }
+
+    int fd = connect_to(argv[1]);
+    if (fd < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    char line[SERVER_LINE_MAX];
+    int open = 1;
+    while (open && fgets(line, sizeof(line), stdin) != NULL) {
+        int length = strlen(line);
+        if (length == 0 || line[length - 1] != '\n') {
+            line[length] = '\n';
+            length++;
+        }
+        open = send_all(fd, line, length) && print_output(fd);
+    }
+
+    close(fd);
+    return 0;
+}
+
+static int connect_to(char *path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr *) &address,
+            sizeof(address)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+static int send_all(int fd, char *bytes, int length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return 0;
+        }
+        bytes += sent;
+        length -= sent;
+    }
+    return 1;
+}
+
+static int print_output(int fd) {
+    char c;
+    while (read(fd, &c, 1) == 1) {
+        if (c == SERVER_END_OF_OUTPUT) {
+            fflush(stdout);
+            return 1;
+        }
+        putchar(c);
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#!/bin/sh
+# journal.sh
+#
+# This program was written by Zrx
+# on 18 Oct 2026
+#
+# Version 1.0.0: Release
+#
+# Checks the journal of the pokedex CLI in build directory $1.
+# Usage: tests/journal.sh build/release
+
+build=$1
+dir=$build/journal-test
+rm -rf "$dir"
+mkdir -p "$dir"
+
+fail() {
+    echo "FAIL: journal: $1"
+    exit 1
+}
+
+# 100 adds, each committed on its own.
+i=0
+while [ $i -lt 100 ]; do
+    echo "a $i Abcdefghij 1 1 Fire"
+    i=$((i + 1))
+done > "$dir/adds.txt"
+
+# A commit that cannot be written must end the process with status 1,
+# not hang. Files are limited to 1024 bytes, and SIGXFSZ is ignored
+# so the write fails instead.
+(
+    trap '' XFSZ
+    ulimit -f 2
+    timeout 10 "$build/pokedex" -b -j "$dir/full.log" -g 0 \
+        < "$dir/adds.txt" > /dev/null 2> "$dir/full.err"
+)
+status=$?
+[ $status -eq 1 ] || fail "commit failure exited with status $status"
+grep -q "File too large" "$dir/full.err" \
+    || fail "commit failure printed: $(cat "$dir/full.err")"
+
+# Recover the Pokedex made by the adds, finding and evolving some of
+# them, from journal $1, and print what it holds.
+recover() {
+    printf 'p\nt\nc\nd\nm 1\ns\n' | "$build/pokedex" -b -j "$1" 2>&1 \
+        | sed "s|$1|JOURNAL|"
+}
+
+printf 'm 3\nf\nm 7\nf\ne 1 2\n' | cat "$dir/adds.txt" - > "$dir/changes.txt"
+"$build/pokedex" -b -j "$dir/clean.log" -g 0 < "$dir/changes.txt" > /dev/null \
+    || fail "the clean run failed"
+recover "$dir/clean.log" > "$dir/clean.txt"
+grep -q "Recovered 100 Pokemon" "$dir/clean.txt" \
+    || fail "the clean run recovered: $(head -1 "$dir/clean.txt")"
+
+# A process killed once every change is committed must lose none of
+# them. Its input is kept open so it is still running when killed.
+mkfifo "$dir/input"
+"$build/pokedex" -b -j "$dir/crash.log" -g 0 < "$dir/input" > /dev/null &
+pid=$!
+exec 3> "$dir/input"
+cat "$dir/changes.txt" >&3
+size=$(wc -c < "$dir/clean.log")
+tries=0
+while [ "$( { wc -c < "$dir/crash.log"; } 2> /dev/null)" != "$size" ]; do
+    [ $tries -lt 100 ] || fail "the changes were not committed"
+    sleep 0.1
+    tries=$((tries + 1))
+done
+kill -KILL $pid
+{ wait $pid; } 2> /dev/null
+exec 3>&-
+recover "$dir/crash.log" | diff -u "$dir/clean.txt" - \
+    || fail "recovery after a crash"
+
+# A record torn by a crash part way through writing it is dropped.
+cp "$dir/clean.log" "$dir/torn.log"
+printf 'torn record' >> "$dir/torn.log"
+recover "$dir/torn.log" | diff -u "$dir/clean.txt" - \
+    || fail "recovery of a torn record"
+[ "$(wc -c < "$dir/torn.log")" = "$size" ] \
+    || fail "the torn record was not cut off"
+
+rm -rf "$dir"
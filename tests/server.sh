@@ -0,0 +1,54 @@
+#!/bin/sh
+# server.sh
+#
+# This program was written by Zrx
+# on 18 Oct 2026
+#
+# Version 1.0.0: Release
+#
+# Serves a new, empty Pokedex with the pokedex CLI in build directory
+# $1 for each script tests/server/NAME.in, sends the script with the
+# client, and checks that the output is tests/server/NAME.out and that
+# the server is still running afterwards.
+# Usage: tests/server.sh build/release
+
+build=$1
+dir=$build/server-test
+rm -rf "$dir"
+mkdir -p "$dir"
+
+fail() {
+    echo "FAIL: server: $1"
+    kill -KILL $pid 2> /dev/null
+    exit 1
+}
+
+for script in tests/server/*.in; do
+    rm -f "$dir/sock"
+    "$build/pokedex" -s "$dir/sock" > "$dir/server.out" 2>&1 &
+    pid=$!
+
+    tries=0
+    while [ ! -S "$dir/sock" ]; do
+        [ $tries -lt 100 ] || fail "$script: the server did not start"
+        kill -0 $pid 2> /dev/null || fail "$script: the server exited"
+        sleep 0.1
+        tries=$((tries + 1))
+    done
+
+    timeout 10 "$build/client" "$dir/sock" < "$script" > "$dir/got.txt" \
+        || fail "$script: the client failed"
+    diff -u "${script%.in}.out" "$dir/got.txt" || fail "$script"
+
+    # A second client must still be served.
+    echo t | timeout 10 "$build/client" "$dir/sock" > "$dir/got.txt"
+    grep -q "Total Pokemon" "$dir/got.txt" \
+        || fail "$script: the server stopped serving"
+
+    kill -TERM $pid
+    wait $pid
+    status=$?
+    [ $status -eq 0 ] || fail "$script: the server exited with $status"
+done
+
+rm -rf "$dir"
@@ -0,0 +1,172 @@
+// trigram.c
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "trigram.h"
+#include "stats.h"
+
+// Letters fold to 1..26, space and '-' get their own codes,
+// and every other character shares one code.
+#define CODE_BITS 5
+#define NUM_TRIGRAMS (1 << (3 * CODE_BITS))
+
+struct trigram_index {
+    struct posting *postings;
+};
+
+// The rows containing one trigram.
+struct posting {
+    int *rows;
+    int size;
+    int capacity;
+};
+
+// Return the 5-bit code of a character, ignoring case.
+static int char_code(char c);
+
+// Return the trigram starting at text.
+static int trigram_at(const char *text);
+
+// Add row to the end of posting, unless it is there already.
+static void posting_add(struct posting *posting, int row);
+
+// Keep only the rows of `rows` that are also in posting.
+static int intersect(int *rows, int size, struct posting *posting);
+
+// Creates a new TrigramIndex, and returns a pointer to it.
+TrigramIndex new_trigram_index(void) {
+    TrigramIndex index = malloc(sizeof(struct trigram_index));
+    assert(index != NULL);
+    STATS_ALLOC(sizeof(struct trigram_index));
+
+    index->postings = calloc(NUM_TRIGRAMS, sizeof(struct posting));
+    assert(index->postings != NULL);
+    STATS_ALLOC(NUM_TRIGRAMS * sizeof(struct posting));
+
+    return index;
+}
+
+// Destroy the given TrigramIndex and free all associated memory.
+void destroy_trigram_index(TrigramIndex index) {
+    int i = 0;
+    while (i < NUM_TRIGRAMS) {
+        free(index->postings[i].rows);
+        i++;
+    }
+    free(index->postings);
+    free(index);
+}
+
+// Add every trigram of `name` for `row`.
+void trigram_index_add(TrigramIndex index, int row, const char *name) {
+    int length = strlen(name);
+    int i = 0;
+    while (i + TRIGRAM_LENGTH <= length) {
+        posting_add(&index->postings[trigram_at(&name[i])], row);
+        i++;
+    }
+}
+
+// Find the rows whose names contain every trigram of `text`,
+// by intersecting postings starting from the shortest one.
+int trigram_index_candidates(TrigramIndex index, const char *text, int **rows) {
+    int length = strlen(text);
+    assert(length >= TRIGRAM_LENGTH);
+
+    int shortest = trigram_at(text);
+    int i = 1;
+    while (i + TRIGRAM_LENGTH <= length) {
+        int trigram = trigram_at(&text[i]);
+        if (index->postings[trigram].size < index->postings[shortest].size) {
+            shortest = trigram;
+        }
+        i++;
+    }
+
+    struct posting *first = &index->postings[shortest];
+    int size = first->size;
+    *rows = malloc((size > 0 ? size : 1) * sizeof(int));
+    assert(*rows != NULL);
+    STATS_ALLOC((size > 0 ? size : 1) * sizeof(int));
+    if (size > 0) {
+        memcpy(*rows, first->rows, size * sizeof(int));
+    }
+
+    i = 0;
+    while (size > 0 && i + TRIGRAM_LENGTH <= length) {
+        int trigram = trigram_at(&text[i]);
+        if (trigram != shortest) {
+            size = intersect(*rows, size, &index->postings[trigram]);
+        }
+        i++;
+    }
+
+    return size;
+}
+
+// Return the 5-bit code of a character, ignoring case.
+static int char_code(char c) {
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 1;
+    } else if (c >= 'A' && c <= 'Z') {
+        return c - 'A' + 1;
+    } else if (c == ' ') {
+        return 27;
+    } else if (c == '-') {
+        return 28;
+    }
+    return 29;
+}
+
+// Return the trigram starting at text.
+static int trigram_at(const char *text) {
+    return (char_code(text[0]) << (2 * CODE_BITS))
+        | (char_code(text[1]) << CODE_BITS)
+        | char_code(text[2]);
+}
+
+// Add row to the end of posting, unless it is there already
+// (a name can contain the same trigram more than once).
+static void posting_add(struct posting *posting, int row) {
+    if (posting->size > 0 && posting->rows[posting->size - 1] == row) {
+        return;
+    }
+
+    if (posting->size == posting->capacity) {
+        posting->capacity = posting->capacity == 0 ? 4 : posting->capacity * 2;
+        posting->rows = realloc(posting->rows, posting->capacity * sizeof(int));
+        assert(posting->rows != NULL);
+        STATS_ALLOC(posting->capacity * sizeof(int));
+    }
+
+    posting->rows[posting->size] = row;
+    posting->size++;
+}
+
+// Keep only the rows of `rows` that are also in posting.
+// Both are in increasing order, so this is a single merge.
+static int intersect(int *rows, int size, struct posting *posting) {
+    int kept = 0;
+    int i = 0;
+    int j = 0;
+    while (i < size && j < posting->size) {
+        if (rows[i] < posting->rows[j]) {
+            i++;
+        } else if (rows[i] > posting->rows[j]) {
+            j++;
+        } else {
+            rows[kept] = rows[i];
+            kept++;
+            i++;
+            j++;
+        }
+    }
+    return kept;
+}
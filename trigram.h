@@ -0,0 +1,35 @@
+// trigram.h
+//
+// This program was written by Zrx
+// on 18 Oct 2026
+//
+// Version 1.0.0: Release
+
+#ifndef _TRIGRAM_H_
+#define _TRIGRAM_H_
+
+// A case-insensitive trigram index over the names of numbered rows.
+// For every three-character sequence it keeps the rows, in increasing
+// order, whose name contains it.
+// Rows must be added in increasing order.
+typedef struct trigram_index *TrigramIndex;
+
+#define TRIGRAM_LENGTH 3
+
+// Create a new, empty TrigramIndex and return a pointer to it.
+TrigramIndex new_trigram_index(void);
+
+// Destroy the given TrigramIndex and free all associated memory.
+void destroy_trigram_index(TrigramIndex index);
+
+// Add every trigram of `name` for `row`.
+void trigram_index_add(TrigramIndex index, int row, const char *name);
+
+// Find the rows whose names contain every trigram of `text`.
+// Stores a malloc'ed array of them, in increasing order, in `*rows`
+// and returns how many there are.
+// These are only candidates: each must still be checked against text.
+// `text` must be at least TRIGRAM_LENGTH characters long.
+int trigram_index_candidates(TrigramIndex index, const char *text, int **rows);
+
+#endif // _TRIGRAM_H_